@@ -0,0 +1,57 @@
+#pragma once
+#include <JuceHeader.h>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+// --- SHARED BENCHMARK HELPERS ---
+namespace BenchUtils
+{
+    // A raw, monotonic counter: the TSC on x86, the generic timer (cntvct_el0) on AArch64, the
+    // high-resolution clock elsewhere. Only differences between two reads mean anything; turn
+    // them into cycles with getCyclesPerCount.
+    inline juce::uint64 readCycleCounter() {
+       #if JUCE_INTEL
+        return (juce::uint64)__rdtsc();
+       #elif defined (__aarch64__)
+        juce::uint64 count;
+        asm volatile ("isb; mrs %0, cntvct_el0" : "=r" (count));
+        return count;
+       #else
+        return (juce::uint64)juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    // Cycles per readCycleCounter step. The generic timer and the high-resolution clock tick at a
+    // fixed rate, so their counts are scaled by the nominal CPU clock (1 GHz if the OS won't say).
+    inline double getCyclesPerCount() {
+       #if JUCE_INTEL
+        return 1.0;
+       #else
+        static const double ratio = [] {
+           #if defined (__aarch64__)
+            juce::uint64 countsPerSecond;
+            asm volatile ("mrs %0, cntfrq_el0" : "=r" (countsPerSecond));
+           #else
+            auto countsPerSecond = (juce::uint64)juce::Time::getHighResolutionTicksPerSecond();
+           #endif
+            const int megahertz = juce::SystemStats::getCpuSpeedInMegahertz();
+            return (megahertz > 0 ? megahertz * 1.0e6 : 1.0e9) / (double)juce::jmax((juce::uint64)1, countsPerSecond);
+        }();
+        return ratio;
+       #endif
+    }
+
+    // Nearest-rank percentile, p in 0..1 (1 = max)
+    inline double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        auto index = (size_t)juce::jlimit(0.0, (double)(values.size() - 1), std::round(p * (double)(values.size() - 1)));
+        return values[index];
+    }
+}
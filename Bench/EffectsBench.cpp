@@ -0,0 +1,210 @@
+// --- SQUAB DANCE SPRITE EFFECTS BENCHMARK ---
+// Times SpriteEffectPipeline::run for all 64 effect combinations over every frame of one
+// animation, and for the grade / analyse / reflect combinations also the multi-pass path the
+// editor used before the pipeline (sheet copy -> SpriteGrade::apply -> motion scan -> frame copy
+// -> buildReflection), so the fused speedup is measured on the same frames. SpriteGlow's blur is
+// timed per radius with its cache defeated, i.e. the cost of a frame change, and FrameTweener per
+// mode across the animation's frame pairs, i.e. the extra cost of one in-between paint.
+//
+// Usage:
+//   SquabDanceEffectsBench [--category 10] [--animation 0] [--repeats 20] [--out results.json]
+
+#include <JuceHeader.h>
+#include "SpriteFrameRenderer.h"
+#include "FrameTweener.h"
+
+namespace
+{
+    constexpr int frameWidth = SpriteFrameRenderer::frameWidth;
+    constexpr int frameHeight = SpriteFrameRenderer::frameHeight;
+
+    struct Frame { int sheet = 0, sx = 0, sy = 0; };
+
+    // The motion scan exactly as MotionSensor did it before it became a pipeline stage
+    void legacyScan(const juce::Image& source, int srcX, int srcY, juce::Image& lastFrame,
+                    const juce::Image& sheet, int sx, int sy, SpriteEffectPipeline::MotionScan& scan) {
+        {
+            juce::Image::BitmapData scanData(source, juce::Image::BitmapData::readOnly);
+            juce::Image::BitmapData oldData(lastFrame, juce::Image::BitmapData::readOnly);
+
+            for (int y = 0; y < frameHeight; y += 4) {
+                for (int x = 0; x < frameWidth; x += 4) {
+                    juce::Colour c = scanData.getPixelColour(srcX + x, srcY + y);
+                    juce::Colour oldC = oldData.getPixelColour(x, y);
+
+                    if (c.getAlpha() > 50) {
+                        scan.totalX += (float)x;
+                        scan.totalHue += c.getHue();
+                        scan.pixelCount += 1.0f;
+                    }
+                    if (std::abs(c.getBrightness() - oldC.getBrightness()) > 0.05f) scan.deltaCount += 1.0f;
+                }
+            }
+        }
+
+        lastFrame.clear(lastFrame.getBounds(), juce::Colours::transparentBlack);
+        juce::Graphics gLast(lastFrame);
+        gLast.drawImage(sheet, 0, 0, frameWidth, frameHeight, sx, sy, frameWidth, frameHeight);
+    }
+
+    void legacyRun(unsigned effects, const juce::Image& sheet, int sx, int sy, const SpriteGrade& grade,
+                   juce::Image& frameScratch, juce::Image& reflectionScratch, juce::Image& lastFrame,
+                   SpriteEffectPipeline::MotionScan& scan) {
+        const juce::Image* source = &sheet;
+        int srcX = sx, srcY = sy;
+
+        if ((effects & SpriteEffectPipeline::grade) != 0) {
+            frameScratch.clear(frameScratch.getBounds(), juce::Colours::transparentBlack);
+            {
+                juce::Graphics gFrame(frameScratch);
+                gFrame.drawImage(sheet, 0, 0, frameWidth, frameHeight, sx, sy, frameWidth, frameHeight);
+            }
+            grade.apply(frameScratch);
+            source = &frameScratch; srcX = 0; srcY = 0;
+        }
+
+        if ((effects & SpriteEffectPipeline::analyse) != 0) legacyScan(*source, srcX, srcY, lastFrame, sheet, sx, sy, scan);
+
+        if ((effects & SpriteEffectPipeline::reflect) != 0) {
+            if (source != &frameScratch) {
+                frameScratch.clear(frameScratch.getBounds(), juce::Colours::transparentBlack);
+                juce::Graphics gFrame(frameScratch);
+                gFrame.drawImage(sheet, 0, 0, frameWidth, frameHeight, sx, sy, frameWidth, frameHeight);
+            }
+            SpriteFrameRenderer::buildReflection(frameScratch, reflectionScratch);
+        }
+    }
+
+    template <typename Fn>
+    double timeFrames(const std::vector<Frame>& frames, int repeats, Fn&& fn) {
+        auto start = juce::Time::getHighResolutionTicks();
+        for (int r = 0; r < repeats; ++r)
+            for (const auto& f : frames) fn(f);
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / (double)(repeats * (int)frames.size());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    const int category = args.containsOption("--category") ? args.getValueForOption("--category").getIntValue() : 10;
+    const int animation = args.containsOption("--animation") ? args.getValueForOption("--animation").getIntValue() : 0;
+    const int repeats = juce::jmax(1, args.containsOption("--repeats") ? args.getValueForOption("--repeats").getIntValue() : 20);
+
+    const auto& db = SpriteDatabase::getDatabase();
+    if (db.empty()) { std::cerr << "No characters in SpriteDatabase" << std::endl; return 1; }
+    const auto& charDef = db[(size_t)juce::jlimit(0, (int)db.size() - 1, category)];
+    auto set = SpriteSheetSet::load(charDef);
+    if (!set.isValid()) { std::cerr << "No sheets for " << charDef.categoryName << std::endl; return 1; }
+
+    // The pipeline reads ARGB rows directly; convert once up front so that is not measured
+    for (auto& sheet : set.sheets)
+        if (sheet.getFormat() != juce::Image::ARGB) sheet = sheet.convertedToFormat(juce::Image::ARGB);
+
+    const int row = juce::jlimit(0, (int)set.anims.size() - 1, animation);
+    std::vector<Frame> frames;
+    for (int i = 0; i < juce::jmax(1, set.anims[(size_t)row].frameCount); ++i) {
+        Frame f;
+        if (SpriteFrameRenderer::locateFrame(set, row, i, f.sheet, f.sx, f.sy)) frames.push_back(f);
+    }
+    if (frames.empty()) { std::cerr << "Animation has no frames" << std::endl; return 1; }
+
+    SpriteGrade grade;
+    grade.hueShift = 0.3f; grade.satBoost = 0.4f; grade.brightBoost = 0.1f;
+    SpriteStyle style;
+    style.outline = true; style.pixelSize = 4; style.posterizeLevels = 5;
+
+    auto frameScratch = SpriteFrameRenderer::createScratchImage();
+    auto reflectionScratch = SpriteFrameRenderer::createScratchImage();
+    auto lastFrame = SpriteFrameRenderer::createScratchImage();
+    const double frameBytes = (double)frameWidth * frameHeight * 4.0;
+
+    juce::Array<juce::var> results;
+    for (unsigned effects = 1; effects < SpriteEffectPipeline::numCombinations; ++effects) {
+        SpriteEffectPipeline::Analysis analysis;
+        analysis.previousFrame = &lastFrame;
+
+        double fusedNs = timeFrames(frames, repeats, [&](const Frame& f) {
+            SpriteEffectPipeline::run(effects, set.sheets[(size_t)f.sheet], f.sx, f.sy, grade, style,
+                                      &frameScratch, &reflectionScratch, &analysis);
+        });
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("effects", SpriteEffectPipeline::describe(effects));
+        entry->setProperty("fusedNsPerFrame", fusedNs);
+        entry->setProperty("fusedMBps", frameBytes / fusedNs * 1.0e3);
+
+        const unsigned legacyEffects = SpriteEffectPipeline::grade | SpriteEffectPipeline::analyse | SpriteEffectPipeline::reflect;
+        if ((effects & ~legacyEffects) == 0) {
+            SpriteEffectPipeline::MotionScan scan;
+            double legacyNs = timeFrames(frames, repeats, [&](const Frame& f) {
+                legacyRun(effects, set.sheets[(size_t)f.sheet], f.sx, f.sy, grade, frameScratch, reflectionScratch, lastFrame, scan);
+            });
+            entry->setProperty("multiPassNsPerFrame", legacyNs);
+            entry->setProperty("speedup", legacyNs / fusedNs);
+        }
+
+        results.add(juce::var(entry));
+        std::cout << SpriteEffectPipeline::describe(effects) << ": " << fusedNs / 1000.0 << " us/frame" << std::endl;
+    }
+
+    juce::Array<juce::var> glowResults;
+    for (int radius : { 2, 6, 10, 16 }) {
+        SpriteGlow glow;
+        SpriteStyle glowStyle;
+        glowStyle.glowRadius = radius;
+        int index = 0;
+
+        double glowNs = timeFrames(frames, repeats, [&](const Frame& f) {
+            auto key = SpriteGlow::makeKey(f.sheet, f.sx, f.sy, 0, glowStyle);
+            key.sheet = index++;   // Never cached
+            glow.update(key, set.sheets[(size_t)f.sheet], f.sx, f.sy);
+        });
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("radius", radius);
+        entry->setProperty("blurNsPerFrame", glowNs);
+        glowResults.add(juce::var(entry));
+        std::cout << "glow r" << radius << ": " << glowNs / 1000.0 << " us/frame" << std::endl;
+    }
+
+    juce::Array<juce::var> tweenResults;
+    for (int mode : { (int)FrameTweener::crossfade, (int)FrameTweener::motion }) {
+        FrameTweener tweener;
+        auto tweenBuffer = SpriteFrameRenderer::createScratchImage();
+        size_t index = 0;
+        float phase = 0.0f;
+
+        double tweenNs = timeFrames(frames, repeats, [&](const Frame& f) {
+            const auto& next = frames[++index % frames.size()];
+            phase = std::fmod(phase + 0.37f, 1.0f);
+            tweener.render(mode, { &set.sheets[(size_t)f.sheet], f.sheet, f.sx, f.sy },
+                           { &set.sheets[(size_t)next.sheet], next.sheet, next.sx, next.sy }, phase, tweenBuffer);
+        });
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("mode", mode == FrameTweener::motion ? "motion" : "crossfade");
+        entry->setProperty("tweenNsPerFrame", tweenNs);
+        tweenResults.add(juce::var(entry));
+        std::cout << "tween " << (mode == FrameTweener::motion ? "motion" : "crossfade") << ": " << tweenNs / 1000.0 << " us/frame" << std::endl;
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("character", charDef.categoryName);
+    root->setProperty("animation", set.anims[(size_t)row].name);
+    root->setProperty("frames", (int)frames.size());
+    root->setProperty("repeats", repeats);
+    root->setProperty("results", results);
+    root->setProperty("glow", glowResults);
+    root->setProperty("tween", tweenResults);
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if (args.containsOption("--out")) args.getFileForOption("--out").replaceWithText(json);
+    else std::cout << json << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+// --- SQUAB DANCE ONSET / BEAT CLOCK BENCHMARK ---
+// Feeds a synthetic drum loop (sine kick on every beat, noise hat on the off-beat, -50 dBFS noise
+// floor) through OnsetDetector + OnsetBeatClock exactly as processBlock does without a host
+// transport. Reports the audio-thread cost per sample, detection latency against the known kick
+// positions, the tempo estimate, time to lock, and when the virtual clock crosses each beat
+// relative to its kick (the moment sync mode advances the frame; negative = predicted early).
+//
+// Usage:
+//   SquabDanceOnsetBench [--bpm 124] [--seconds 30] [--block 512] [--rate 48000] [--out results.json]
+
+#include <JuceHeader.h>
+#include "OnsetDetector.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using BenchUtils::readCycleCounter;
+    using BenchUtils::percentile;
+
+    // Kick on every beat, hat on every off-beat, generated up front so it is not measured
+    juce::AudioBuffer<float> makeDrumLoop(double sampleRate, double bpm, double seconds, std::vector<juce::int64>& kicks) {
+        const int numSamples = (int)(seconds * sampleRate);
+        const double period = 60.0 / bpm * sampleRate;
+        juce::AudioBuffer<float> loop(2, numSamples);
+        loop.clear();
+
+        juce::Random rng(1234);
+        for (int i = 0; i < numSamples; ++i) loop.setSample(0, i, 0.003f * (rng.nextFloat() * 2.0f - 1.0f));
+
+        for (double beat = 0.5 * sampleRate; beat < numSamples; beat += period) {
+            kicks.push_back((juce::int64)beat);
+
+            for (int i = 0; i < (int)(0.3 * sampleRate) && (int)beat + i < numSamples; ++i) {
+                double t = i / sampleRate;
+                loop.addSample(0, (int)beat + i, (float)(0.8 * std::sin(juce::MathConstants<double>::twoPi * 60.0 * t) * std::exp(-12.0 * t)));
+            }
+
+            int hat = (int)(beat + period / 2);
+            for (int i = 0; i < (int)(0.05 * sampleRate) && hat + i < numSamples; ++i)
+                loop.addSample(0, hat + i, (float)(0.2 * (rng.nextFloat() * 2.0f - 1.0f) * std::exp(-80.0 * i / sampleRate)));
+        }
+
+        loop.copyFrom(1, 0, loop, 0, 0, numSamples);
+        return loop;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    const double bpm = args.containsOption("--bpm") ? args.getValueForOption("--bpm").getDoubleValue() : 124.0;
+    const double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 30.0;
+    const int blockSize = args.containsOption("--block") ? args.getValueForOption("--block").getIntValue() : 512;
+    const double sampleRate = args.containsOption("--rate") ? args.getValueForOption("--rate").getDoubleValue() : 48000.0;
+
+    std::vector<juce::int64> kicks;
+    auto loop = makeDrumLoop(sampleRate, bpm, seconds, kicks);
+
+    // Tempo estimates run inline (as in an offline render) so the run is repeatable; they are
+    // timed separately from the per-sample detection cost
+    OnsetDetector detector;
+    detector.prepare(sampleRate, false);
+    OnsetBeatClock clock;
+    clock.prepare(sampleRate);
+
+    juce::AudioBuffer<float> block(2, blockSize);
+    std::vector<juce::int64> detections, beatCrossings;
+    double detectSeconds = 0.0, tempoSeconds = 0.0, lockSeconds = -1.0;
+    juce::uint64 detectCycles = 0;
+    double lastCrossedBeat = -1.0;
+
+    for (int position = 0; position + blockSize <= loop.getNumSamples(); position += blockSize) {
+        for (int ch = 0; ch < 2; ++ch) block.copyFrom(ch, 0, loop, ch, position, blockSize);
+
+        auto startCycles = readCycleCounter();
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        int numOnsets = detector.process(block, 2);
+        auto endTicks = juce::Time::getHighResolutionTicks();
+        detectCycles += readCycleCounter() - startCycles;
+        detectSeconds += juce::Time::highResolutionTicksToSeconds(endTicks - startTicks);
+
+        startTicks = juce::Time::getHighResolutionTicks();
+        detector.analyseTempo();
+        tempoSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        clock.advance(detector, numOnsets, blockSize);
+
+        for (int i = 0; i < numOnsets; ++i) detections.push_back(position + detector.getOnset(i).offset);
+
+        if (lockSeconds < 0.0 && clock.isPlaying() && std::abs(clock.getBpm() / bpm - 1.0) < 0.02)
+            lockSeconds = position / sampleRate;
+
+        // Where the published clock passes each beat (a snap at this block counts from its start)
+        if (clock.isPlaying()) {
+            const double beatsPerSample = clock.getBpm() / 60.0 / sampleRate;
+            const double start = clock.getBlockPpq(), end = start + blockSize * beatsPerSample;
+            for (double beat = std::floor(juce::jmax(lastCrossedBeat, start - 1.0)) + 1.0; beat <= end; beat += 1.0) {
+                beatCrossings.push_back(position + (juce::int64)juce::jmax(0.0, (beat - start) / beatsPerSample));
+                lastCrossedBeat = beat;
+            }
+        } else {
+            lastCrossedBeat = std::floor(clock.getBlockPpq());
+        }
+    }
+
+    // Detection latency: first detection within 20 ms after each kick
+    std::vector<double> latencyMs, frameOffsetMs;
+    int missed = 0;
+    for (auto kick : kicks) {
+        auto it = std::lower_bound(detections.begin(), detections.end(), kick);
+        if (it != detections.end() && *it - kick < (juce::int64)(0.02 * sampleRate)) latencyMs.push_back((double)(*it - kick) / sampleRate * 1000.0);
+        else ++missed;
+
+        // Beat crossing nearest to this kick, once locked
+        if (lockSeconds >= 0.0 && kick / sampleRate > lockSeconds + 1.0 && !beatCrossings.empty()) {
+            auto c = std::lower_bound(beatCrossings.begin(), beatCrossings.end(), kick);
+            juce::int64 nearest = c == beatCrossings.end() ? beatCrossings.back() : *c;
+            if (c != beatCrossings.begin() && (c == beatCrossings.end() || kick - *(c - 1) < *c - kick)) nearest = *(c - 1);
+            frameOffsetMs.push_back((double)(nearest - kick) / sampleRate * 1000.0);
+        }
+    }
+
+    const double totalSamples = (double)(loop.getNumSamples() / blockSize * blockSize);
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("bpm", bpm);
+    root->setProperty("sampleRate", sampleRate);
+    root->setProperty("blockSize", blockSize);
+    root->setProperty("detectNsPerSample", detectSeconds * 1.0e9 / totalSamples);
+    root->setProperty("detectCyclesPerSample", (double)detectCycles * BenchUtils::getCyclesPerCount() / totalSamples);
+    root->setProperty("tempoEstimateMsPerSecondOfAudio", tempoSeconds * 1000.0 / (totalSamples / sampleRate));
+    root->setProperty("kicks", (int)kicks.size());
+    root->setProperty("kicksMissed", missed);
+    root->setProperty("detections", (int)detections.size());   // Includes the off-beat hats
+    root->setProperty("detectLatencyMsP50", percentile(latencyMs, 0.5));
+    root->setProperty("detectLatencyMsMax", percentile(latencyMs, 1.0));
+    root->setProperty("estimatedBpm", clock.getBpm());
+    root->setProperty("confidence", detector.getConfidence());
+    root->setProperty("lockSeconds", lockSeconds);
+    root->setProperty("frameOffsetMsP50", percentile(frameOffsetMs, 0.5));
+    root->setProperty("frameOffsetMsMax", percentile(frameOffsetMs, 1.0));
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if (args.containsOption("--out")) args.getFileForOption("--out").replaceWithText(json);
+    else std::cout << json << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+// --- SQUAB DANCE PROCESSOR BENCHMARK ---
+// Runs SquabDanceAudioProcessor headless (no editor) across block sizes, sample rates,
+// channel counts, saturation types, manipulation stages and automation patterns, then
+// writes ns/sample, cycles/sample and worst-case block time as JSON.
+//
+// Usage:
+//   SquabDanceBench [--quick] [--out results.json] [--baseline baseline.json] [--threshold 10]
+//
+// With --baseline every case is compared against the stored run; anything slower than
+// the threshold (percent) is reported and the exit code is 1.
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "BenchUtils.h"
+#include <unordered_map>
+
+namespace
+{
+    using BenchUtils::readCycleCounter;
+
+    enum class Automation { none, ramp, step, random };
+
+    const char* automationName(Automation a) {
+        switch (a) {
+            case Automation::none:   return "none";
+            case Automation::ramp:   return "ramp";
+            case Automation::step:   return "step";
+            case Automation::random: return "random";
+        }
+        return "?";
+    }
+
+    struct BenchCase
+    {
+        int blockSize = 512;
+        double sampleRate = 48000.0;
+        int numChannels = 2;
+        int satType = 0;
+        bool dynamicOn = false, hueOn = false, panOn = false;
+        Automation automation = Automation::none;
+
+        juce::String getKey() const {
+            return juce::String(blockSize) + "/" + juce::String((int)sampleRate) + "/" + juce::String(numChannels) + "ch"
+                 + "/sat" + juce::String(satType)
+                 + "/" + (dynamicOn ? "D" : "-") + (hueOn ? "H" : "-") + (panOn ? "P" : "-")
+                 + "/" + automationName(automation);
+        }
+    };
+
+    struct BenchResult
+    {
+        double nsPerSample = 0.0;
+        double cyclesPerSample = 0.0;
+        double worstBlockUs = 0.0;
+    };
+
+    void setParam(SquabDanceAudioProcessor& p, const juce::String& id, float value) {
+        if (auto* param = p.apvts.getParameter(id))
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    // Moves the automatable controls for block n according to the chosen pattern
+    void applyAutomation(SquabDanceAudioProcessor& p, Automation automation, int block, juce::Random& rng) {
+        float x = 0.0f;
+        switch (automation) {
+            case Automation::none:   return;
+            case Automation::ramp:   x = (float)(block % 200) / 199.0f; break;
+            case Automation::step:   x = (block % 2 == 0) ? 0.0f : 1.0f; break;
+            case Automation::random: x = rng.nextFloat(); break;
+        }
+
+        setParam(p, "manip_dynamic", 100.0f * x);
+        setParam(p, "dry_wet", 50.0f + 50.0f * x);
+        setParam(p, "out_gain", -12.0f * x);
+
+        // The visual model moves with it, as it would with a dancing sprite
+        p.visualMotion.store(x);
+        p.visualHue.store(1.0f - x);
+        p.visualPan.store(x);
+    }
+
+    BenchResult runCase(const BenchCase& c, double secondsOfAudio) {
+        SquabDanceAudioProcessor processor;
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(c.numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(c.numChannels));
+        processor.setBusesLayout(layout);
+
+        processor.setPlayConfigDetails(c.numChannels, c.numChannels, c.sampleRate, c.blockSize);
+        processor.setNonRealtime(false);
+
+        bool anyStage = c.dynamicOn || c.hueOn || c.panOn;
+        setParam(processor, "audio_manip", anyStage ? 1.0f : 0.0f);
+        setParam(processor, "manip_dynamic", c.dynamicOn ? 60.0f : 0.0f);
+        setParam(processor, "manip_hue", c.hueOn ? 60.0f : 0.0f);
+        setParam(processor, "manip_pan", c.panOn ? 60.0f : 0.0f);
+        setParam(processor, "sat_type", (float)c.satType);
+
+        processor.prepareToPlay(c.sampleRate, c.blockSize);
+
+        // White noise at -6 dBFS, generated up front so it is not part of the measurement
+        juce::AudioBuffer<float> buffer(c.numChannels, c.blockSize);
+        juce::AudioBuffer<float> source(c.numChannels, c.blockSize);
+        juce::Random rng(1234);
+        for (int ch = 0; ch < c.numChannels; ++ch)
+            for (int i = 0; i < c.blockSize; ++i)
+                source.setSample(ch, i, (rng.nextFloat() * 2.0f - 1.0f) * 0.5f);
+
+        juce::MidiBuffer midi;
+
+        const int totalBlocks = juce::jmax(8, (int)(secondsOfAudio * c.sampleRate / c.blockSize));
+        const int warmupBlocks = juce::jmax(2, totalBlocks / 10);
+
+        double totalSeconds = 0.0;
+        double worstSeconds = 0.0;
+        juce::uint64 totalCycles = 0;
+
+        for (int block = 0; block < warmupBlocks + totalBlocks; ++block) {
+            applyAutomation(processor, c.automation, block, rng);
+
+            for (int ch = 0; ch < c.numChannels; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, c.blockSize);
+
+            auto startCycles = readCycleCounter();
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            processor.processBlock(buffer, midi);
+
+            auto endTicks = juce::Time::getHighResolutionTicks();
+            auto endCycles = readCycleCounter();
+
+            if (block < warmupBlocks) continue;
+
+            double seconds = juce::Time::highResolutionTicksToSeconds(endTicks - startTicks);
+            totalSeconds += seconds;
+            worstSeconds = juce::jmax(worstSeconds, seconds);
+            totalCycles += endCycles - startCycles;
+        }
+
+        processor.releaseResources();
+
+        const double samples = (double)totalBlocks * c.blockSize;
+        BenchResult r;
+        r.nsPerSample = totalSeconds * 1.0e9 / samples;
+        r.cyclesPerSample = (double)totalCycles * BenchUtils::getCyclesPerCount() / samples;
+        r.worstBlockUs = worstSeconds * 1.0e6;
+        return r;
+    }
+
+    std::vector<BenchCase> buildMatrix(bool quick) {
+        std::vector<int> blockSizes = quick ? std::vector<int> { 64, 512 } : std::vector<int> { 1, 16, 64, 256, 512, 1024, 4096, 8192 };
+        std::vector<double> sampleRates = quick ? std::vector<double> { 48000.0 } : std::vector<double> { 44100.0, 48000.0, 96000.0, 192000.0 };
+        std::vector<int> channelCounts = quick ? std::vector<int> { 2 } : std::vector<int> { 1, 2, 6 };
+        std::vector<Automation> automations = { Automation::none, Automation::ramp, Automation::step, Automation::random };
+
+        std::vector<BenchCase> cases;
+        for (int bs : blockSizes)
+        for (double sr : sampleRates)
+        for (int ch : channelCounts)
+        for (int stages = 0; stages < 8; ++stages)
+        for (int sat = 0; sat < 4; ++sat)
+        for (auto automation : automations) {
+            BenchCase c;
+            c.blockSize = bs; c.sampleRate = sr; c.numChannels = ch;
+            c.dynamicOn = (stages & 1) != 0;
+            c.hueOn = (stages & 2) != 0;
+            c.panOn = (stages & 4) != 0;
+
+            // Saturation type only matters when the Dynamic stage is running
+            if (!c.dynamicOn && sat > 0) continue;
+            c.satType = sat;
+            c.automation = automation;
+            cases.push_back(c);
+        }
+        return cases;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    const bool quick = args.containsOption("--quick");
+    const double secondsPerCase = quick ? 0.1 : 0.25;
+    const double threshold = args.containsOption("--threshold") ? args.getValueForOption("--threshold").getDoubleValue() : 10.0;
+
+    auto cases = buildMatrix(quick);
+    std::cout << "Running " << cases.size() << " cases..." << std::endl;
+
+    juce::Array<juce::var> results;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        auto r = runCase(cases[i], secondsPerCase);
+
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("case", cases[i].getKey());
+        obj->setProperty("blockSize", cases[i].blockSize);
+        obj->setProperty("sampleRate", cases[i].sampleRate);
+        obj->setProperty("channels", cases[i].numChannels);
+        obj->setProperty("satType", cases[i].satType);
+        obj->setProperty("dynamic", cases[i].dynamicOn);
+        obj->setProperty("hue", cases[i].hueOn);
+        obj->setProperty("pan", cases[i].panOn);
+        obj->setProperty("automation", automationName(cases[i].automation));
+        obj->setProperty("nsPerSample", r.nsPerSample);
+        obj->setProperty("cyclesPerSample", r.cyclesPerSample);
+        obj->setProperty("worstBlockUs", r.worstBlockUs);
+        results.add(juce::var(obj));
+
+        if ((i + 1) % 100 == 0) std::cout << "  " << (i + 1) << " / " << cases.size() << std::endl;
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("results", results);
+    juce::var report(root);
+
+    auto json = juce::JSON::toString(report);
+    if (args.containsOption("--out")) args.getFileForOption("--out").replaceWithText(json);
+    else std::cout << json << std::endl;
+
+    // --- BASELINE COMPARISON ---
+    if (!args.containsOption("--baseline")) return 0;
+
+    auto baseline = juce::JSON::parse(args.getFileForOption("--baseline"));
+    std::unordered_map<std::string, double> baselineNs;
+    if (auto* baseResults = baseline["results"].getArray())
+        for (auto& entry : *baseResults)
+            baselineNs[entry["case"].toString().toStdString()] = (double)entry["nsPerSample"];
+
+    int regressions = 0;
+    for (auto& entry : results) {
+        auto it = baselineNs.find(entry["case"].toString().toStdString());
+        if (it == baselineNs.end() || it->second <= 0.0) continue;
+
+        double change = ((double)entry["nsPerSample"] / it->second - 1.0) * 100.0;
+        if (change > threshold) {
+            std::cout << "REGRESSION " << entry["case"].toString() << ": " << it->second << " -> "
+                      << (double)entry["nsPerSample"] << " ns/sample (+" << juce::String(change, 1) << "%)" << std::endl;
+            ++regressions;
+        }
+    }
+
+    std::cout << regressions << " regression(s) over " << threshold << "%" << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+// --- SQUAB DANCE RENDER BENCHMARK ---
+// Renders SpriteContent into an offscreen juce::Image (no window) for every category and
+// animation in SpriteDatabase, across scales, mirror on/off, reactivity on/off and crowd sizes, and reports
+// per-frame paint time percentiles, heap allocations per frame and pixels touched.
+// It also times editor construction -> first painted frame, so startup regressions show up too.
+//
+// Usage:
+//   SquabDanceRenderBench [--quick] [--frames 24] [--out results.json] [--skip-startup]
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+#include "BenchUtils.h"
+
+// --- ALLOCATION COUNTER ---
+// Counts global operator new (and new[], which the standard one forwards here) on the bench
+// thread while countingAllocations is set, i.e. inside paint(). Other threads (crowd workers,
+// the message thread's timers) are left out, and so are direct malloc calls and aligned new:
+// the number is C++ allocations paint() itself makes.
+static std::atomic<juce::int64> allocationCount { 0 };
+static thread_local bool countingAllocations = false;
+
+void* operator new(std::size_t size)
+{
+    if (countingAllocations) allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+    struct RenderConfig
+    {
+        float scale = 1.0f;
+        bool mirror = false;
+        bool reactive = false;
+        int crowd = 1;
+
+        juce::String getKey() const {
+            return juce::String(juce::roundToInt(scale * 100.0f)) + "%"
+                 + (mirror ? "/mirror" : "/plain")
+                 + (reactive ? "/react" : "/static")
+                 + (crowd > 1 ? "/crowd" + juce::String(crowd) : juce::String());
+        }
+    };
+
+    using BenchUtils::percentile;
+
+    int countTouchedPixels(const juce::Image& canvas) {
+        juce::Image::BitmapData data(canvas, juce::Image::BitmapData::readOnly);
+        int touched = 0;
+        for (int y = 0; y < data.height; ++y) {
+            auto* row = reinterpret_cast<const juce::PixelARGB*>(data.getLinePointer(y));
+            for (int x = 0; x < data.width; ++x)
+                if (row[x].getAlpha() != 0) ++touched;
+        }
+        return touched;
+    }
+
+    juce::var benchAnimation(const CharacterDef& charDef, const std::vector<juce::Image>& sheets, int row,
+                             const RenderConfig& config, int maxFrames, juce::Image& canvas) {
+        SpriteContent content;
+        content.setSpriteData(charDef.isGridSprite, charDef.anims, sheets);
+
+        // The "held" move the editor configures for this character
+        int hRow = SpriteDatabase::findHeldAnimation(charDef);
+        int hFrames = charDef.anims.empty() ? 8 : charDef.anims[(size_t)hRow].frameCount;
+        int frames = charDef.anims[(size_t)row].frameCount;
+        content.updateParams(row, frames, hRow, hFrames, config.mirror);
+        content.setScale(config.scale);
+        SpectralFeatures drive;
+        if (config.reactive) drive.level = drive.bass = drive.brightness = drive.flux = 0.8f;
+        content.updateAudioReact(config.reactive, 100.0f, 100.0f, 100.0f, drive);
+        content.setCrowdSize(config.crowd);
+
+        std::vector<double> paintMs;
+        juce::int64 totalAllocations = 0;
+        int pixelsTouched = 0;
+
+        const int numFrames = juce::jmin(frames, maxFrames);
+        for (int f = 0; f < numFrames; ++f) {
+            canvas.clear(canvas.getBounds());
+
+            auto allocsBefore = allocationCount.load();
+            auto start = juce::Time::getHighResolutionTicks();
+            {
+                juce::Graphics g(canvas);
+                countingAllocations = true;
+                content.paint(g);
+                countingAllocations = false;
+            }
+            auto end = juce::Time::getHighResolutionTicks();
+            totalAllocations += allocationCount.load() - allocsBefore;
+
+            paintMs.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1000.0);
+
+            // Counting touched pixels walks the whole 960x2280 canvas, so only do it once per config
+            if (f == 0) pixelsTouched = countTouchedPixels(canvas);
+
+            content.updatePump(0.85f);
+            content.advanceFrame();
+        }
+
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("category", charDef.categoryName);
+        obj->setProperty("animation", charDef.anims[(size_t)row].name);
+        obj->setProperty("config", config.getKey());
+        obj->setProperty("frames", numFrames);
+        obj->setProperty("p50Ms", percentile(paintMs, 0.50));
+        obj->setProperty("p95Ms", percentile(paintMs, 0.95));
+        obj->setProperty("p99Ms", percentile(paintMs, 0.99));
+        obj->setProperty("maxMs", percentile(paintMs, 1.0));
+        obj->setProperty("allocationsPerFrame", numFrames > 0 ? (double)totalAllocations / numFrames : 0.0);
+        obj->setProperty("pixelsTouched", pixelsTouched);
+        return juce::var(obj);
+    }
+
+    // Editor constructor -> sprite sheets decoded -> first frame painted
+    double measureTimeToFirstFrame() {
+        SquabDanceAudioProcessor processor;
+        processor.prepareToPlay(48000.0, 512);
+
+        auto start = juce::Time::getHighResolutionTicks();
+        std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditor());
+        auto* squabEditor = dynamic_cast<SquabDanceAudioProcessorEditor*>(editor.get());
+        if (squabEditor == nullptr) return -1.0;
+
+        // The initial category loads through an async ComboBox notification, so pump the message loop
+        auto* content = squabEditor->getSpriteContent();
+        while (content != nullptr && !content->hasSpriteData()) {
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+            if (juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) > 30.0) return -1.0;
+        }
+
+        juce::Image canvas(juce::Image::ARGB, 960, 2280, true);
+        {
+            juce::Graphics g(canvas);
+            content->paint(g);
+        }
+        auto end = juce::Time::getHighResolutionTicks();
+
+        editor = nullptr;
+        processor.releaseResources();
+        return juce::Time::highResolutionTicksToSeconds(end - start) * 1000.0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    const bool quick = args.containsOption("--quick");
+    const int maxFrames = args.containsOption("--frames") ? args.getValueForOption("--frames").getIntValue() : (quick ? 8 : 24);
+
+    std::vector<RenderConfig> configs;
+    for (float scale : (quick ? std::vector<float> { 1.0f, 3.0f } : std::vector<float> { 0.5f, 1.0f, 2.0f, 3.0f }))
+        for (bool mirror : { false, true })
+            for (bool reactive : { false, true })
+                configs.push_back({ scale, mirror, reactive, 1 });
+
+    // Crowd mode at 100%: batching, shared grading and tiled workers
+    for (int crowd : (quick ? std::vector<int> { 128 } : std::vector<int> { 16, 64, 128 }))
+        for (bool reactive : { false, true })
+            configs.push_back({ 1.0f, false, reactive, crowd });
+
+    // One shared canvas the size of the sprite window
+    juce::Image canvas(juce::Image::ARGB, 960, 2280, true);
+
+    juce::Array<juce::var> results;
+    for (const auto& charDef : SpriteDatabase::getDatabase()) {
+        auto sheets = SpriteDatabase::loadSheets(charDef);
+        if (sheets.empty() || charDef.anims.empty()) {
+            std::cout << "Skipping " << charDef.categoryName << " (no sheets)" << std::endl;
+            continue;
+        }
+
+        std::cout << charDef.categoryName << " (" << (quick ? 1 : (int)charDef.anims.size()) << " animations)" << std::endl;
+
+        const int numRows = quick ? 1 : (int)charDef.anims.size();
+        for (int row = 0; row < numRows; ++row)
+            for (const auto& config : configs)
+                results.add(benchAnimation(charDef, sheets, row, config, maxFrames, canvas));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("results", results);
+
+    if (!args.containsOption("--skip-startup")) {
+        double ttff = measureTimeToFirstFrame();
+        root->setProperty("timeToFirstFrameMs", ttff);
+        std::cout << "Time to first frame: " << ttff << " ms" << std::endl;
+    }
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if (args.containsOption("--out")) args.getFileForOption("--out").replaceWithText(json);
+    else std::cout << json << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+// --- SQUAB DANCE SHARED-FRAME BENCHMARK ---
+// Publishes the dancer into the shared-memory frame ring at 1080p60 (a new frame every tick, so
+// nothing is skipped as unchanged) while an in-process reader sleeps on the ring exactly like
+// Tools/SquabFrameReader does. Reports publish time percentiles (render + notify), reader wake
+// latency and the process CPU time (publisher + reader) as a share of one core.
+//
+// Usage:
+//   SquabDanceSharedFrameBench [--frames 600] [--fps 60] [--mirror] [--out results.json]
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SharedFramePublisher.h"
+#include "BenchUtils.h"
+
+#if SQUAB_SHARED_FRAMES
+ #include <sys/resource.h>
+ #include <sys/stat.h>
+
+namespace
+{
+    using BenchUtils::percentile;
+
+    double getProcessCpuSeconds() {
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e6;
+    }
+
+    // Maps the ring by name and records how long after publishing each frame it woke up
+    class RingReader : public juce::Thread
+    {
+    public:
+        explicit RingReader(const juce::String& ringName) : juce::Thread("Ring Reader"), name(ringName) {}
+
+        void run() override {
+            int fd = shm_open(name.toRawUTF8(), O_RDONLY, 0);
+            if (fd < 0) return;
+            struct stat info {};
+            fstat(fd, &info);
+            void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mapping == MAP_FAILED) return;
+
+            auto& header = *const_cast<SharedFrameFormat::Header*>(static_cast<const SharedFrameFormat::Header*>(mapping));
+            std::uint32_t lastSeen = header.publishCount.load(std::memory_order_acquire);
+
+            while (!threadShouldExit()) {
+                SharedFrameFormat::waitForFrame(header, lastSeen, 100);
+                std::uint32_t count = header.publishCount.load(std::memory_order_acquire);
+                if (count == lastSeen) continue;
+                lastSeen = count;
+
+                auto wokenNs = SharedFrameFormat::getMonotonicNs();
+                const auto& slot = header.slots[header.latestSlot.load(std::memory_order_acquire) % SharedFrameFormat::numSlots];
+                wakeLatenciesMs.push_back((double)(wokenNs - slot.timestampNs) / 1.0e6);
+            }
+
+            munmap(mapping, (size_t)info.st_size);
+        }
+
+        juce::String name;
+        std::vector<double> wakeLatenciesMs;   // Read after the thread has stopped
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    const int numFrames = args.containsOption("--frames") ? args.getValueForOption("--frames").getIntValue() : 600;
+    const double fps = args.containsOption("--fps") ? args.getValueForOption("--fps").getDoubleValue() : 60.0;
+    const bool mirror = args.containsOption("--mirror");
+
+    auto db = SpriteDatabase::getDatabase();
+    auto sheets = SpriteSheetSet::load(db[10]);
+    if (!sheets.isValid()) { std::cout << "no sprite sheets" << std::endl; return 1; }
+
+    SharedFramePublisher publisher(sheets, 1920, 1080);
+    if (!publisher.isOpen()) { std::cout << "cannot open ring: " << publisher.describe() << std::endl; return 1; }
+
+    RingReader reader(publisher.getName());
+    reader.startThread();
+    juce::Thread::sleep(50);
+
+    std::vector<double> publishMs;
+    publishMs.reserve((size_t)numFrames);
+
+    const double interval = 1.0 / fps;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    const double startCpu = getProcessCpuSeconds();
+
+    for (int i = 0; i < numFrames; ++i) {
+        // Pace like the display clock would
+        double due = i * interval;
+        while (juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) < due)
+            juce::Thread::sleep(1);
+
+        SharedFramePublisher::Post post;
+        post.state.row = 0;
+        post.state.frame = i;
+        post.state.pump = 0.2f * (float)(i % 8) / 8.0f;
+        post.state.mirror = mirror;
+        post.ppq = i * 0.125;
+        post.postedTicks = juce::Time::getHighResolutionTicks();
+
+        publisher.publish(post);
+        publishMs.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - post.postedTicks) * 1000.0);
+    }
+
+    const double wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    const double cpuSeconds = getProcessCpuSeconds() - startCpu;
+
+    reader.stopThread(1000);
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("resolution", "1920x1080");
+    root->setProperty("fps", fps);
+    root->setProperty("frames", numFrames);
+    root->setProperty("mirror", mirror);
+    root->setProperty("publishMsP50", percentile(publishMs, 0.5));
+    root->setProperty("publishMsP99", percentile(publishMs, 0.99));
+    root->setProperty("publishMsMax", percentile(publishMs, 1.0));
+    root->setProperty("readerWakeMsP50", percentile(reader.wakeLatenciesMs, 0.5));
+    root->setProperty("readerWakeMsP99", percentile(reader.wakeLatenciesMs, 0.99));
+    root->setProperty("framesSeenByReader", (int)reader.wakeLatenciesMs.size());
+    root->setProperty("cpuPercentOfOneCore", wallSeconds > 0.0 ? cpuSeconds / wallSeconds * 100.0 : 0.0);
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if (args.containsOption("--out")) args.getFileForOption("--out").replaceWithText(json);
+    else std::cout << json << std::endl;
+
+    return 0;
+}
+
+#else
+
+int main()
+{
+    std::cout << "Shared-memory frame output needs POSIX shared memory (Linux / macOS)" << std::endl;
+    return 0;
+}
+
+#endif
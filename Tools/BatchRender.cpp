@@ -0,0 +1,226 @@
+// --- SQUAB DANCE BATCH RENDERER ---
+// Runs WAV / AIFF files through SquabDanceAudioProcessor without a DAW or a GUI. Every file gets
+// its own processor instance on a worker pool (all cores by default). The processor runs in
+// non-realtime mode, exactly as in a host's offline bounce, so the visual modulation comes from
+// the chosen animation's precomputed timeline (VisualTimeline) at the given tempo. The output
+// matches a bounce of the same file with the same preset, tempo and block size.
+//
+// Usage:
+//   SquabDanceBatch [--preset state.xml] [--set id=value ...] [--bpm 120] [--category 10]
+//                   [--animation 0] [--block 512] [--jobs N] [--out-dir processed] files...
+//
+// --preset takes the plugin state (the XML tree, or the binary blob a host saves). --category and
+// --animation override the selection stored in the preset; without them the preset's own (or the
+// plugin default) is used.
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    struct BatchSettings
+    {
+        juce::File preset;
+        juce::StringPairArray overrides;   // Parameter id -> value, in parameter units
+        double bpm = 120.0;
+        int category = -1;    // -1 = keep the preset's selection
+        int animation = -1;
+        int blockSize = 512;
+        int numJobs = juce::SystemStats::getNumCpus();
+        juce::File outputDirectory;
+        juce::Array<juce::File> inputs;
+    };
+
+    struct FileResult
+    {
+        juce::File input, output;
+        double audioSeconds = 0.0;
+        double wallSeconds = 0.0;
+        juce::String error;
+    };
+
+    // A host transport that is always playing at a fixed tempo from the top of the file
+    class FixedTempoPlayHead : public juce::AudioPlayHead
+    {
+    public:
+        FixedTempoPlayHead(double tempo, double rate) : bpm(tempo), sampleRate(rate) {}
+
+        juce::Optional<PositionInfo> getPosition() const override {
+            PositionInfo info;
+            info.setBpm(bpm);
+            info.setTimeInSamples(position);
+            info.setTimeInSeconds((double)position / sampleRate);
+            info.setPpqPosition((double)position / sampleRate * bpm / 60.0);
+            info.setIsPlaying(true);
+            return info;
+        }
+
+        juce::int64 position = 0;
+
+    private:
+        double bpm, sampleRate;
+    };
+
+    void applyPreset(SquabDanceAudioProcessor& processor, const BatchSettings& settings) {
+        if (settings.preset.existsAsFile()) {
+            // Both forms go through setStateInformation, so the selection and program properties
+            // are restored exactly as a host session would restore them
+            if (auto xml = juce::XmlDocument::parse(settings.preset)) {
+                juce::MemoryBlock data;
+                juce::AudioProcessor::copyXmlToBinary(*xml, data);
+                processor.setStateInformation(data.getData(), (int)data.getSize());
+            } else {
+                juce::MemoryBlock data;
+                settings.preset.loadFileAsData(data);
+                processor.setStateInformation(data.getData(), (int)data.getSize());
+            }
+        }
+
+        for (auto& id : settings.overrides.getAllKeys())
+            if (auto* param = processor.apvts.getParameter(id))
+                param->setValueNotifyingHost(param->convertTo0to1(settings.overrides[id].getFloatValue()));
+    }
+
+    FileResult processFile(const juce::File& input, const BatchSettings& settings) {
+        FileResult result;
+        result.input = input;
+        auto start = juce::Time::getHighResolutionTicks();
+
+        // Checked before anything is opened: with --out-dir pointing at the inputs' folder the
+        // output would be the input itself
+        result.output = settings.outputDirectory.getChildFile(input.getFileName());
+        if (result.output == input) { result.error = "output would overwrite the input"; return result; }
+
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+        if (reader == nullptr) { result.error = "unreadable"; return result; }
+
+        const int numChannels = (int)reader->numChannels;
+        const double sampleRate = reader->sampleRate;
+
+        SquabDanceAudioProcessor processor;
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        if (!processor.setBusesLayout(layout)) { result.error = juce::String(numChannels) + " channels not supported"; return result; }
+
+        applyPreset(processor, settings);
+        if (settings.category >= 0) processor.selectedCategory.store(settings.category);
+        if (settings.animation >= 0) processor.selectedAnimation.store(settings.animation);
+
+        FixedTempoPlayHead playHead(settings.bpm, sampleRate);
+        processor.setPlayHead(&playHead);
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+        processor.setNonRealtime(true);
+        processor.prepareToPlay(sampleRate, settings.blockSize);
+
+        // Same container and bit depth as the input, written beside the output and moved into
+        // place only once complete, so a failed run never leaves a truncated file behind
+        juce::TemporaryFile temp(result.output);
+        auto* format = formats.findFormatForFileExtension(input.getFileExtension());
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        if (format != nullptr) {
+            auto stream = std::make_unique<juce::FileOutputStream>(temp.getFile());
+            if (stream->openedOk())
+                writer.reset(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels,
+                                                     (int)reader->bitsPerSample, reader->metadataValues, 0));
+            if (writer != nullptr) stream.release();
+        }
+        if (writer == nullptr) { result.error = "cannot write " + result.output.getFullPathName(); return result; }
+
+        juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+        juce::MidiBuffer midi;
+
+        for (juce::int64 position = 0; position < reader->lengthInSamples; position += settings.blockSize) {
+            const int num = (int)juce::jmin((juce::int64)settings.blockSize, reader->lengthInSamples - position);
+            buffer.setSize(numChannels, num, false, false, true);
+            reader->read(&buffer, 0, num, position, true, true);
+
+            playHead.position = position;
+            processor.processBlock(buffer, midi);
+            writer->writeFromAudioSampleBuffer(buffer, 0, num);
+        }
+
+        processor.setNonRealtime(false);
+        processor.releaseResources();
+        writer = nullptr;
+
+        if (!temp.overwriteTargetFileWithTemporary()) { result.error = "cannot write " + result.output.getFullPathName(); return result; }
+
+        result.audioSeconds = (double)reader->lengthInSamples / sampleRate;
+        result.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return result;
+    }
+
+    BatchSettings parseArguments(const juce::ArgumentList& args) {
+        BatchSettings settings;
+        settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile("processed");
+
+        for (int i = 0; i < args.size(); ++i) {
+            const auto arg = args[i].text;
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--preset" && hasValue)         settings.preset = args[++i].resolveAsFile();
+            else if (arg == "--bpm" && hasValue)       settings.bpm = args[++i].text.getDoubleValue();
+            else if (arg == "--category" && hasValue)  settings.category = args[++i].text.getIntValue();
+            else if (arg == "--animation" && hasValue) settings.animation = args[++i].text.getIntValue();
+            else if (arg == "--block" && hasValue)     settings.blockSize = juce::jmax(16, args[++i].text.getIntValue());
+            else if (arg == "--jobs" && hasValue)      settings.numJobs = juce::jmax(1, args[++i].text.getIntValue());
+            else if (arg == "--out-dir" && hasValue)   settings.outputDirectory = args[++i].resolveAsFile();
+            else if (arg == "--set" && hasValue) {
+                auto pair = args[++i].text;
+                settings.overrides.set(pair.upToFirstOccurrenceOf("=", false, false), pair.fromFirstOccurrenceOf("=", false, false));
+            }
+            else if (!arg.startsWith("--"))            settings.inputs.add(args[i].resolveAsFile());
+        }
+
+        return settings;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    auto settings = parseArguments(juce::ArgumentList(argc, argv));
+
+    if (settings.inputs.isEmpty()) {
+        std::cout << "usage: SquabDanceBatch [--preset state.xml] [--set id=value] [--bpm 120] [--category 10] "
+                     "[--animation 0] [--block 512] [--jobs N] [--out-dir dir] files..." << std::endl;
+        return 1;
+    }
+
+    settings.outputDirectory.createDirectory();
+
+    // One processor per file, as many files at once as there are jobs
+    std::vector<FileResult> results(settings.inputs.size());
+    auto start = juce::Time::getHighResolutionTicks();
+    {
+        juce::ThreadPool pool(juce::jmin(settings.numJobs, settings.inputs.size()));
+        for (int i = 0; i < settings.inputs.size(); ++i)
+            pool.addJob([&results, &settings, i] { results[(size_t)i] = processFile(settings.inputs[i], settings); });
+
+        while (pool.getNumJobs() > 0) juce::Thread::sleep(10);
+    }
+    double wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    double totalAudio = 0.0;
+    int failures = 0;
+    for (const auto& r : results) {
+        if (r.error.isNotEmpty()) {
+            std::cout << r.input.getFileName() << ": " << r.error << std::endl;
+            ++failures;
+            continue;
+        }
+
+        totalAudio += r.audioSeconds;
+        std::cout << r.input.getFileName() << ": " << juce::String(r.audioSeconds, 1) << " s in " << juce::String(r.wallSeconds, 2)
+                  << " s (" << juce::String(r.wallSeconds > 0.0 ? r.audioSeconds / r.wallSeconds : 0.0, 1) << "x realtime)" << std::endl;
+    }
+
+    std::cout << "Total: " << juce::String(totalAudio, 1) << " s of audio in " << juce::String(wallSeconds, 2) << " s on "
+              << juce::jmin(settings.numJobs, settings.inputs.size()) << " job(s) = "
+              << juce::String(wallSeconds > 0.0 ? totalAudio / wallSeconds : 0.0, 1) << "x realtime" << std::endl;
+
+    return failures > 0 ? 1 : 0;
+}
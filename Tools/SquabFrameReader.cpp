@@ -0,0 +1,142 @@
+// --- SQUAB DANCE SHARED-FRAME READER ---
+// Reference consumer for the shared-memory frame ring (layout: source/SharedFrameFormat.h).
+// Maps the ring read-only, sleeps on the publish counter and touches each new frame in place,
+// with no copies. Deliberately plain C++ and POSIX only (no JUCE), so it doubles as a template
+// for OBS sources and other overlay tools.
+//
+// Usage:
+//   SquabFrameReader [/squabdance-0] [--frames 600] [--dump frame.bgra]
+
+#include "SharedFrameFormat.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    struct Options
+    {
+        std::string name = "/squabdance-0";
+        long maxFrames = 0;          // 0 = until interrupted
+        std::string dumpPath;        // Raw BGRA of the first complete frame
+    };
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--frames" && i + 1 < argc)    options.maxFrames = std::atol(argv[++i]);
+            else if (arg == "--dump" && i + 1 < argc) options.dumpPath = argv[++i];
+            else if (!arg.empty() && arg[0] == '/')   options.name = arg;
+        }
+        return options;
+    }
+
+    // Something a real consumer would do with the pixels: here, count the visible ones
+    long countVisiblePixels(const std::uint8_t* pixels, const SharedFrameFormat::Header& header)
+    {
+        long visible = 0;
+        for (std::uint32_t y = 0; y < header.height; ++y) {
+            const std::uint8_t* row = pixels + (std::size_t)y * header.stride;
+            for (std::uint32_t x = 0; x < header.width; ++x)
+                if (row[x * 4 + 3] != 0) ++visible;
+        }
+        return visible;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace SharedFrameFormat;
+    auto options = parseOptions(argc, argv);
+
+    int fd = shm_open(options.name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::fprintf(stderr, "cannot open %s (is Frame Sharing on?)\n", options.name.c_str());
+        return 1;
+    }
+
+    struct stat info {};
+    fstat(fd, &info);
+    void* mapping = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED || (std::size_t)info.st_size < sizeof(Header)) {
+        std::fprintf(stderr, "cannot map %s\n", options.name.c_str());
+        return 1;
+    }
+
+    // Read-only mapping: the futex wait only reads the word, so the const_cast is safe
+    auto& header = *const_cast<Header*>(static_cast<const Header*>(mapping));
+
+    if (header.magic != magic || header.version != version || header.pixelFormat != bgraPremultiplied
+        || (std::size_t)info.st_size < getMappingBytes(header.width, header.height)) {
+        std::fprintf(stderr, "%s is not a version %u Squab frame ring\n", options.name.c_str(), version);
+        return 1;
+    }
+
+    std::printf("%s: %ux%u BGRA premultiplied, %u slots\n", options.name.c_str(), header.width, header.height, header.slotCount);
+
+    std::uint32_t lastSeen = header.publishCount.load(std::memory_order_acquire);
+    long framesRead = 0, framesLapped = 0;
+    double latencySumMs = 0.0, latencyMaxMs = 0.0;
+    std::int64_t reportStartNs = getMonotonicNs();
+    long reportFrames = 0;
+
+    while (options.maxFrames == 0 || framesRead < options.maxFrames) {
+        waitForFrame(header, lastSeen, 1000);
+
+        std::uint32_t count = header.publishCount.load(std::memory_order_acquire);
+        if (count == lastSeen) continue;
+        lastSeen = count;
+
+        std::int64_t wokenNs = getMonotonicNs();
+        const auto slot = header.latestSlot.load(std::memory_order_acquire) % numSlots;
+        const auto& slotHeader = header.slots[slot];
+
+        std::uint32_t sequenceBefore = slotHeader.sequence.load(std::memory_order_acquire);
+        if (sequenceBefore & 1) { ++framesLapped; continue; }
+
+        const auto* pixels = static_cast<const std::uint8_t*>(mapping) + header.pixelOffset + slot * header.slotBytes;
+        long visible = countVisiblePixels(pixels, header);
+        std::uint64_t frameCounter = slotHeader.frameCounter;
+        double ppq = slotHeader.ppq;
+        double latencyMs = (double)(wokenNs - slotHeader.timestampNs) / 1.0e6;
+
+        if (!options.dumpPath.empty() && framesRead == 0) {
+            if (FILE* out = std::fopen(options.dumpPath.c_str(), "wb")) {
+                for (std::uint32_t y = 0; y < header.height; ++y)
+                    std::fwrite(pixels + (std::size_t)y * header.stride, 1, (std::size_t)header.width * 4, out);
+                std::fclose(out);
+            }
+        }
+
+        // The writer lapped us while we were reading: this frame may be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slotHeader.sequence.load(std::memory_order_relaxed) != sequenceBefore) { ++framesLapped; continue; }
+
+        ++framesRead;
+        ++reportFrames;
+        latencySumMs += latencyMs;
+        if (latencyMs > latencyMaxMs) latencyMaxMs = latencyMs;
+
+        std::int64_t now = getMonotonicNs();
+        if (now - reportStartNs >= 1000000000) {
+            std::printf("frame %llu  ppq %.3f  %ld fps  wake latency %.3f ms avg / %.3f ms max  %ld visible px  %ld lapped\n",
+                        (unsigned long long)frameCounter, ppq, reportFrames, latencySumMs / (double)framesRead,
+                        latencyMaxMs, visible, framesLapped);
+            reportStartNs = now;
+            reportFrames = 0;
+        }
+    }
+
+    munmap(mapping, (std::size_t)info.st_size);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// --- SQUAB DANCE THUMBNAIL ATLAS GENERATOR ---
+// Build step: renders the preview atlases ThumbnailBrowser plays from the embedded sprite sheets,
+// one PNG per category in the ThumbnailAtlas layout. The plugin embeds the results as the
+// ThumbnailData binary data target, so the browser never has to decode a full sheet.
+//
+// Usage:
+//   SquabThumbnailAtlas --out-dir <dir> [--categories <count the build expects>]
+
+#include <JuceHeader.h>
+#include "SpriteFrameRenderer.h"
+#include "ThumbnailAtlas.h"
+
+namespace
+{
+    // Two halving steps instead of one 4x step, so thin outlines survive the downscale
+    juce::Image makeThumbnail(const juce::Image& sheet, int sx, int sy) {
+        auto frame = sheet.getClippedImage({ sx, sy, SpriteFrameRenderer::frameWidth, SpriteFrameRenderer::frameHeight })
+                          .createCopy();
+        auto half = frame.rescaled(ThumbnailAtlas::cellWidth * 2, ThumbnailAtlas::cellHeight * 2, juce::Graphics::highResamplingQuality);
+        return half.rescaled(ThumbnailAtlas::cellWidth, ThumbnailAtlas::cellHeight, juce::Graphics::highResamplingQuality);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args(argc, argv);
+
+    if (!args.containsOption("--out-dir")) {
+        std::cerr << "Usage: SquabThumbnailAtlas --out-dir <dir> [--categories <n>]" << std::endl;
+        return 1;
+    }
+
+    auto outDir = args.getFileForOption("--out-dir");
+    if (!outDir.createDirectory()) {
+        std::cerr << "Can't create " << outDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto db = SpriteDatabase::getDatabase();
+
+    // The build embeds exactly the atlases it lists; an unlisted one would never reach the browser
+    if (args.containsOption("--categories")) {
+        const int expected = args.getValueForOption("--categories").getIntValue();
+        if (expected != (int)db.size()) {
+            std::cerr << "SpriteDatabase has " << db.size() << " categories but the build lists " << expected
+                      << " atlases: update SQUAB_THUMBNAIL_CATEGORIES in CMakeLists.txt" << std::endl;
+            return 1;
+        }
+    }
+    for (int category = 0; category < (int)db.size(); ++category) {
+        const auto& charDef = db[(size_t)category];
+        const auto set = SpriteSheetSet::load(charDef);
+
+        juce::Image atlas(juce::Image::ARGB, ThumbnailAtlas::cellWidth * ThumbnailAtlas::maxFrames,
+                          ThumbnailAtlas::cellHeight * juce::jmax(1, (int)charDef.anims.size()), true, juce::SoftwareImageType());
+        int missing = 0;
+
+        {
+            juce::Graphics g(atlas);
+            for (int row = 0; row < (int)charDef.anims.size(); ++row) {
+                const auto& anim = charDef.anims[(size_t)row];
+                for (int k = 0; k < ThumbnailAtlas::getNumFrames(anim); ++k) {
+                    int sheetIndex = 0, sx = 0, sy = 0;
+                    if (!SpriteFrameRenderer::locateFrame(set, row, ThumbnailAtlas::getSourceFrame(anim, k), sheetIndex, sx, sy)) {
+                        ++missing;
+                        continue;
+                    }
+
+                    auto cell = ThumbnailAtlas::getCell(row, k);
+                    g.drawImageAt(makeThumbnail(set.sheets[(size_t)sheetIndex], sx, sy), cell.getX(), cell.getY());
+                }
+            }
+        }
+
+        // Always write the file (the build expects every atlas), even if some frames were missing
+        auto file = outDir.getChildFile(ThumbnailAtlas::getFileName(category));
+        file.deleteFile();
+        juce::FileOutputStream out(file);
+        if (!out.openedOk() || !juce::PNGImageFormat().writeImageToStream(atlas, out)) {
+            std::cerr << "Can't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << charDef.categoryName << ": " << charDef.anims.size() << " animations -> " << file.getFileName()
+                  << (missing > 0 ? " (" + juce::String(missing) + " frames missing)" : juce::String()) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+// --- ACTIVITY MODEL ---
+// Tracks whether a component's timers are running flat out or throttled, how long it has spent
+// in each state and what woke it up. Message thread only.
+class ActivityMonitor
+{
+public:
+    enum class WakeReason { transport, parameter, midi, audio, visibility, interaction, numReasons };
+
+    static const char* getReasonName(WakeReason reason) {
+        switch (reason) {
+            case WakeReason::transport:   return "transport";
+            case WakeReason::parameter:   return "parameter";
+            case WakeReason::midi:        return "midi";
+            case WakeReason::audio:       return "audio";
+            case WakeReason::visibility:  return "visibility";
+            case WakeReason::interaction: return "interaction";
+            case WakeReason::numReasons:  break;
+        }
+        return "?";
+    }
+
+    bool isIdle() const { return idle; }
+
+    // Returns true if this actually changed the state
+    bool setIdle(bool shouldBeIdle) {
+        if (idle == shouldBeIdle) return false;
+        accumulate();
+        idle = shouldBeIdle;
+        if (idle) ++numIdlePeriods;
+        return true;
+    }
+
+    // Returns true if the component was idle (the caller then restarts its timers)
+    bool wake(WakeReason reason) {
+        if (!setIdle(false)) return false;
+        ++wakeCounts[(size_t)reason];
+        lastWakeReason = reason;
+        return true;
+    }
+
+    WakeReason getLastWakeReason() const { return lastWakeReason; }
+
+    double getIdleFraction() {
+        accumulate();
+        double total = idleSeconds + activeSeconds;
+        return total > 0.0 ? idleSeconds / total : 0.0;
+    }
+
+    juce::String describe() {
+        double fraction = getIdleFraction();
+        juce::String t;
+        t << (idle ? "idle" : "active") << ", idle " << juce::String(fraction * 100.0, 1) << "% of "
+          << juce::String(idleSeconds + activeSeconds, 0) << " s, " << numIdlePeriods << " idle period(s)\n"
+          << "wakes:";
+        for (int i = 0; i < (int)WakeReason::numReasons; ++i)
+            t << " " << getReasonName((WakeReason)i) << "=" << wakeCounts[(size_t)i];
+        return t;
+    }
+
+private:
+    void accumulate() {
+        auto now = juce::Time::getHighResolutionTicks();
+        double elapsed = juce::Time::highResolutionTicksToSeconds(now - lastChangeTicks);
+        (idle ? idleSeconds : activeSeconds) += elapsed;
+        lastChangeTicks = now;
+    }
+
+    bool idle = false;
+    juce::int64 lastChangeTicks = juce::Time::getHighResolutionTicks();
+    double idleSeconds = 0.0, activeSeconds = 0.0;
+    int numIdlePeriods = 0;
+    WakeReason lastWakeReason = WakeReason::parameter;
+    std::array<int, (size_t)WakeReason::numReasons> wakeCounts {};
+};
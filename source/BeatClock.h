@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+// --- PLAYHEAD SNAPSHOT ---
+// Published once per block by the audio thread. Everything needed to work out
+// "which beat is coming out of the speakers right now" travels together.
+struct PlayheadSnapshot
+{
+    double ppq = 0.0;                 // Position of the first sample in the block
+    double bpm = 120.0;
+    bool isPlaying = false;
+
+    juce::int64 samplePosition = 0;
+    juce::uint64 hostTimeNs = 0;      // Host's own clock, when it provides one (0 otherwise)
+
+    double sampleRate = 44100.0;
+    int blockSize = 0;
+    int latencySamples = 0;           // Plugin latency + audio device output latency
+
+    juce::int64 publishTicks = 0;     // juce::Time::getHighResolutionTicks() at publish
+};
+
+// --- SAMPLE-ACCURATE BEAT CLOCK ---
+// The audio thread publishes snapshots; the render side asks for the ppq at "now" and gets it
+// extrapolated from the newest snapshot with the high-resolution clock, shifted by the time it
+// takes that block to actually reach the listener. Only one thread may call the reader methods.
+class BeatClock
+{
+public:
+    // --- Audio thread ---
+    void publish(const PlayheadSnapshot& snapshot) { channel.write(snapshot); }
+
+    // --- Render thread ---
+    const PlayheadSnapshot& getLatest() {
+        channel.read(latest);
+        return latest;
+    }
+
+    // The audible ppq and whether the transport runs, both from the same snapshot (reading them
+    // separately could pair a stopped position with a playing flag across a publish)
+    struct Position
+    {
+        double ppq = 0.0;
+        bool isPlaying = false;
+    };
+
+    Position getPositionAt(juce::int64 nowTicks) {
+        const auto& s = getLatest();
+        if (!s.isPlaying || s.sampleRate <= 0.0) {
+            lastPpq = s.ppq;
+            return { s.ppq, false };
+        }
+
+        double elapsed = juce::Time::highResolutionTicksToSeconds(nowTicks - s.publishTicks);
+
+        // A block published now starts playing about one block later (the host double-buffers),
+        // then sits behind the plugin's own latency and the device's output latency.
+        double audibleDelay = (double)(s.blockSize + s.latencySamples) / s.sampleRate;
+
+        double ppq = s.ppq + (elapsed - audibleDelay) * (s.bpm / 60.0);
+
+        // Snapshots jitter by a fraction of a block; never step backwards by such a small amount,
+        // otherwise the dancer flickers between two frames on a beat boundary.
+        double backStep = lastPpq - ppq;
+        if (backStep > 0.0 && backStep < maxJitterBeats) ppq = lastPpq;
+
+        lastPpq = ppq;
+        return { ppq, true };
+    }
+
+    Position getPositionNow() { return getPositionAt(juce::Time::getHighResolutionTicks()); }
+
+    double getPpqAt(juce::int64 nowTicks) { return getPositionAt(nowTicks).ppq; }
+    double getPpqNow() { return getPpqAt(juce::Time::getHighResolutionTicks()); }
+
+private:
+    static constexpr double maxJitterBeats = 1.0 / 16.0;
+
+    TripleBuffer<PlayheadSnapshot> channel;
+    PlayheadSnapshot latest;
+    double lastPpq = 0.0;
+};
@@ -0,0 +1,371 @@
+#pragma once
+#include <JuceHeader.h>
+#include <unordered_map>
+#include "SpriteData.h"
+#include "SpriteGrade.h"
+#include "MemoryAccounting.h"
+#include "Tracing.h"
+
+// --- CROWD MODE ---
+// Draws a whole stage of dancers behind the lead in one pass:
+//   * every dancer samples the same decoded sheets (no per-dancer copies),
+//   * colour grading runs once per unique (frame, grade) pair and is cached,
+//   * draws are sorted by depth row, then by sheet, so neighbouring draws hit the same memory,
+//   * with workers the stage canvas is split into horizontal tiles rendered in parallel.
+
+struct CrowdDancer
+{
+    int row = 0;                    // Animation row in the character's AnimationDef list
+    int frameOffset = 0;            // Phase: frames ahead of the shared clock
+    float scale = 1.0f;
+    juce::Point<float> foot;        // Bottom-centre of the sprite, in stage coordinates
+    int depth = 0;                  // Layout row, 0 = furthest back
+};
+
+class CrowdRenderer
+{
+public:
+    static constexpr int frameWidth = 220;
+    static constexpr int frameHeight = 256;
+    static constexpr int maxDancers = 128;
+
+    CrowdRenderer() {
+        evictorId = MemoryAccounting::Ledger::getInstance().addEvictor([this](juce::int64 bytesNeeded) { return evictGrades(bytesNeeded); });
+    }
+
+    ~CrowdRenderer() {
+        MemoryAccounting::Ledger::getInstance().removeEvictor(evictorId);
+        pool = nullptr; // Workers reference our members, so they go first
+    }
+
+    void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const std::vector<juce::Image>& sheets) {
+        isGridSprite = isGrid;
+        animations = anims;
+
+        // The workers draw from these, so they get software images like everything else they
+        // touch (convert() hands back the same image when it already is one)
+        spriteSheets.clear();
+        for (const auto& sheet : sheets) spriteSheets.push_back(juce::SoftwareImageType().convert(sheet));
+        clearGradeCache();
+        dancers.clear();
+    }
+
+    // Places `numDancers` on a stage of the given size: rows from back (small, high) to front
+    // (large, low), random moves and phases, never the "held" pose the lead uses for dragging.
+    void layoutStage(int numDancers, juce::Rectangle<int> stageArea, float baseScale, int excludeRow, juce::uint32 seed) {
+        dancers.clear();
+        stage = stageArea;
+        numDancers = juce::jlimit(0, maxDancers, numDancers);
+        if (numDancers == 0 || animations.empty()) return;
+
+        const float widthRatio = (float)stage.getWidth() / (float)stage.getHeight();
+        const int numRows = juce::jmax(1, (int)std::ceil(std::sqrt((float)numDancers / juce::jmax(1.0f, widthRatio * 2.0f))));
+        const int perRow = (numDancers + numRows - 1) / numRows;
+
+        juce::Random rng((juce::int64)seed);
+        int placed = 0;
+
+        for (int r = 0; r < numRows && placed < numDancers; ++r) {
+            float depthT = numRows > 1 ? (float)r / (float)(numRows - 1) : 1.0f;
+            float rowScale = baseScale * (0.45f + 0.4f * depthT);
+            float footY = (float)stage.getHeight() * (0.55f + 0.45f * depthT);
+            int inRow = juce::jmin(perRow, numDancers - placed);
+
+            for (int i = 0; i < inRow; ++i, ++placed) {
+                CrowdDancer d;
+                d.depth = r;
+                d.row = pickRow(rng, excludeRow);
+                d.frameOffset = rng.nextInt(juce::jmax(1, animations[(size_t)d.row].frameCount));
+                d.scale = rowScale * (0.9f + 0.2f * rng.nextFloat());
+
+                // Staggered columns with a little jitter so rows don't line up like a grid
+                float slot = ((float)i + 0.5f + ((r % 2) ? 0.25f : -0.25f)) / (float)inRow;
+                float x = slot * (float)stage.getWidth() + (rng.nextFloat() - 0.5f) * 20.0f;
+                d.foot = { x, footY + (rng.nextFloat() - 0.5f) * 12.0f };
+                dancers.push_back(d);
+            }
+        }
+
+        // Always a software image: the tiles are rasterised concurrently on the workers, which is
+        // only safe on a plain memory bitmap, not a native (GPU-backed) one. The same goes for the
+        // sheets and graded frames they draw from (see setSpriteData and gradeUniqueFrames).
+        canvas = juce::Image(juce::Image::ARGB, juce::jmax(1, stage.getWidth()), juce::jmax(1, stage.getHeight()), true,
+                             juce::SoftwareImageType());
+        canvasBytes = MemoryAccounting::Allocation(MemoryAccounting::Tag::scratch, MemoryAccounting::getImageBytes(canvas));
+    }
+
+    int getNumDancers() const { return (int)dancers.size(); }
+
+    // 0 = render on the calling thread only
+    void setNumWorkers(int numWorkers) {
+        numWorkers = juce::jmax(0, numWorkers);
+        if (numWorkers == (pool != nullptr ? pool->getNumThreads() : 0)) return;
+        pool = numWorkers > 0 ? std::make_unique<juce::ThreadPool>(numWorkers) : nullptr;
+    }
+
+    // `clock` is the shared animation position in frames (Hz tick count, or beats / beat length)
+    void render(juce::Graphics& g, juce::int64 clock, float pump, const SpriteGrade& grade,
+                juce::Graphics::ResamplingQuality quality) {
+        SQUAB_TRACE_ZONE("paint.crowd");
+        if (dancers.empty() || spriteSheets.empty() || !canvas.isValid()) return;
+
+        ++renderSerial;
+        const auto crowdGrade = snapGrade(grade);
+        buildDrawList(clock, pump, crowdGrade);
+        gradeUniqueFrames(crowdGrade);
+
+        // --- Tiled rasterisation ---
+        const int numTiles = pool != nullptr ? juce::jmax(1, pool->getNumThreads() + 1) * 2 : 1;
+        const int tileHeight = (canvas.getHeight() + numTiles - 1) / numTiles;
+
+        parallelFor(numTiles, [&](int t) {
+            juce::Rectangle<int> tile(0, t * tileHeight, canvas.getWidth(), tileHeight);
+            tile = tile.getIntersection(canvas.getBounds());
+            if (tile.isEmpty()) return;
+
+            juce::Image tileImage = canvas.getClippedImage(tile);
+            tileImage.clear(tileImage.getBounds());
+
+            juce::Graphics tg(tileImage);
+            tg.setImageResamplingQuality(quality);
+            tg.setOrigin(-tile.getPosition());
+
+            auto tileArea = tile.toFloat();
+            for (const auto& d : draws)
+                if (d.dest.intersects(tileArea))
+                    tg.drawImage(*d.source, d.dest.getX(), d.dest.getY(), d.dest.getWidth(), d.dest.getHeight(),
+                                 d.srcX, d.srcY, frameWidth, frameHeight);
+        });
+
+        trimGradeCache();
+        g.drawImageAt(canvas, stage.getX(), stage.getY());
+    }
+
+    juce::String describe() const {
+        return juce::String(dancers.size()) + " dancers, " + juce::String(draws.size()) + " draws, "
+             + juce::String(lastUniqueGrades) + " graded this frame, " + juce::String(gradeCache.size()) + " cached, "
+             + juce::String(pool != nullptr ? pool->getNumThreads() : 0) + " worker(s)";
+    }
+
+private:
+    struct Draw
+    {
+        const juce::Image* source = nullptr; // Sheet or cached graded frame
+        int srcX = 0, srcY = 0;
+        juce::Rectangle<float> dest;
+        juce::uint64 sortKey = 0;
+        juce::uint64 gradeKey = 0;
+        int sheetIndex = 0;
+    };
+
+    struct GradedFrame
+    {
+        juce::Image image;
+        MemoryAccounting::Allocation bytes;
+        juce::uint64 lastUsed = 0;
+    };
+
+    int pickRow(juce::Random& rng, int excludeRow) const {
+        int numRows = (int)animations.size();
+        if (numRows <= 1) return 0;
+        int row = rng.nextInt(numRows - 1);
+        return (excludeRow >= 0 && row >= excludeRow) ? row + 1 : row;
+    }
+
+    // Same frame addressing as the lead dancer (grid sheets hold 9x8 frames, strips one row per move)
+    bool locateFrame(int row, int frame, int& sheetIndex, int& sx, int& sy) const {
+        if (isGridSprite) {
+            int offset = 0;
+            for (int i = 0; i < row && i < (int)animations.size(); ++i) offset += animations[(size_t)i].frameCount;
+            int globalFrame = offset + frame;
+            sheetIndex = globalFrame / 72;
+            sx = (globalFrame % 72 % 9) * frameWidth;
+            sy = (globalFrame % 72 / 9) * frameHeight;
+        } else {
+            sheetIndex = 0;
+            sx = frame * frameWidth;
+            sy = row * frameHeight;
+        }
+
+        if (sheetIndex < 0 || sheetIndex >= (int)spriteSheets.size()) return false;
+        const auto& sheet = spriteSheets[(size_t)sheetIndex];
+        return sheet.isValid() && sx >= 0 && sy >= 0 && sx + frameWidth <= sheet.getWidth() && sy + frameHeight <= sheet.getHeight();
+    }
+
+    // The lead's grade follows the spectrum continuously, so keyed exactly it would almost never
+    // repeat. The crowd is graded with a coarsely snapped copy instead (steps too small to see on
+    // dancers this size), which repeats from frame to frame and makes the cache actually hit.
+    static SpriteGrade snapGrade(const SpriteGrade& grade) {
+        auto snap = [](float v, float steps) { return (float)juce::roundToInt(v * steps) / steps; };
+        SpriteGrade snapped;
+        snapped.hueShift = snap(std::fmod(juce::jmax(0.0f, grade.hueShift), 1.0f), hueSteps);
+        snapped.satBoost = snap(grade.satBoost, satSteps);
+        snapped.brightBoost = snap(grade.brightBoost, brightSteps);
+        return snapped;
+    }
+
+    static juce::uint64 quantiseGrade(const SpriteGrade& snapped) {
+        if (snapped.isNeutral()) return 0;
+        auto q = [](float v, float steps) { return (juce::uint64)juce::jlimit(0, 1023, juce::roundToInt(v * steps)); };
+        return 1 | (q(snapped.hueShift, hueSteps) << 1) | (q(snapped.satBoost, satSteps) << 11) | (q(snapped.brightBoost, brightSteps) << 21);
+    }
+
+    void buildDrawList(juce::int64 clock, float pump, const SpriteGrade& grade) {
+        draws.clear();
+        const juce::uint64 gradeKey = quantiseGrade(grade);
+
+        for (const auto& d : dancers) {
+            int frames = juce::jmax(1, animations[(size_t)d.row].frameCount);
+            int frame = (int)((clock + d.frameOffset) % frames);
+            if (frame < 0) frame += frames;
+
+            Draw draw;
+            if (!locateFrame(d.row, frame, draw.sheetIndex, draw.srcX, draw.srcY)) continue;
+
+            float s = d.scale * (1.0f + pump);
+            float w = frameWidth * s, h = frameHeight * s;
+            draw.dest = { d.foot.x - w * 0.5f, d.foot.y - h, w, h };
+            draw.source = &spriteSheets[(size_t)draw.sheetIndex];
+
+            // Frame identity: sheet / column / row packed into the low bits, grade above them
+            juce::uint64 frameKey = ((juce::uint64)draw.sheetIndex << 16) | ((juce::uint64)(draw.srcX / frameWidth) << 8) | (juce::uint64)(draw.srcY / frameHeight);
+            draw.gradeKey = gradeKey != 0 ? (frameKey | (gradeKey << 24)) : 0;
+
+            // Back rows first; within a row group by sheet and frame for locality
+            draw.sortKey = ((juce::uint64)d.depth << 48) | frameKey;
+            draws.push_back(draw);
+        }
+
+        std::stable_sort(draws.begin(), draws.end(), [](const Draw& a, const Draw& b) { return a.sortKey < b.sortKey; });
+    }
+
+    // Grades each distinct (frame, grade) once and points every draw that shares it at the result
+    void gradeUniqueFrames(const SpriteGrade& grade) {
+        lastUniqueGrades = 0;
+        if (grade.isNeutral()) return;
+
+        std::vector<std::pair<juce::uint64, Draw*>> missing;
+        {
+            const juce::ScopedLock sl(cacheLock);
+            for (auto& d : draws) {
+                auto it = gradeCache.find(d.gradeKey);
+                if (it != gradeCache.end()) {
+                    it->second.lastUsed = renderSerial;
+                    continue;
+                }
+                if (std::none_of(missing.begin(), missing.end(), [&](auto& m) { return m.first == d.gradeKey; }))
+                    missing.push_back({ d.gradeKey, &d });
+            }
+        }
+
+        std::vector<juce::Image> graded(missing.size());
+        parallelFor((int)missing.size(), [&](int i) {
+            const Draw& d = *missing[(size_t)i].second;
+            juce::Image img(juce::Image::ARGB, frameWidth, frameHeight, true, juce::SoftwareImageType());
+            {
+                juce::Graphics gFrame(img);
+                gFrame.drawImage(*d.source, 0, 0, frameWidth, frameHeight, d.srcX, d.srcY, frameWidth, frameHeight);
+            }
+            grade.apply(img);
+            graded[(size_t)i] = img;
+        });
+        lastUniqueGrades = (int)missing.size();
+
+        // Accounting may evict, so register the bytes before taking the cache lock
+        std::vector<MemoryAccounting::Allocation> tokens;
+        for (auto& img : graded)
+            tokens.emplace_back(MemoryAccounting::Tag::frameCache, MemoryAccounting::getImageBytes(img));
+
+        const juce::ScopedLock sl(cacheLock);
+        for (size_t i = 0; i < missing.size(); ++i) {
+            auto& entry = gradeCache[missing[i].first];
+            entry.image = graded[i];
+            entry.bytes = std::move(tokens[i]);
+            entry.lastUsed = renderSerial;
+        }
+
+        for (auto& d : draws) {
+            auto it = gradeCache.find(d.gradeKey);
+            if (it == gradeCache.end()) continue;
+            d.source = &it->second.image;
+            d.srcX = d.srcY = 0;
+        }
+    }
+
+    // Keep the cache to roughly one animation cycle's worth of graded frames
+    void trimGradeCache() {
+        const juce::ScopedLock sl(cacheLock);
+        for (auto it = gradeCache.begin(); it != gradeCache.end();) {
+            if (gradeCache.size() <= maxCachedGrades) break;
+            if (it->second.lastUsed + 2 < renderSerial) it = gradeCache.erase(it);
+            else ++it;
+        }
+    }
+
+    juce::int64 evictGrades(juce::int64 bytesNeeded) {
+        const juce::ScopedLock sl(cacheLock);
+        juce::int64 freed = 0;
+        for (auto it = gradeCache.begin(); it != gradeCache.end() && freed < bytesNeeded;) {
+            if (it->second.lastUsed == renderSerial) { ++it; continue; } // Being drawn right now
+            freed += it->second.bytes.getBytes();
+            it = gradeCache.erase(it);
+        }
+        return freed;
+    }
+
+    void clearGradeCache() {
+        const juce::ScopedLock sl(cacheLock);
+        gradeCache.clear();
+    }
+
+    // Runs fn(0..n-1) across the pool plus the calling thread, and returns when all are done
+    template <typename Fn>
+    void parallelFor(int n, Fn&& fn) {
+        if (pool == nullptr || n < 2) {
+            for (int i = 0; i < n; ++i) fn(i);
+            return;
+        }
+
+        std::atomic<int> next { 0 };
+        auto work = [&] { for (int i; (i = next.fetch_add(1)) < n;) fn(i); };
+
+        const int numJobs = juce::jmin(pool->getNumThreads(), n - 1);
+        std::atomic<int> remaining { numJobs };
+        juce::WaitableEvent done;
+
+        for (int j = 0; j < numJobs; ++j)
+            pool->addJob([&] {
+                work();
+                if (remaining.fetch_sub(1) == 1) done.signal();
+                return juce::ThreadPoolJob::jobHasFinished;
+            });
+
+        work();
+        done.wait();
+    }
+
+    static constexpr size_t maxCachedGrades = 256;
+    static constexpr float hueSteps = 32.0f;      // Per hue turn
+    static constexpr float satSteps = 8.0f;       // Per unit of boost (satBoost runs 0..2)
+    static constexpr float brightSteps = 16.0f;   // brightBoost runs 0..0.6
+
+    bool isGridSprite = false;
+    std::vector<AnimationDef> animations;
+    std::vector<juce::Image> spriteSheets;
+
+    std::vector<CrowdDancer> dancers;
+    std::vector<Draw> draws;
+    juce::Rectangle<int> stage;
+    juce::Image canvas;
+    MemoryAccounting::Allocation canvasBytes;
+
+    juce::CriticalSection cacheLock;
+    std::unordered_map<juce::uint64, GradedFrame> gradeCache;
+    std::atomic<juce::uint64> renderSerial { 0 }; // Also read by the evictor, from other threads
+    int lastUniqueGrades = 0;
+    int evictorId = 0;
+
+    std::unique_ptr<juce::ThreadPool> pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CrowdRenderer)
+};
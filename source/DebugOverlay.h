@@ -0,0 +1,89 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Tracing.h"
+
+// --- HIDDEN DEBUG OVERLAY ---
+// Toggled from the editor with Ctrl+Shift+D. Shows live per-zone timings from the tracing layer
+// plus any extra sections other subsystems register, and exports the trace for chrome://tracing
+// or ui.perfetto.dev. An export ends the capture: the trace buffers start over afterwards.
+class DebugOverlay : public juce::Component, private juce::Timer
+{
+public:
+    DebugOverlay() {
+        addAndMakeVisible(exportButton);
+        exportButton.setButtonText("Export Trace");
+        exportButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xFF2A2A2A));
+        exportButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+        exportButton.onClick = [this] { exportTrace(); };
+
+        setInterceptsMouseClicks(true, true);
+    }
+
+    // Extra lines (memory, idle stats, quality level ...) supplied by other subsystems
+    void addSection(const juce::String& title, std::function<juce::String()> provider) {
+        sections.push_back({ title, std::move(provider) });
+    }
+
+    void toggle() {
+        setVisible(!isVisible());
+        if (isVisible()) { toFront(false); refresh(); startTimerHz(4); }
+        else stopTimer();
+    }
+
+    void paint(juce::Graphics& g) override {
+        g.fillAll(juce::Colours::black.withAlpha(0.85f));
+        g.setColour(juce::Colours::white);
+        g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+        g.drawMultiLineText(text, 10, 20, getWidth() - 20);
+    }
+
+    void resized() override {
+        exportButton.setBounds(getWidth() - 110, 8, 100, 22);
+    }
+
+private:
+    struct Section { juce::String title; std::function<juce::String()> provider; };
+
+    void timerCallback() override { refresh(); }
+
+    void refresh() {
+        juce::String t;
+
+       #if SQUAB_ENABLE_TRACING
+        t << "ZONES (last 1 s)            count     avg ms     max ms\n";
+        for (auto& [name, s] : Tracing::collectZoneStats(1.0))
+            t << name.paddedRight(' ', 26) << juce::String(s.count).paddedLeft(' ', 7)
+              << juce::String(s.getAverageMs(), 3).paddedLeft(' ', 11)
+              << juce::String(s.maxMs, 3).paddedLeft(' ', 11) << "\n";
+       #else
+        t << "Tracing is compiled out (build with SQUAB_ENABLE_TRACING=ON)\n";
+       #endif
+
+        for (auto& section : sections)
+            t << "\n" << section.title.toUpperCase() << "\n" << section.provider() << "\n";
+
+        if (statusMessage.isNotEmpty()) t << "\n" << statusMessage << "\n";
+
+        text = t;
+        repaint();
+    }
+
+    void exportTrace() {
+       #if SQUAB_ENABLE_TRACING
+        auto file = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                        .getNonexistentChildFile("SquabDance-trace", ".json");
+        statusMessage = Tracing::exportChromeTrace(file) ? "Trace written to " + file.getFullPathName()
+                                                         : "Could not write " + file.getFullPathName();
+        Tracing::Registry::getInstance().reset();
+       #else
+        statusMessage = "Tracing is compiled out of this build";
+       #endif
+        refresh();
+    }
+
+    juce::TextButton exportButton;
+    std::vector<Section> sections;
+    juce::String text, statusMessage;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DebugOverlay)
+};
@@ -0,0 +1,361 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include "Telemetry.h"
+#include "SpriteFrameRenderer.h"
+#include "Tracing.h"
+
+#if ! JUCE_WINDOWS
+ #include <csignal>
+ #include <fcntl.h>
+ #include <pthread.h>
+#endif
+
+// --- OFFLINE FRAME EXPORT SETTINGS ---
+struct ExportSettings
+{
+    enum class Mode { off = 0, pngSequence, rawPipe };
+
+    Mode mode = Mode::off;
+    double fps = 30.0;
+    int width = 1920, height = 1080;
+    int category = 0;               // Index into SpriteDatabase::getDatabase()
+    juce::File directory;           // PNG frames (and whatever the encoder command writes)
+    juce::String encoderCommand;    // Raw RGBA on stdin; {width} {height} {fps} {dir} are filled in
+
+    static juce::File getDefaultDirectory() {
+        return juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("SquabDance Export");
+    }
+
+    static juce::String getDefaultEncoderCommand() {
+        return "ffmpeg -y -loglevel error -f rawvideo -pix_fmt rgba -s {width}x{height} -r {fps} -i - "
+               "-c:v prores_ks -profile:v 4444 -pix_fmt yuva444p10le \"{dir}/squabdance.mov\"";
+    }
+
+    // Empty if the encoder's executable (the command's first word) can be found, otherwise why
+    // not. popen() succeeds even for a missing program (the shell starts fine), so this is the
+    // only chance to report it before the first frame goes nowhere.
+    juce::String findEncoderProblem() const {
+        auto program = juce::StringArray::fromTokens(encoderCommand.trim(), " ", "\"")[0].unquoted();
+        if (program.isEmpty()) return "no encoder command";
+
+        if (juce::File::isAbsolutePath(program))
+            return juce::File(program).existsAsFile() ? juce::String() : "encoder not found: " + program;
+
+       #if JUCE_WINDOWS
+        const auto separator = ";";
+        const juce::StringArray suffixes { "", ".exe", ".bat", ".cmd" };
+       #else
+        const auto separator = ":";
+        const juce::StringArray suffixes { "" };
+       #endif
+        for (auto& dir : juce::StringArray::fromTokens(juce::SystemStats::getEnvironmentVariable("PATH", {}), separator, {}))
+            for (auto& suffix : suffixes)
+                if (dir.isNotEmpty() && juce::File::isAbsolutePath(dir) && juce::File(dir).getChildFile(program + suffix).existsAsFile())
+                    return {};
+
+        return "encoder not found on PATH: " + program;
+    }
+
+    juce::String getResolvedEncoderCommand() const {
+        return encoderCommand.replace("{width}", juce::String(width))
+                             .replace("{height}", juce::String(height))
+                             .replace("{fps}", juce::String(fps))
+                             .replace("{dir}", directory.getFullPathName());
+    }
+};
+
+// One frame of the bounce, fully described by the audio thread's frame clock
+struct ExportFrameJob
+{
+    juce::int64 index = 0;
+    SpriteFrameState state;
+};
+
+// --- OFFLINE FRAME EXPORTER ---
+// The audio thread only pushes small frame descriptions into a ring; a dispatcher thread hands
+// them to a worker pool that renders and encodes them in parallel, so the bounce runs as fast as
+// the cores allow and the message thread is never involved. Every frame is a pure function of
+// its job (SpriteFrameRenderer), so the same bounce produces the same bytes every time.
+// PNG frames are written by the workers in any order; the raw pipe needs frames in order, so
+// finished frames wait in a reorder buffer until their turn. Frames in flight are bounded, which
+// also bounds memory, and a full ring makes the (offline, so allowed to block) audio thread wait.
+class FrameExporter
+{
+public:
+    ~FrameExporter() { finish(); }
+
+    bool isRunning() const { return running.load(); }
+    juce::int64 getNumSubmitted() const { return framesSubmitted.load(); }
+
+    // False (with the reason in describe()) if the export cannot run at all
+    bool start(const ExportSettings& newSettings) {
+        finish();
+
+        {
+            // describe() reads these from the message thread
+            const juce::ScopedLock sl(statusLock);
+            settings = newSettings;
+            lastError.clear();
+        }
+        framesSubmitted = 0;
+        framesWritten = 0;
+        startTicks = juce::Time::getHighResolutionTicks();
+
+        if (newSettings.mode == ExportSettings::Mode::rawPipe) {
+            auto problem = newSettings.findEncoderProblem();
+            if (problem.isNotEmpty()) {
+                setError(problem);
+                finishedSeconds = 0.0;
+                return false;
+            }
+        }
+
+        dispatcher = std::make_unique<Dispatcher>(*this);
+        dispatcher->startThread();
+        running = true;
+        return true;
+    }
+
+    // Audio thread (offline only, so waiting for room is allowed)
+    void submit(const ExportFrameJob& job) {
+        if (dispatcher == nullptr) return;
+
+        while (jobs.getFreeSpace() == 0 && dispatcher->isThreadRunning())
+            juce::Thread::sleep(1);
+
+        if (jobs.push(job)) ++framesSubmitted;
+        dispatcher->notify();
+    }
+
+    // Waits for every submitted frame to be written and closes the encoder
+    void finish() {
+        if (dispatcher == nullptr) return;
+        running = false;
+        dispatcher->finishing = true;
+        dispatcher->notify();
+        dispatcher->waitForThreadToExit(-1);
+        dispatcher = nullptr;
+        finishedSeconds = getElapsedSeconds();
+    }
+
+    juce::String describe() const {
+        const juce::ScopedLock sl(statusLock);
+        double elapsed = isRunning() ? getElapsedSeconds() : finishedSeconds;
+        juce::int64 written = framesWritten.load();
+        double realtimeMultiple = elapsed > 0.0 ? (written / settings.fps) / elapsed : 0.0;
+
+        juce::String t;
+        t << (isRunning() ? "exporting" : "idle") << ", " << written << "/" << framesSubmitted.load() << " frame(s) at "
+          << settings.width << "x" << settings.height << " " << juce::String(settings.fps, 0) << " fps, "
+          << juce::String(realtimeMultiple, 1) << "x realtime";
+        if (lastError.isNotEmpty()) t << "\nerror: " << lastError;
+        return t;
+    }
+
+private:
+    static constexpr int queueCapacity = 1024;
+
+    double getElapsedSeconds() const {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks.load());
+    }
+
+    void setError(const juce::String& message) {
+        const juce::ScopedLock sl(statusLock);
+        if (lastError.isEmpty()) lastError = message;
+    }
+
+    class Dispatcher : public juce::Thread
+    {
+    public:
+        explicit Dispatcher(FrameExporter& o)
+            : juce::Thread("Squab Export"), owner(o),
+              numWorkers(juce::jmax(1, juce::SystemStats::getNumCpus() - 1)),
+              maxInFlight(numWorkers * 2), pool(numWorkers) {}
+
+        ~Dispatcher() override {
+            stopThread(-1);
+            pool.removeAllJobs(true, -1);
+        }
+
+        void run() override {
+            SQUAB_TRACE_THREAD("Export");
+            const auto& settings = owner.settings;
+
+            auto db = SpriteDatabase::getDatabase();
+            if (!db.empty()) sheets = SpriteSheetSet::load(db[(size_t)juce::jlimit(0, (int)db.size() - 1, settings.category)]);
+            if (!sheets.isValid()) owner.setError("no sprite sheets for the selected character");
+
+            if (!settings.directory.createDirectory()) owner.setError("cannot create " + settings.directory.getFullPathName());
+
+            if (settings.mode == ExportSettings::Mode::rawPipe) {
+                blockSigpipe();
+               #if JUCE_WINDOWS
+                pipe = _popen(settings.getResolvedEncoderCommand().toRawUTF8(), "wb");
+               #else
+                pipe = popen(settings.getResolvedEncoderCommand().toRawUTF8(), "w");
+               #endif
+                if (pipe == nullptr) owner.setError("cannot start encoder: " + settings.getResolvedEncoderCommand());
+               #if JUCE_MAC
+                else fcntl(fileno(pipe), F_SETNOSIGPIPE, 1);
+               #endif
+            }
+
+            while (!threadShouldExit()) {
+                owner.jobs.drain([this](const ExportFrameJob& job) { waiting.push_back(job); });
+
+                while (!waiting.empty() && inFlight.load() < maxInFlight) {
+                    ++inFlight;
+                    auto job = waiting.front();
+                    waiting.pop_front();
+                    pool.addJob([this, job] { renderFrame(job); });
+                }
+
+                writeReadyFrames();
+
+                if (finishing && waiting.empty() && owner.jobs.getNumReady() == 0 && inFlight.load() == 0) break;
+                wait(5);
+            }
+
+            pool.removeAllJobs(false, -1);
+            closePipe();
+        }
+
+        std::atomic<bool> finishing { false };
+
+    private:
+        // Worker thread
+        void renderFrame(const ExportFrameJob& job) {
+            SQUAB_TRACE_ZONE("exportFrame");
+            const auto& settings = owner.settings;
+
+            auto target = SpriteFrameRenderer::createScratchImage(settings.width, settings.height);
+            auto frameScratch = SpriteFrameRenderer::createScratchImage();
+            auto reflectionScratch = SpriteFrameRenderer::createScratchImage();
+            SpriteGlow glowScratch;
+            SpriteFrameRenderer::render(target, sheets, job.state, frameScratch, reflectionScratch, glowScratch);
+
+            if (settings.mode == ExportSettings::Mode::pngSequence) {
+                auto file = settings.directory.getChildFile("frame_" + juce::String(job.index).paddedLeft('0', 6) + ".png");
+                file.deleteFile();
+                juce::FileOutputStream out(file);
+                juce::PNGImageFormat png;
+                if (!out.openedOk() || !png.writeImageToStream(target, out)) owner.setError("cannot write " + file.getFullPathName());
+
+                ++owner.framesWritten;
+                --inFlight;
+                notify();
+                return;
+            }
+
+            // Raw pipe: straight (un-premultiplied) RGBA, top row first
+            juce::MemoryBlock rgba((size_t)settings.width * (size_t)settings.height * 4);
+            {
+                juce::Image::BitmapData data(target, juce::Image::BitmapData::readOnly);
+                auto* dest = static_cast<juce::uint8*>(rgba.getData());
+
+                for (int y = 0; y < data.height; ++y) {
+                    for (int x = 0; x < data.width; ++x) {
+                        auto p = *reinterpret_cast<const juce::PixelARGB*>(data.getPixelPointer(x, y));
+                        p.unpremultiply();
+                        *dest++ = p.getRed(); *dest++ = p.getGreen(); *dest++ = p.getBlue(); *dest++ = p.getAlpha();
+                    }
+                }
+            }
+
+            const juce::ScopedLock sl(reorderLock);
+            finished.emplace(job.index, std::move(rgba));
+            notify();
+        }
+
+        // Dispatcher thread: feed the encoder every frame whose predecessors are all written
+        void writeReadyFrames() {
+            if (owner.settings.mode != ExportSettings::Mode::rawPipe) return;
+
+            for (;;) {
+                juce::MemoryBlock frame;
+                {
+                    const juce::ScopedLock sl(reorderLock);
+                    auto it = finished.find(nextToWrite);
+                    if (it == finished.end()) return;
+                    frame = std::move(it->second);
+                    finished.erase(it);
+                }
+
+                if (pipe != nullptr && std::fwrite(frame.getData(), 1, frame.getSize(), pipe) != frame.getSize()) {
+                    owner.setError("encoder stopped accepting frames");
+                    discardPendingSigpipe();
+                    closePipe();
+                }
+
+                ++nextToWrite;
+                ++owner.framesWritten;
+                --inFlight;
+            }
+        }
+
+        // --- SIGPIPE ---
+        // If the encoder exits early, writing to its pipe raises SIGPIPE, whose default action
+        // kills the whole process: the host DAW. Only this thread writes to the pipe, so the
+        // signal is blocked here (Linux; macOS uses F_SETNOSIGPIPE on the pipe instead) and the
+        // write fails with EPIPE. A SIGPIPE left pending is taken off again after the failure.
+        static void blockSigpipe() {
+           #if JUCE_LINUX || JUCE_BSD
+            sigset_t set;
+            sigemptyset(&set);
+            sigaddset(&set, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &set, nullptr);
+           #endif
+        }
+
+        static void discardPendingSigpipe() {
+           #if JUCE_LINUX
+            sigset_t set;
+            sigemptyset(&set);
+            sigaddset(&set, SIGPIPE);
+            const timespec noWait { 0, 0 };
+            while (sigtimedwait(&set, nullptr, &noWait) == SIGPIPE) {}
+           #endif
+        }
+
+        void closePipe() {
+            if (pipe == nullptr) return;
+           #if JUCE_WINDOWS
+            _pclose(pipe);
+           #else
+            pclose(pipe);
+           #endif
+            pipe = nullptr;
+        }
+
+        FrameExporter& owner;
+        const int numWorkers;
+        const int maxInFlight;
+        juce::ThreadPool pool;
+        SpriteSheetSet sheets;
+
+        std::deque<ExportFrameJob> waiting;
+        std::atomic<int> inFlight { 0 };
+
+        juce::CriticalSection reorderLock;
+        std::map<juce::int64, juce::MemoryBlock> finished;
+        juce::int64 nextToWrite = 0;
+        FILE* pipe = nullptr;
+    };
+
+    ExportSettings settings;
+    SpscRing<ExportFrameJob, queueCapacity> jobs;
+    std::unique_ptr<Dispatcher> dispatcher;
+    std::atomic<bool> running { false };   // Readable from any thread (the overlay asks)
+
+    std::atomic<juce::int64> framesSubmitted { 0 }, framesWritten { 0 };
+    std::atomic<juce::int64> startTicks { 0 };      // Written on the audio thread, read by describe()
+    std::atomic<double> finishedSeconds { 0.0 };
+
+    mutable juce::CriticalSection statusLock;
+    juce::String lastError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameExporter)
+};
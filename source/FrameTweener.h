@@ -0,0 +1,158 @@
+#pragma once
+#include <JuceHeader.h>
+#include <unordered_map>
+#include "SpriteEffects.h"
+
+// --- IN-BETWEEN FRAMES ---
+// Renders a 220x256 frame part-way between two authored frames, so 8-frame loops and slow sync
+// rates move at display rate instead of stepping. Crossfade blends the two frames in place;
+// motion additionally slides both towards each other along the shift of their alpha centroids
+// (a global motion estimate, cheap and good enough for a dancer that moves as one body).
+//
+// The blend is a premultiplied lerp done as SWAR: two pixels per 64-bit word, each channel in its
+// own 16-bit lane, so no per-channel unpacking and no platform intrinsics. It only runs over the
+// union of the two frames' opaque bounds (cached per frame), which is usually well under half the
+// frame.
+class FrameTweener
+{
+public:
+    enum Mode { off = 0, crossfade = 1, motion = 2 };
+
+    static constexpr int frameWidth = SpriteEffectPipeline::frameWidth;
+    static constexpr int frameHeight = SpriteEffectPipeline::frameHeight;
+    static constexpr float maxMotionShift = 48.0f;   // Larger jumps (loop wrap, cuts) just crossfade
+
+    struct FrameInfo
+    {
+        juce::Rectangle<int> bounds;      // Opaque area within the frame (empty = fully transparent)
+        juce::Point<float> centroid;      // Alpha-weighted centre, frame coordinates
+    };
+
+    struct Source
+    {
+        const juce::Image* sheet = nullptr;
+        int sheetIndex = 0, sx = 0, sy = 0;
+    };
+
+    // Blends a (phase 0) and b (phase 1) at phase t into out, a 220x256 ARGB image that only this
+    // tweener writes to. Returns false if the sheets can't be read directly (not ARGB).
+    bool render(int mode, const Source& a, const Source& b, float t, juce::Image& out) {
+        if (a.sheet->getFormat() != juce::Image::ARGB || b.sheet->getFormat() != juce::Image::ARGB
+            || out.getFormat() != juce::Image::ARGB) return false;
+
+        const auto& infoA = getInfo(a);
+        const auto& infoB = getInfo(b);
+
+        // Where each frame sits at this phase
+        juce::Point<int> shiftA, shiftB;
+        if (mode == motion && !infoA.bounds.isEmpty() && !infoB.bounds.isEmpty()) {
+            auto d = infoB.centroid - infoA.centroid;
+            if (std::abs(d.x) <= maxMotionShift && std::abs(d.y) <= maxMotionShift) {
+                shiftA = (d * t).roundToInt();
+                shiftB = (d * (t - 1.0f)).roundToInt();
+            }
+        }
+
+        const auto frameArea = juce::Rectangle<int>(frameWidth, frameHeight);
+        const auto areaA = infoA.bounds.translated(shiftA.x, shiftA.y).getIntersection(frameArea);
+        const auto areaB = infoB.bounds.translated(shiftB.x, shiftB.y).getIntersection(frameArea);
+        const auto area = areaA.isEmpty() ? areaB : (areaB.isEmpty() ? areaA : areaA.getUnion(areaB));
+
+        juce::Image::BitmapData outData(out, juce::Image::BitmapData::readWrite);
+        juce::Image::BitmapData dataA(*a.sheet, a.sx, a.sy, frameWidth, frameHeight, juce::Image::BitmapData::readOnly);
+        juce::Image::BitmapData dataB(*b.sheet, b.sx, b.sy, frameWidth, frameHeight, juce::Image::BitmapData::readOnly);
+
+        // Everything outside the new area is transparent: only wipe what the last call wrote
+        for (int y = written.getY(); y < written.getBottom(); ++y)
+            std::memset(outData.getPixelPointer(written.getX(), y), 0, sizeof(juce::uint32) * (size_t)written.getWidth());
+        written = area;
+        if (area.isEmpty()) return true;
+
+        const int width = area.getWidth();
+        stagingA.resize((size_t)frameWidth);
+        stagingB.resize((size_t)frameWidth);
+        const juce::uint32 weight = (juce::uint32)juce::jlimit(0, 256, juce::roundToInt(t * 256.0f));
+
+        for (int y = area.getY(); y < area.getBottom(); ++y) {
+            stageRow(dataA, areaA, shiftA, area, y, stagingA.data());
+            stageRow(dataB, areaB, shiftB, area, y, stagingB.data());
+            lerpRow(stagingA.data(), stagingB.data(), reinterpret_cast<juce::uint32*>(outData.getPixelPointer(area.getX(), y)), width, weight);
+        }
+
+        return true;
+    }
+
+    // Forget the cached bounds (the sheets changed)
+    void clearCache() { infos.clear(); }
+
+    // out = a + (b - a) * weight / 256 per channel, weight 0..256, premultiplied pixels stay valid
+    static void lerpRow(const juce::uint32* a, const juce::uint32* b, juce::uint32* out, int num, juce::uint32 weight) {
+        constexpr juce::uint64 lanes = 0x00FF00FF00FF00FFull;
+        const juce::uint64 wb = weight, wa = 256u - weight;
+
+        int i = 0;
+        for (; i + 2 <= num; i += 2) {
+            juce::uint64 pa, pb;
+            std::memcpy(&pa, a + i, sizeof(pa));
+            std::memcpy(&pb, b + i, sizeof(pb));
+
+            // Each 16-bit lane holds one channel times a weight: at most 255 * 256, so no carries
+            juce::uint64 even = (((pa & lanes) * wa + (pb & lanes) * wb) >> 8) & lanes;
+            juce::uint64 odd = (((pa >> 8) & lanes) * wa + ((pb >> 8) & lanes) * wb) & ~lanes;
+            juce::uint64 result = even | odd;
+            std::memcpy(out + i, &result, sizeof(result));
+        }
+
+        for (; i < num; ++i) {
+            const juce::uint32 lanes32 = 0x00FF00FFu;
+            juce::uint32 even = (((a[i] & lanes32) * (juce::uint32)wa + (b[i] & lanes32) * weight) >> 8) & lanes32;
+            juce::uint32 odd = (((a[i] >> 8) & lanes32) * (juce::uint32)wa + ((b[i] >> 8) & lanes32) * weight) & ~lanes32;
+            out[i] = even | odd;
+        }
+    }
+
+private:
+    const FrameInfo& getInfo(const Source& source) {
+        auto key = ((juce::int64)source.sheetIndex << 40) | ((juce::int64)source.sy << 20) | (juce::int64)source.sx;
+        auto it = infos.find(key);
+        if (it != infos.end()) return it->second;
+
+        FrameInfo info;
+        juce::Image::BitmapData data(*source.sheet, source.sx, source.sy, frameWidth, frameHeight, juce::Image::BitmapData::readOnly);
+        int minX = frameWidth, minY = frameHeight, maxX = -1, maxY = -1;
+        double totalAlpha = 0.0, sumX = 0.0, sumY = 0.0;
+
+        for (int y = 0; y < frameHeight; ++y) {
+            auto* row = reinterpret_cast<const juce::PixelARGB*>(data.getLinePointer(y));
+            for (int x = 0; x < frameWidth; ++x) {
+                const auto alpha = row[x].getAlpha();
+                if (alpha == 0) continue;
+                minX = juce::jmin(minX, x); maxX = juce::jmax(maxX, x);
+                minY = juce::jmin(minY, y); maxY = juce::jmax(maxY, y);
+                totalAlpha += alpha; sumX += alpha * (double)x; sumY += alpha * (double)y;
+            }
+        }
+
+        if (maxX >= 0) {
+            info.bounds = juce::Rectangle<int>::leftTopRightBottom(minX, minY, maxX + 1, maxY + 1);
+            info.centroid = { (float)(sumX / totalAlpha), (float)(sumY / totalAlpha) };
+        }
+
+        return infos.emplace(key, info).first->second;
+    }
+
+    // Row y of area, as seen through a frame shifted by shift and covering placed: zeros elsewhere
+    static void stageRow(const juce::Image::BitmapData& data, juce::Rectangle<int> placed, juce::Point<int> shift,
+                         juce::Rectangle<int> area, int y, juce::uint32* staging) {
+        std::memset(staging, 0, sizeof(juce::uint32) * (size_t)area.getWidth());
+        if (y < placed.getY() || y >= placed.getBottom()) return;
+
+        auto* row = reinterpret_cast<const juce::uint32*>(data.getLinePointer(y - shift.y));
+        std::memcpy(staging + (placed.getX() - area.getX()), row + (placed.getX() - shift.x),
+                    sizeof(juce::uint32) * (size_t)placed.getWidth());
+    }
+
+    std::unordered_map<juce::int64, FrameInfo> infos;
+    std::vector<juce::uint32> stagingA, stagingB;
+    juce::Rectangle<int> written;   // Area of the output the last render wrote
+};
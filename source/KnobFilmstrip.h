@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+#include "MemoryAccounting.h"
+
+// --- KNOB FILMSTRIPS ---
+// The rotary knobs are redrawn at 30 Hz, and stroking two arcs per knob per paint shows up in
+// message-thread profiles once a few editors are open. Instead every position is rasterised once
+// per knob size and display scale, as a vertical strip of frames, and a paint is one blit. All
+// knobs of the same size share a strip; a new size or a DPI change simply gets its own.
+class KnobFilmstrip
+{
+public:
+    static constexpr int numFrames = 128;   // Under a pixel of travel per step at these sizes
+    static constexpr int maxStrips = 4;     // Sizes x scales kept at once (oldest goes first)
+
+    // Draws the knob at sliderPos (0..1) into (x, y, width, height), rendering its strip the
+    // first time this size, scale and angle range are seen. paintFrame(g, width, height, pos)
+    // draws one position at the origin; frameArea is the part of the bounds it touches.
+    template <typename PaintFn>
+    void draw(juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
+              float startAngle, float endAngle, juce::Rectangle<int> frameArea, const PaintFn& paintFrame) {
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto& strip = getStrip({ width, height, scale, startAngle, endAngle }, frameArea, paintFrame);
+
+        const int frame = juce::roundToInt(juce::jlimit(0.0f, 1.0f, sliderPos) * (float)(numFrames - 1));
+        g.drawImage(strip.image, x + frameArea.getX(), y + frameArea.getY(), frameArea.getWidth(), frameArea.getHeight(),
+                    0, frame * strip.frameHeight, strip.image.getWidth(), strip.frameHeight);
+    }
+
+    void clear() { strips.clear(); }
+
+private:
+    struct Key
+    {
+        int width = 0, height = 0;
+        float scale = 1.0f, startAngle = 0.0f, endAngle = 0.0f;
+
+        bool operator== (const Key& other) const {
+            return width == other.width && height == other.height && scale == other.scale
+                && startAngle == other.startAngle && endAngle == other.endAngle;
+        }
+    };
+
+    struct Strip
+    {
+        Key key;
+        juce::Image image;
+        int frameHeight = 0;   // Physical pixels
+        MemoryAccounting::Allocation bytes;
+    };
+
+    template <typename PaintFn>
+    Strip& getStrip(const Key& key, juce::Rectangle<int> frameArea, const PaintFn& paintFrame) {
+        for (auto& strip : strips)
+            if (strip.key == key) return strip;
+
+        if ((int)strips.size() >= maxStrips) strips.erase(strips.begin());
+
+        Strip strip;
+        strip.key = key;
+        strip.frameHeight = juce::jmax(1, (int)std::ceil((float)frameArea.getHeight() * key.scale));
+        strip.image = juce::Image(juce::Image::ARGB, juce::jmax(1, (int)std::ceil((float)frameArea.getWidth() * key.scale)),
+                                  strip.frameHeight * numFrames, true);
+
+        {
+            juce::Graphics g(strip.image);
+            for (int frame = 0; frame < numFrames; ++frame) {
+                juce::Graphics::ScopedSaveState save(g);
+                g.reduceClipRegion(0, frame * strip.frameHeight, strip.image.getWidth(), strip.frameHeight);
+                g.addTransform(juce::AffineTransform::translation((float)-frameArea.getX(), (float)-frameArea.getY())
+                                   .scaled(key.scale)
+                                   .translated(0.0f, (float)(frame * strip.frameHeight)));
+                paintFrame(g, key.width, key.height, (float)frame / (float)(numFrames - 1));
+            }
+        }
+
+        strip.bytes = MemoryAccounting::Allocation(MemoryAccounting::Tag::ui, MemoryAccounting::getImageBytes(strip.image));
+        strips.push_back(std::move(strip));
+        return strips.back();
+    }
+
+    std::vector<Strip> strips;
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// --- MEMORY ACCOUNTING ---
+// Every image Squab Dance keeps alive is registered here under the subsystem that owns it, so
+// current/peak bytes per tag are visible (API + debug overlay) and a process-wide ceiling can
+// evict caches before the host runs short. The counters are plain atomics; eviction only ever
+// runs on threads that are allowed to free images (message / decode threads, never audio).
+//
+// The ceiling is soft: an allocation that still doesn't fit after every evictor has run is
+// recorded anyway, because refusing a frame buffer would only trade memory trouble for a crash.
+
+namespace MemoryAccounting
+{
+    enum class Tag { sheetCache, frameCache, scratch, reflection, ui, numTags };
+    constexpr int numTags = (int)Tag::numTags;
+
+    inline const char* getTagName(Tag tag) {
+        switch (tag) {
+            case Tag::sheetCache: return "Sheet cache";
+            case Tag::frameCache: return "Frame cache";
+            case Tag::scratch:    return "Scratch";
+            case Tag::reflection: return "Reflection";
+            case Tag::ui:         return "UI";
+            case Tag::numTags:    break;
+        }
+        return "?";
+    }
+
+    // Decoded size of a software image (what it really costs in RAM)
+    inline juce::int64 getImageBytes(const juce::Image& img) {
+        if (!img.isValid()) return 0;
+        int bytesPerPixel = img.getFormat() == juce::Image::RGB ? 3 : (img.getFormat() == juce::Image::SingleChannel ? 1 : 4);
+        return (juce::int64)img.getWidth() * img.getHeight() * bytesPerPixel;
+    }
+
+    class Ledger
+    {
+    public:
+        // An evictor frees up to `bytesNeeded` from its cache and returns what it actually freed
+        using Evictor = std::function<juce::int64(juce::int64 bytesNeeded)>;
+
+        static constexpr juce::int64 defaultCeilingBytes = (juce::int64)512 * 1024 * 1024;
+
+        static Ledger& getInstance() {
+            static Ledger instance;
+            return instance;
+        }
+
+        void add(Tag tag, juce::int64 bytes) {
+            if (bytes <= 0) return;
+            makeRoomFor(bytes);
+
+            auto& c = counters[(size_t)tag];
+            raisePeak(c.peak, c.current.fetch_add(bytes) + bytes);
+            raisePeak(totalPeak, totalCurrent.fetch_add(bytes) + bytes);
+        }
+
+        void remove(Tag tag, juce::int64 bytes) {
+            if (bytes <= 0) return;
+            counters[(size_t)tag].current.fetch_sub(bytes);
+            totalCurrent.fetch_sub(bytes);
+        }
+
+        juce::int64 getCurrentBytes(Tag tag) const { return counters[(size_t)tag].current.load(); }
+        juce::int64 getPeakBytes(Tag tag) const    { return counters[(size_t)tag].peak.load(); }
+        juce::int64 getTotalBytes() const          { return totalCurrent.load(); }
+        juce::int64 getPeakTotalBytes() const      { return totalPeak.load(); }
+        int getNumEvictions() const                { return numEvictions.load(); }
+
+        // 0 disables the ceiling. Lowering it evicts straight away.
+        void setCeilingBytes(juce::int64 bytes) {
+            ceiling.store(juce::jmax((juce::int64)0, bytes));
+            makeRoomFor(0);
+        }
+        juce::int64 getCeilingBytes() const { return ceiling.load(); }
+
+        // True while there is room for optional work such as prewarming caches
+        bool hasHeadroom(double fractionOfCeiling = 0.75) const {
+            auto c = ceiling.load();
+            return c <= 0 || (double)totalCurrent.load() < (double)c * fractionOfCeiling;
+        }
+
+        // Evictors run in registration order, so register the cheapest-to-rebuild caches first
+        int addEvictor(Evictor evictor) {
+            auto entry = std::make_shared<Entry>();
+            entry->evict = std::move(evictor);
+
+            const std::lock_guard<std::mutex> lock(evictorMutex);
+            entry->id = ++lastEvictorId;
+            evictors.push_back(std::move(entry));
+            return lastEvictorId;
+        }
+
+        // Once this returns the evictor is not running anywhere and never will again, so its owner
+        // can be destroyed. (Called from inside the evictor itself it can't wait, and doesn't.)
+        void removeEvictor(int id) {
+            std::unique_lock<std::mutex> lock(evictorMutex);
+            auto it = std::find_if(evictors.begin(), evictors.end(), [id](const std::shared_ptr<Entry>& e) { return e->id == id; });
+            if (it == evictors.end()) return;
+
+            auto entry = *it;
+            evictors.erase(it);
+            entry->removed = true;
+
+            const auto self = std::this_thread::get_id();
+            evictorIdle.wait(lock, [&] { return entry->runningOn == std::thread::id() || entry->runningOn == self; });
+        }
+
+        // One line per tag, for the debug overlay
+        juce::String describe() const {
+            auto mb = [](juce::int64 b) { return juce::String((double)b / (1024.0 * 1024.0), 1) + " MB"; };
+
+            juce::String t;
+            for (int i = 0; i < numTags; ++i)
+                t << juce::String(getTagName((Tag)i)).paddedRight(' ', 14)
+                  << mb(getCurrentBytes((Tag)i)).paddedLeft(' ', 11) << "  (peak " << mb(getPeakBytes((Tag)i)) << ")\n";
+
+            t << "Total".paddedRight(' ', 14) << mb(getTotalBytes()).paddedLeft(' ', 11)
+              << "  (peak " << mb(getPeakTotalBytes()) << ")\n"
+              << "Ceiling " << (getCeilingBytes() > 0 ? mb(getCeilingBytes()) : juce::String("off"))
+              << ", " << getNumEvictions() << " eviction(s)";
+            return t;
+        }
+
+    private:
+        struct Counter
+        {
+            std::atomic<juce::int64> current { 0 };
+            std::atomic<juce::int64> peak { 0 };
+        };
+
+        struct Entry
+        {
+            int id = 0;
+            Evictor evict;
+            bool removed = false;              // Guarded by evictorMutex
+            std::thread::id runningOn;         // Guarded by evictorMutex; default = not running
+        };
+
+        Ledger() {
+            // SQUAB_MEMORY_CEILING_MB overrides the default (0 = unlimited)
+            auto env = juce::SystemStats::getEnvironmentVariable("SQUAB_MEMORY_CEILING_MB", {});
+            ceiling.store(env.isNotEmpty() ? env.getLargeIntValue() * 1024 * 1024 : defaultCeilingBytes);
+        }
+
+        static void raisePeak(std::atomic<juce::int64>& peak, juce::int64 value) {
+            auto prev = peak.load();
+            while (value > prev && !peak.compare_exchange_weak(prev, value)) {}
+        }
+
+        void makeRoomFor(juce::int64 incoming) {
+            auto c = ceiling.load();
+            if (c <= 0) return;
+
+            auto excess = totalCurrent.load() + incoming - c;
+            if (excess <= 0) return;
+
+            // Evicting frees images, which calls back into remove(); never run two passes at once
+            bool expected = false;
+            if (!evicting.compare_exchange_strong(expected, true)) return;
+
+            // Call evictors outside the lock so they can take their own cache locks freely. Each
+            // entry is marked as running meanwhile, which is what removeEvictor waits on.
+            std::vector<std::shared_ptr<Entry>> snapshot;
+            {
+                const std::lock_guard<std::mutex> lock(evictorMutex);
+                snapshot = evictors;
+            }
+
+            for (auto& e : snapshot) {
+                if (excess <= 0) break;
+                {
+                    const std::lock_guard<std::mutex> lock(evictorMutex);
+                    if (e->removed) continue;
+                    e->runningOn = std::this_thread::get_id();
+                }
+
+                auto freed = e->evict(excess);
+
+                {
+                    const std::lock_guard<std::mutex> lock(evictorMutex);
+                    e->runningOn = std::thread::id();
+                }
+                evictorIdle.notify_all();
+
+                if (freed > 0) { excess -= freed; numEvictions.fetch_add(1); }
+            }
+
+            evicting.store(false);
+        }
+
+        std::array<Counter, (size_t)numTags> counters;
+        std::atomic<juce::int64> totalCurrent { 0 }, totalPeak { 0 };
+        std::atomic<juce::int64> ceiling { defaultCeilingBytes };
+        std::atomic<int> numEvictions { 0 };
+        std::atomic<bool> evicting { false };
+
+        std::mutex evictorMutex;
+        std::condition_variable evictorIdle;
+        std::vector<std::shared_ptr<Entry>> evictors;
+        int lastEvictorId = 0;
+    };
+
+    // RAII ledger entry: holds `bytes` against `tag` for as long as it lives. Keep one next to
+    // each image (or group of images) you own and reset() it when they are reallocated.
+    class Allocation
+    {
+    public:
+        Allocation() = default;
+        Allocation(Tag t, juce::int64 numBytes) : tag(t), bytes(numBytes) { Ledger::getInstance().add(tag, bytes); }
+        ~Allocation() { Ledger::getInstance().remove(tag, bytes); }
+
+        Allocation(Allocation&& other) noexcept : tag(other.tag), bytes(std::exchange(other.bytes, 0)) {}
+        Allocation& operator=(Allocation&& other) noexcept {
+            if (this != &other) {
+                Ledger::getInstance().remove(tag, bytes);
+                tag = other.tag;
+                bytes = std::exchange(other.bytes, 0);
+            }
+            return *this;
+        }
+
+        void reset(juce::int64 newBytes) {
+            Ledger::getInstance().remove(tag, bytes);
+            bytes = newBytes;
+            Ledger::getInstance().add(tag, bytes);
+        }
+
+        juce::int64 getBytes() const { return bytes; }
+
+    private:
+        Tag tag = Tag::scratch;
+        juce::int64 bytes = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(Allocation)
+    };
+}
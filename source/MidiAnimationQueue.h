@@ -0,0 +1,31 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+// --- MIDI -> ANIMATION EVENTS ---
+// Produced on the audio thread straight from the raw MIDI bytes (no MidiMessage objects, no
+// allocation) and consumed by the sprite render clock. Each event carries the moment it becomes
+// audible, so the renderer can apply it on the exact display frame a drum hit is heard.
+struct AnimationEvent
+{
+    enum class Type : juce::uint8 { noteOn, controller };
+
+    Type type = Type::noteOn;
+    juce::uint8 number = 0;        // Note number or CC number
+    float value = 0.0f;            // Velocity or CC value, 0.0 to 1.0
+    juce::int64 dueTicks = 0;      // juce::Time::getHighResolutionTicks() when the event is heard
+};
+
+// 4096 events is a 1/64 drum roll on every note for several seconds without a drain
+using AnimationEventQueue = SpscRing<AnimationEvent, 4096>;
+
+// --- MAPPING ---
+namespace MidiAnimationMap
+{
+    // Notes from C3 upwards pick an animation (C3 = first move, C#3 = second ...).
+    // Every other note (e.g. a GM kick on 36) just retriggers the current move.
+    constexpr int firstSelectNote = 60;
+
+    constexpr int scaleController = 1;   // Mod wheel -> scale boost
+    constexpr int hueController = 74;    // Brightness -> hue shift
+}
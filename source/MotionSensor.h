@@ -0,0 +1,52 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpriteFrameRenderer.h"
+
+// --- PIXEL-DELTA MOTION SENSOR ---
+// Turns the frames the dancer shows into the visual model that drives the DSP: motion (share of
+// pixels whose brightness changed since the previous frame, with a fast decay), hue (mean hue of
+// the visible pixels) and pan (horizontal centre of mass). The scan itself is the "analyse" stage
+// of SpriteEffectPipeline, so SpriteContent gets it fused into the same pass as its other effects;
+// VisualTimeline runs it on its own over whole animations, so both read the same values.
+class MotionSensor
+{
+public:
+    // Fused use: pass the returned analysis to SpriteEffectPipeline::run, then finishScan() it
+    SpriteEffectPipeline::Analysis beginScan(int scanStep) {
+        SpriteEffectPipeline::Analysis analysis;
+        analysis.previousFrame = &lastFrame;
+        analysis.scanStep = scanStep;
+        return analysis;
+    }
+
+    void finishScan(const SpriteEffectPipeline::Analysis& analysis) {
+        const auto& scan = analysis.scan;
+        if (scan.pixelCount > 0) {
+            pan = (scan.totalX / scan.pixelCount) / (float)SpriteFrameRenderer::frameWidth;
+            hue = scan.totalHue / scan.pixelCount;
+            float frameMotion = (scan.deltaCount / scan.pixelCount) * 15.0f;
+            motion = juce::jmax(motion, juce::jmin(1.0f, frameMotion));
+        }
+
+        motion *= 0.70f; // Fast decay
+    }
+
+    // Standalone use: scans one 220x256 frame of sheet at (sx, sy), sampling every scanStep-th pixel
+    void scanFrame(const juce::Image& sheet, int sx, int sy, int scanStep) {
+        auto analysis = beginScan(scanStep);
+        SpriteEffectPipeline::run(SpriteEffectPipeline::analyse, sheet, sx, sy, {}, {}, nullptr, nullptr, &analysis);
+        finishScan(analysis);
+    }
+
+    float getMotion() const { return motion; }
+    float getHue() const { return hue; }
+    float getPan() const { return pan; }
+
+    const juce::Image& getLastFrame() const { return lastFrame; }
+
+private:
+    juce::Image lastFrame { SpriteFrameRenderer::createScratchImage() };
+    float motion = 0.0f;
+    float hue = 0.0f;
+    float pan = 0.5f;
+};
@@ -0,0 +1,337 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+// --- STREAMING ONSET DETECTOR + TEMPO TRACKER ---
+// For when the host has no transport to follow (Standalone, hosts without a playhead).
+//
+// Audio thread, O(1) per sample: the input is split into three bands with two one-pole filters,
+// each band gets a peak envelope, and every ~1.3 ms hop the weighted rise of the log envelopes
+// over the last ~10 ms (envelope flux) is compared against an adaptive threshold (running mean +
+// deviation). Onsets are reported at the sample where they were detected, a few ms after the hit.
+//
+// Worker: the per-hop flux goes through a wait-free ring to a low-priority thread that keeps the
+// last 8 s, autocorrelates it every half second and publishes the tempo (60 - 180 BPM, weighted
+// towards 120 to avoid octave errors). Offline the caller runs the estimate inline instead, via
+// analyseTempo(), so renders stay deterministic.
+class OnsetDetector
+{
+public:
+    struct Onset
+    {
+        int offset = 0;          // Sample within the block
+        float strength = 0.0f;   // Flux above the threshold
+    };
+
+    static constexpr int maxOnsetsPerBlock = 32;
+    static constexpr int numBands = 3;
+    static constexpr double minBpm = 60.0, maxBpm = 180.0;
+
+    OnsetDetector() = default;
+    ~OnsetDetector() { worker.stopThread(1000); }
+
+    // Message thread, with audio stopped (prepareToPlay). Resets detection and tempo state.
+    void prepare(double newSampleRate, bool realtime) {
+        worker.stopThread(1000);
+
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+        hopSize = juce::jmax(16, (int)std::round(sampleRate / targetHopRate));
+        tempoFrameRate = sampleRate / hopSize / tempoDecimation;
+
+        auto lowPass = [this](double hz) { return (float)(1.0 - std::exp(-juce::MathConstants<double>::twoPi * hz / sampleRate)); };
+        lowCoeff = lowPass(200.0);
+        midCoeff = lowPass(2000.0);
+        attackCoeff = (float)(1.0 - std::exp(-1000.0 / (0.5 * sampleRate)));   // 0.5 ms
+        releaseCoeff = (float)std::exp(-1000.0 / (40.0 * sampleRate));         // 40 ms
+        statsCoeff = (float)(1.0 - std::exp(-(double)hopSize / (0.5 * sampleRate)));
+        refractorySamples = (int)(0.1 * sampleRate);
+
+        lowState = midState = 0.0f;
+        envelopes.fill(0.0f);
+        for (auto& band : logHistory) band.fill(std::log(silenceFloor));
+        historyPosition = hopCounter = 0;
+        fluxMean = fluxDeviation = 0.0f;
+        samplesSinceOnset = refractorySamples;
+
+        odfRing.drain([](float) {});
+        tempoHistory.assign((size_t)(tempoHistorySeconds * tempoFrameRate), 0.0f);
+        tempoWritePosition = tempoFramesStored = decimationCounter = framesSinceEstimate = 0;
+        decimationSum = 0.0f;
+        candidateBpm = 0.0;
+        tempoBpm.store(0.0f);
+        tempoConfidence.store(0.0f);
+
+        setRealtime(realtime);
+    }
+
+    void release() { worker.stopThread(1000); }
+
+    void setRealtime(bool realtime) {
+        if (realtime) worker.startThread(juce::Thread::Priority::low);
+        else worker.stopThread(1000);
+    }
+
+    // --- Audio thread ---
+    // Runs detection over the block's input channels and returns the number of onsets found
+    int process(const juce::AudioBuffer<float>& buffer, int numInputChannels) {
+        numOnsets = 0;
+        numInputChannels = juce::jmin(numInputChannels, buffer.getNumChannels());
+        if (numInputChannels <= 0) return 0;
+
+        const float channelGain = 1.0f / (float)numInputChannels;
+        const auto* const* channels = buffer.getArrayOfReadPointers();
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            float x = 0.0f;
+            for (int ch = 0; ch < numInputChannels; ++ch) x += channels[ch][i];
+            x *= channelGain;
+
+            // Band split: < 200 Hz, 200 Hz - 2 kHz, > 2 kHz
+            lowState += lowCoeff * (x - lowState);
+            midState += midCoeff * (x - midState);
+            const float bands[numBands] = { lowState, midState - lowState, x - midState };
+
+            for (int b = 0; b < numBands; ++b) {
+                float magnitude = std::abs(bands[b]);
+                float& env = envelopes[(size_t)b];
+                env = magnitude > env ? env + attackCoeff * (magnitude - env) : env * releaseCoeff;
+            }
+
+            if (++hopCounter >= hopSize) {
+                hopCounter = 0;
+                detectHop(i);
+            }
+        }
+
+        samplesSinceOnset = juce::jmin(samplesSinceOnset + buffer.getNumSamples(), 1 << 30);
+        return numOnsets;
+    }
+
+    const Onset& getOnset(int index) const { return onsets[(size_t)index]; }
+    int getSamplesSinceOnset() const { return samplesSinceOnset; }
+
+    // Estimated tempo, or 0 before there is one. Any thread.
+    float getTempo() const { return tempoBpm.load(std::memory_order_relaxed); }
+    float getConfidence() const { return tempoConfidence.load(std::memory_order_relaxed); }
+
+    // Offline only: runs the tempo estimate on the calling thread (the worker is stopped)
+    void analyseTempo() { consumeFlux(); }
+
+private:
+    static constexpr double targetHopRate = 750.0;   // Detection hops per second (64 samples at 48 kHz)
+    static constexpr int fluxLagHops = 8;            // Envelope rise measured over ~10 ms
+    static constexpr int tempoDecimation = 8;        // Tempo analysis at ~94 frames per second
+    static constexpr double tempoHistorySeconds = 8.0;
+    static constexpr double tempoUpdateSeconds = 0.5;
+    static constexpr float silenceFloor = 0.003f;    // About -50 dBFS
+    static constexpr float thresholdDeviations = 2.0f;
+    static constexpr float minimumFlux = 0.3f;       // Natural-log units: the envelope rose by ~35%
+
+    // --- AUDIO THREAD ---
+    void detectHop(int offset) {
+        static constexpr float bandWeights[numBands] = { 1.0f, 0.7f, 0.5f };
+
+        float flux = 0.0f, loudness = 0.0f;
+        for (int b = 0; b < numBands; ++b) {
+            float logEnv = std::log(envelopes[(size_t)b] + 1.0e-5f);
+            auto& history = logHistory[(size_t)b];
+            flux += bandWeights[b] * juce::jmax(0.0f, logEnv - history[(size_t)historyPosition]);
+            history[(size_t)historyPosition] = logEnv;
+            loudness += envelopes[(size_t)b];
+        }
+        historyPosition = (historyPosition + 1) % fluxLagHops;
+
+        const float threshold = fluxMean + thresholdDeviations * fluxDeviation + minimumFlux;
+        const int sinceOnset = samplesSinceOnset + offset;
+        if (flux > threshold && loudness > silenceFloor && sinceOnset >= refractorySamples && numOnsets < maxOnsetsPerBlock) {
+            onsets[(size_t)numOnsets++] = { offset, flux - threshold };
+            samplesSinceOnset = -offset;   // process() adds the block length at the end
+        }
+
+        fluxMean += statsCoeff * (flux - fluxMean);
+        fluxDeviation += statsCoeff * (std::abs(flux - fluxMean) - fluxDeviation);
+
+        odfRing.push(loudness > silenceFloor ? flux : 0.0f);
+    }
+
+    // --- WORKER (or the offline caller) ---
+    class Worker : public juce::Thread
+    {
+    public:
+        explicit Worker(OnsetDetector& o) : juce::Thread("Squab Tempo"), owner(o) {}
+
+        void run() override {
+            while (!threadShouldExit()) {
+                owner.consumeFlux();
+                wait(50);
+            }
+        }
+
+    private:
+        OnsetDetector& owner;
+    };
+
+    void consumeFlux() {
+        odfRing.drain([this](float flux) {
+            decimationSum += flux;
+            if (++decimationCounter < tempoDecimation) return;
+
+            tempoHistory[(size_t)tempoWritePosition] = decimationSum;
+            tempoWritePosition = (tempoWritePosition + 1) % (int)tempoHistory.size();
+            tempoFramesStored = juce::jmin(tempoFramesStored + 1, (int)tempoHistory.size());
+            decimationCounter = 0;
+            decimationSum = 0.0f;
+            ++framesSinceEstimate;
+        });
+
+        if (framesSinceEstimate >= (int)(tempoUpdateSeconds * tempoFrameRate) && tempoFramesStored >= (int)(3.0 * tempoFrameRate)) {
+            framesSinceEstimate = 0;
+            estimateTempo();
+        }
+    }
+
+    void estimateTempo() {
+        const int n = tempoFramesStored;
+        const int size = (int)tempoHistory.size();
+        ordered.resize((size_t)n);
+
+        float mean = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            ordered[(size_t)i] = tempoHistory[(size_t)((tempoWritePosition - n + i + size) % size)];
+            mean += ordered[(size_t)i];
+        }
+        mean /= (float)n;
+        for (auto& v : ordered) v -= mean;
+
+        const int minLag = juce::jmax(2, (int)std::floor(60.0 * tempoFrameRate / maxBpm));
+        const int maxLag = (int)std::ceil(60.0 * tempoFrameRate / minBpm);
+        if (2 * maxLag + 1 >= n) return;
+
+        auto autocorrelation = [this, n](int lag) {
+            float sum = 0.0f;
+            for (int i = lag; i < n; ++i) sum += ordered[(size_t)i] * ordered[(size_t)(i - lag)];
+            return sum / (float)(n - lag);
+        };
+
+        const float energy = autocorrelation(0);
+        if (energy <= 1.0e-9f) { tempoConfidence.store(0.0f); return; }
+
+        // Lag score: the beat period plus half of its double (bar-level regularity), times a
+        // log-normal prior around 120 BPM so a half- or double-time reading has to be clearly stronger
+        scores.assign((size_t)maxLag + 2, 0.0f);
+        int bestLag = minLag;
+        for (int lag = minLag; lag <= maxLag + 1; ++lag) {
+            double bpm = 60.0 * tempoFrameRate / lag;
+            double octaves = std::log2(bpm / 120.0);
+            float prior = (float)std::exp(-0.5 * octaves * octaves);
+            scores[(size_t)lag] = (autocorrelation(lag) + 0.5f * autocorrelation(2 * lag)) * prior;
+            if (lag <= maxLag && scores[(size_t)lag] > scores[(size_t)bestLag]) bestLag = lag;
+        }
+
+        // Parabolic interpolation between lags for sub-frame period resolution
+        double lag = bestLag;
+        if (bestLag > minLag) {
+            float a = scores[(size_t)bestLag - 1], b = scores[(size_t)bestLag], c = scores[(size_t)bestLag + 1];
+            float denominator = a - 2.0f * b + c;
+            if (std::abs(denominator) > 1.0e-12f) lag += juce::jlimit(-0.5, 0.5, 0.5 * (double)(a - c) / (double)denominator);
+        }
+
+        const double estimate = 60.0 * tempoFrameRate / lag;
+        const float confidence = juce::jlimit(0.0f, 1.0f, autocorrelation(bestLag) / energy);
+
+        // Small drifts are followed smoothly; a jump needs two estimates in a row that agree
+        const double current = tempoBpm.load(std::memory_order_relaxed);
+        auto close = [](double a, double b) { return b > 0.0 && std::abs(a / b - 1.0) < 0.04; };
+        if (close(estimate, current))            tempoBpm.store((float)(current + 0.25 * (estimate - current)));
+        else if (close(estimate, candidateBpm))  tempoBpm.store((float)estimate);
+        candidateBpm = estimate;
+        tempoConfidence.store(confidence);
+    }
+
+    double sampleRate = 44100.0;
+    int hopSize = 64;
+    double tempoFrameRate = 94.0;
+
+    // --- AUDIO THREAD STATE ---
+    float lowCoeff = 0.03f, midCoeff = 0.25f, attackCoeff = 0.04f, releaseCoeff = 0.9995f, statsCoeff = 0.003f;
+    float lowState = 0.0f, midState = 0.0f;
+    std::array<float, numBands> envelopes {};
+    std::array<std::array<float, fluxLagHops>, numBands> logHistory {};
+    int historyPosition = 0, hopCounter = 0;
+    float fluxMean = 0.0f, fluxDeviation = 0.0f;
+    int refractorySamples = 4410, samplesSinceOnset = 0;
+    std::array<Onset, maxOnsetsPerBlock> onsets {};
+    int numOnsets = 0;
+
+    // --- AUDIO THREAD -> WORKER ---
+    SpscRing<float, 8192> odfRing;   // ~11 s of hops
+    std::atomic<float> tempoBpm { 0.0f }, tempoConfidence { 0.0f };
+
+    // --- WORKER STATE ---
+    std::vector<float> tempoHistory, ordered, scores;
+    int tempoWritePosition = 0, tempoFramesStored = 0, decimationCounter = 0, framesSinceEstimate = 0;
+    float decimationSum = 0.0f;
+    double candidateBpm = 0.0;
+
+    Worker worker { *this };
+};
+
+// --- VIRTUAL BEAT CLOCK ---
+// A transport built from the detector: it runs at the estimated tempo, and every onset that lands
+// within a quarter beat of the grid pulls the grid onto it. The frame advance for a beat therefore
+// happens either on time (predicted) or at the latest when the onset is detected, a few ms late.
+// It only reports "playing" while the tempo is confident and onsets keep coming.
+class OnsetBeatClock
+{
+public:
+    void prepare(double newSampleRate) {
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+        ppq = blockPpq = pendingCorrection = 0.0;
+        bpm = 120.0;
+        playing = false;
+    }
+
+    // Audio thread, once per block after OnsetDetector::process(). A beat that lands off the grid
+    // does not jump the clock: the error is queued and worked off over the next few blocks, at
+    // most half a block's worth of beats either way, so ppq never runs backwards (sync mode
+    // would step the frame back) and never leaps a whole frame forwards.
+    void advance(const OnsetDetector& detector, int numOnsets, int numSamples) {
+        const float tempo = detector.getTempo();
+        const bool confident = tempo > 0.0f && detector.getConfidence() >= minConfidence;
+        if (confident) bpm = tempo;
+
+        const double beatsPerSample = bpm / 60.0 / sampleRate;
+        for (int i = 0; i < numOnsets; ++i) {
+            // Measured against where the clock will be once the queued correction is in
+            double onsetPpq = ppq + pendingCorrection + detector.getOnset(i).offset * beatsPerSample;
+            double error = onsetPpq - std::round(onsetPpq);
+            if (std::abs(error) < captureWindowBeats) pendingCorrection -= error;
+        }
+
+        const double blockBeats = numSamples * beatsPerSample;
+        const double slewFraction = juce::jmin(1.0, numSamples / (correctionSeconds * sampleRate));
+        const double maxStep = maxCorrectionRate * blockBeats;
+        const double step = juce::jlimit(-maxStep, maxStep, pendingCorrection * slewFraction);
+        pendingCorrection -= step;
+
+        playing = confident && detector.getSamplesSinceOnset() < (int)(silenceTimeoutSeconds * sampleRate);
+        blockPpq = ppq;
+        ppq += blockBeats + step;
+    }
+
+    double getBlockPpq() const { return blockPpq; }
+    double getBpm() const { return bpm; }
+    bool isPlaying() const { return playing; }
+
+private:
+    static constexpr float minConfidence = 0.1f;
+    static constexpr double captureWindowBeats = 0.25;
+    static constexpr double silenceTimeoutSeconds = 4.0;
+    static constexpr double correctionSeconds = 0.05;   // Time to work off a phase error
+    static constexpr double maxCorrectionRate = 0.5;    // Clock runs at 0.5x..1.5x while correcting
+
+    double sampleRate = 44100.0;
+    double ppq = 0.0, blockPpq = 0.0, bpm = 120.0;
+    double pendingCorrection = 0.0;   // Beats still to add (or take off) ppq
+    bool playing = false;
+};
@@ -0,0 +1,253 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+// --- OUTPUT METERING ENGINE ---
+// Runs once per block AFTER the DSP loop, one channel at a time over contiguous memory:
+//   * Sample peak + RMS       (juce::FloatVectorOperations / AudioBuffer helpers)
+//   * True peak               (4x oversampled polyphase FIR, ITU-R BS.1770 style)
+//   * Momentary / Short-term  (K-weighted LUFS over 400 ms / 3 s sliding windows, BS.1770
+//                               channel weights: surrounds x1.41, LFE left out)
+// Results are written into the block's TelemetryFrame, which is already our lock-free
+// channel to the UI, so the meter never touches an atomic of its own.
+class OutputMeter
+{
+public:
+    void prepare(double newSampleRate, const juce::AudioChannelSet& layout, int maxBlockSize) {
+        sampleRate = newSampleRate;
+        channels = juce::jlimit(1, TelemetryFrame::maxChannels, layout.size());
+
+        // BS.1770 channel weights, from the bus layout (a plain mono or stereo bus is all 1.0)
+        for (int channel = 0; channel < channels; ++channel)
+            loudnessWeights[(size_t)channel] = getLoudnessWeight(layout.getTypeOfChannel(channel));
+
+        designTruePeakFilter();
+        designKWeighting();
+
+        // All memory is claimed here so process() never allocates
+        scratch.assign((size_t)(maxBlockSize + tapsPerPhase), 0.0f);
+        phaseScratch.assign((size_t)maxBlockSize, 0.0f);
+        kScratch.assign((size_t)maxBlockSize, 0.0f);
+        samplesPerGateBlock = juce::jmax(1, juce::roundToInt(sampleRate * 0.1)); // 100 ms
+        reset();
+    }
+
+    void reset() {
+        for (auto& h : history) h.fill(0.0f);
+        for (auto& s : shelfState) s = {};
+        for (auto& s : highpassState) s = {};
+        gateBlocks.fill(0.0);
+        gateWriteIndex = 0;
+        gateBlocksFilled = 0;
+        pendingEnergy = 0.0;
+        pendingSamples = 0;
+    }
+
+    void process(const juce::AudioBuffer<float>& buffer, TelemetryFrame& frame) {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), channels);
+        frame.numChannels = numChannels;
+
+        if (numSamples <= 0 || kScratch.empty()) return;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const float* data = buffer.getReadPointer(channel);
+
+            frame.peak[(size_t)channel] = buffer.getMagnitude(channel, 0, numSamples);
+            frame.rms[(size_t)channel] = buffer.getRMSLevel(channel, 0, numSamples);
+
+            // Hosts may exceed the prepared block size, so the scratch passes work in chunks
+            float truePeak = frame.peak[(size_t)channel];
+            for (int start = 0; start < numSamples; start += (int)kScratch.size()) {
+                int num = juce::jmin((int)kScratch.size(), numSamples - start);
+                truePeak = juce::jmax(truePeak, computeTruePeak(channel, data + start, num));
+            }
+            frame.truePeak[(size_t)channel] = truePeak;
+        }
+
+        // Loudness runs in segments that end exactly on the 100 ms gating boundaries, so the
+        // windows hold the same samples whatever block size the host happens to use
+        for (int start = 0; start < numSamples;) {
+            int num = juce::jmin(numSamples - start, samplesPerGateBlock - pendingSamples, (int)kScratch.size());
+
+            double energy = 0.0;
+            for (int channel = 0; channel < numChannels; ++channel)
+                if (loudnessWeights[(size_t)channel] > 0.0f)
+                    energy += loudnessWeights[(size_t)channel] * kWeightedEnergy(channel, buffer.getReadPointer(channel) + start, num);
+
+            accumulateLoudness(energy, num);
+            start += num;
+        }
+
+        frame.momentaryLufs = windowLoudness(4);    // 4 x 100 ms
+        frame.shortTermLufs = windowLoudness(30);   // 30 x 100 ms
+    }
+
+private:
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    struct Biquad { float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f; };
+    struct BiquadState { float z1 = 0.0f, z2 = 0.0f; };
+
+    // --- TRUE PEAK ---
+    void designTruePeakFilter() {
+        // Windowed-sinc lowpass at the original Nyquist, split into 4 polyphase branches
+        constexpr int totalTaps = oversampling * tapsPerPhase;
+        const double centre = (totalTaps - 1) * 0.5;
+
+        for (int n = 0; n < totalTaps; ++n) {
+            double t = ((double)n - centre) / (double)oversampling;
+            double sinc = (std::abs(t) < 1e-9) ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+            double window = 0.42 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / (totalTaps - 1))
+                                 + 0.08 * std::cos(2.0 * juce::MathConstants<double>::twoPi * n / (totalTaps - 1));
+            phases[(size_t)(n % oversampling)][(size_t)(n / oversampling)] = (float)(sinc * window);
+        }
+
+        // Unity DC gain per branch so a flat signal reads the same as its sample peak
+        for (auto& phase : phases) {
+            float sum = 0.0f;
+            for (auto tap : phase) sum += tap;
+            if (sum != 0.0f) for (auto& tap : phase) tap /= sum;
+        }
+    }
+
+    float computeTruePeak(int channel, const float* data, int numSamples) {
+        // Lay out [last taps of previous block | this block] contiguously, so tap k of every output
+        // sample reads one shifted run of the line
+        auto& hist = history[(size_t)channel];
+        float* line = scratch.data();
+        std::copy(hist.begin(), hist.end(), line);
+        juce::FloatVectorOperations::copy(line + tapsPerPhase, data, numSamples);
+
+        // One branch at a time over the whole chunk: each tap is a single vector multiply-add
+        // into the branch's output, then one vector min/max scan finds its peak
+        float* out = phaseScratch.data();
+        float maxValue = 0.0f;
+        for (const auto& phase : phases) {
+            juce::FloatVectorOperations::clear(out, numSamples);
+            for (int k = 0; k < tapsPerPhase; ++k)
+                juce::FloatVectorOperations::addWithMultiply(out, line + tapsPerPhase - k, phase[(size_t)k], numSamples);
+
+            auto range = juce::FloatVectorOperations::findMinAndMax(out, numSamples);
+            maxValue = juce::jmax(maxValue, -range.getStart(), range.getEnd());
+        }
+
+        std::copy(line + numSamples, line + numSamples + tapsPerPhase, hist.begin());
+        return maxValue;
+    }
+
+    // --- CHANNEL WEIGHTS ---
+    static float getLoudnessWeight(juce::AudioChannelSet::ChannelType type) {
+        using CS = juce::AudioChannelSet;
+        switch (type) {
+            case CS::LFE: case CS::LFE2:
+                return 0.0f;
+            case CS::leftSurround: case CS::rightSurround:
+            case CS::leftSurroundSide: case CS::rightSurroundSide:
+            case CS::leftSurroundRear: case CS::rightSurroundRear:
+                return 1.41f;
+            default:
+                return 1.0f;
+        }
+    }
+
+    // --- K-WEIGHTING (BS.1770 pre-filter + RLB highpass, re-derived for any sample rate) ---
+    void designKWeighting() {
+        const double pi = juce::MathConstants<double>::pi;
+
+        {
+            const double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+            const double k = std::tan(pi * f0 / sampleRate);
+            const double vh = std::pow(10.0, gainDb / 20.0);
+            const double vb = std::pow(vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+            shelf.b0 = (float)((vh + vb * k / q + k * k) / a0);
+            shelf.b1 = (float)(2.0 * (k * k - vh) / a0);
+            shelf.b2 = (float)((vh - vb * k / q + k * k) / a0);
+            shelf.a1 = (float)(2.0 * (k * k - 1.0) / a0);
+            shelf.a2 = (float)((1.0 - k / q + k * k) / a0);
+        }
+        {
+            const double f0 = 38.13547087602444, q = 0.5003270373238773;
+            const double k = std::tan(pi * f0 / sampleRate);
+            const double a0 = 1.0 + k / q + k * k;
+            highpass.b0 = 1.0f; highpass.b1 = -2.0f; highpass.b2 = 1.0f;
+            highpass.a1 = (float)(2.0 * (k * k - 1.0) / a0);
+            highpass.a2 = (float)((1.0 - k / q + k * k) / a0);
+        }
+    }
+
+    static void runBiquad(const Biquad& c, BiquadState& s, const float* in, float* out, int numSamples) {
+        float z1 = s.z1, z2 = s.z2;
+        for (int i = 0; i < numSamples; ++i) {
+            float x = in[i];
+            float y = c.b0 * x + z1;
+            z1 = c.b1 * x - c.a1 * y + z2;
+            z2 = c.b2 * x - c.a2 * y;
+            out[i] = y;
+        }
+        s.z1 = z1; s.z2 = z2;
+    }
+
+    double kWeightedEnergy(int channel, const float* data, int numSamples) {
+        float* k = kScratch.data();
+        runBiquad(shelf, shelfState[(size_t)channel], data, k, numSamples);
+        runBiquad(highpass, highpassState[(size_t)channel], k, k, numSamples);
+
+        juce::FloatVectorOperations::multiply(k, k, numSamples);
+        double sum = 0.0;
+        for (int i = 0; i < numSamples; ++i) sum += k[i];
+        return sum;
+    }
+
+    // --- LOUDNESS WINDOWS ---
+    // Callers never pass more than the rest of the current gating block
+    void accumulateLoudness(double energy, int numSamples) {
+        pendingEnergy += energy;
+        pendingSamples += numSamples;
+
+        if (pendingSamples >= samplesPerGateBlock) {
+            gateBlocks[(size_t)gateWriteIndex] = pendingEnergy / (double)pendingSamples;
+            gateWriteIndex = (gateWriteIndex + 1) % (int)gateBlocks.size();
+            gateBlocksFilled = juce::jmin(gateBlocksFilled + 1, (int)gateBlocks.size());
+            pendingEnergy = 0.0;
+            pendingSamples = 0;
+        }
+    }
+
+    float windowLoudness(int numBlocks) const {
+        int count = juce::jmin(numBlocks, gateBlocksFilled);
+        if (count == 0) return silenceLufs;
+
+        double sum = 0.0;
+        for (int i = 1; i <= count; ++i)
+            sum += gateBlocks[(size_t)((gateWriteIndex - i + (int)gateBlocks.size()) % (int)gateBlocks.size())];
+
+        double meanSquare = sum / count;
+        if (meanSquare <= 1e-10) return silenceLufs;
+        return juce::jmax(silenceLufs, (float)(-0.691 + 10.0 * std::log10(meanSquare)));
+    }
+
+    static constexpr float silenceLufs = -100.0f;
+
+    double sampleRate = 44100.0;
+    int channels = 2;
+
+    std::array<std::array<float, tapsPerPhase>, oversampling> phases {};
+    std::array<std::array<float, tapsPerPhase>, TelemetryFrame::maxChannels> history {};
+    std::vector<float> scratch, phaseScratch;
+    std::array<float, TelemetryFrame::maxChannels> loudnessWeights {};
+
+    Biquad shelf, highpass;
+    std::array<BiquadState, TelemetryFrame::maxChannels> shelfState {};
+    std::array<BiquadState, TelemetryFrame::maxChannels> highpassState {};
+    std::vector<float> kScratch;
+
+    std::array<double, 30> gateBlocks {};
+    int gateWriteIndex = 0;
+    int gateBlocksFilled = 0;
+    int samplesPerGateBlock = 4410;
+    double pendingEnergy = 0.0;
+    int pendingSamples = 0;
+};
@@ -2,13 +2,16 @@
 #include "PluginEditor.h"
 #include <unordered_map>
 
-const int DEFAULT_CHARACTER_INDEX = 11; 
+#if JucePlugin_Build_Standalone
+ #include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#endif
 
 SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
     setSize (880, 540);
     characterDB = SpriteDatabase::getDatabase();
+    for (const auto& charDef : characterDB) heldRows.push_back(SpriteDatabase::findHeldAnimation(charDef));
     preCacheImages();
 
     // 1. TITLE & BRANDING
@@ -22,6 +25,10 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
     squabDadLabel.setFont(juce::Font(12.0f, juce::Font::plain));
     squabDadLabel.setColour(juce::Label::textColourId, juce::Colours::black);
 
+    addAndMakeVisible(qualityLabel);
+    qualityLabel.setFont(juce::Font(12.0f, juce::Font::plain));
+    qualityLabel.setColour(juce::Label::textColourId, juce::Colours::black);
+
     // 2. LOAD BIRD LOGO
     addAndMakeVisible(birdLogo);
     birdLogo.setImagePlacement(juce::RectanglePlacement::centred | juce::RectanglePlacement::onlyReduceInSize);
@@ -33,7 +40,9 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
         if (cleanRes.contains("squablogo")) {
             int size = 0;
             const char* data = BinaryData::getNamedResource(res.toUTF8(), size);
-            birdLogo.setImage(juce::ImageCache::getFromMemory(data, size));
+            auto logo = juce::ImageFileFormat::loadFrom(data, (size_t)size);
+            logoBytes = MemoryAccounting::Allocation(MemoryAccounting::Tag::ui, MemoryAccounting::getImageBytes(logo));
+            birdLogo.setImage(logo);
             break;
         }
     }
@@ -57,9 +66,18 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
             
             animationBox.setSelectedId(1);
             loadCharacterImage(catIndex);
+            audioProcessor.selectedCategory.store(catIndex, std::memory_order_relaxed);
+            audioProcessor.prepareOfflineVisuals();
+            selectionDirty = true;
         }
     };
 
+    animationBox.onChange = [this] {
+        audioProcessor.selectedAnimation.store(juce::jmax(0, animationBox.getSelectedId() - 1), std::memory_order_relaxed);
+        audioProcessor.prepareOfflineVisuals();
+        selectionDirty = true;
+    };
+
     addAndMakeVisible(animationBox);
     animLabel.setText("Dance Move", juce::dontSendNotification);
     animLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
@@ -89,6 +107,16 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
         }
     };
 
+    addAndMakeVisible(browseButton);
+    browseButton.setButtonText("Browse");
+    browseButton.setLookAndFeel(&customLookAndFeel);
+    browseButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xFF2A2A2A));
+    browseButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+    browseButton.onClick = [this] {
+        thumbnailBrowser->setSelected(categoryBox.getSelectedId() - 1, animationBox.getSelectedId() - 1);
+        thumbnailBrowser->toggle();
+    };
+
     // 4. RATE KNOB
     addAndMakeVisible(speedLabel); 
     speedLabel.setText("Rate", juce::dontSendNotification);
@@ -138,6 +166,16 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
     mirrorButton.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
     mirrorAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "mirror", mirrorButton);
 
+    // CROWD SIZE
+    addAndMakeVisible(crowdSlider);
+    crowdSlider.setSliderStyle(juce::Slider::LinearBar);
+    crowdSlider.setTextValueSuffix(" dancers");
+    crowdSlider.setColour(juce::Slider::trackColourId, juce::Colour(0xFFFBB03B).withAlpha(0.6f));
+    crowdSlider.setColour(juce::Slider::backgroundColourId, juce::Colour(0xFF1E1E1E));
+    crowdSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::white);
+    crowdSlider.setDoubleClickReturnValue(true, 1.0, juce::ModifierKeys::noModifiers);
+    crowdAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "crowd", crowdSlider);
+
     // HZ BUTTON 
     addAndMakeVisible(hzButton); 
     hzButton.setButtonText("Hz");
@@ -180,7 +218,8 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
         bool isOpen = openButton.getToggleState();
         openButton.setButtonText(isOpen ? "Open" : "Closed");
         if (spriteWindow != nullptr) {
-            spriteWindow->setVisible(isOpen);
+            if (onSharedStage) spriteWindow->getContent()->setVisible(isOpen);
+            else spriteWindow->setVisible(isOpen);
         }
     };
 
@@ -285,14 +324,51 @@ SquabDanceAudioProcessorEditor::SquabDanceAudioProcessorEditor (SquabDanceAudioP
 
     // 6. WINDOW INIT
     spriteWindow = std::make_unique<SpriteWindow>("Squab Visuals");
-    
-    if (DEFAULT_CHARACTER_INDEX <= characterDB.size()) {
-        categoryBox.setSelectedId(DEFAULT_CHARACTER_INDEX); 
-    } else {
-        categoryBox.setSelectedId(1);
-    }
-    
-    startTimerHz(30); 
+    spriteWindow->getContent()->setBeatClock(&audioProcessor.beatClock);
+    spriteWindow->getContent()->setEventQueue(&audioProcessor.animationEvents);
+    
+    // Whatever the processor has (saved state, the last program), not a fixed default
+    showProcessorSelection();
+    prewarmPrograms();
+    
+    // 7. THUMBNAIL BROWSER: picking a preview loads full sheets for that category only
+    thumbnailBrowser = std::make_unique<ThumbnailBrowser>(characterDB);
+    addChildComponent(*thumbnailBrowser);
+    thumbnailBrowser->setBounds(getLocalBounds().reduced(20));
+    thumbnailBrowser->onSelect = [this](int category, int animation) {
+        if (categoryBox.getSelectedId() != category + 1) categoryBox.setSelectedId(category + 1, juce::sendNotificationSync);
+        animationBox.setSelectedId(animation + 1, juce::sendNotificationSync);
+        thumbnailBrowser->setSelected(category, animation);
+    };
+
+    // 8. HIDDEN DEBUG OVERLAY (Ctrl+Shift+D)
+    addChildComponent(debugOverlay);
+    debugOverlay.addSection("Memory", [] { return MemoryAccounting::Ledger::getInstance().describe(); });
+    debugOverlay.addSection("Render quality", [this] {
+        auto* content = getSpriteContent();
+        return content != nullptr ? content->getGovernor().describe() : juce::String("no sprite window");
+    });
+    debugOverlay.addSection("Crowd", [this] {
+        auto* content = getSpriteContent();
+        return content != nullptr ? content->getCrowd().describe() : juce::String("no sprite window");
+    });
+    debugOverlay.addSection("Export", [this] { return audioProcessor.getExportStatus(); });
+    debugOverlay.addSection("Frame sharing", [this] {
+        return framePublisher != nullptr ? framePublisher->describe() : juce::String("off");
+    });
+    debugOverlay.addSection("Editor activity", [this] { return editorActivity.describe(); });
+    debugOverlay.addSection("Dancer activity", [this] {
+        auto* content = getSpriteContent();
+        return content != nullptr ? content->getActivity().describe() : juce::String("no sprite window");
+    });
+    setWantsKeyboardFocus(true);
+
+    watchParameters();
+    audioProcessor.addListener(this);
+
+    // The ring filled up and froze while no editor was draining it; start from the live blocks
+    audioProcessor.telemetry.discardPending();
+    startTimerHz(activeTimerHz); 
 }
 
 SquabDanceAudioProcessorEditor::~SquabDanceAudioProcessorEditor() { 
@@ -307,102 +383,233 @@ SquabDanceAudioProcessorEditor::~SquabDanceAudioProcessorEditor() {
     panningSlider.setLookAndFeel(nullptr);
 
     randomButton.setLookAndFeel(nullptr);
+    browseButton.setLookAndFeel(nullptr);
 
+    audioProcessor.removeListener(this);
+    // Off the shared stage before the dancer is deleted (the window is going anyway, don't reshow it)
+    if (onSharedStage && spriteWindow != nullptr) sharedStage->removeDancer(spriteWindow->getContent());
     spriteWindow = nullptr; 
+    framePublisher = nullptr;
 }
 
 void SquabDanceAudioProcessorEditor::timerCallback() {
+    SQUAB_TRACE_THREAD("Message");
+    SQUAB_TRACE_ZONE("editorTimer");
 
-    bool isSync = *audioProcessor.apvts.getRawParameterValue("sync_mode") > 0.5f;
-    int syncIdx = (int)*audioProcessor.apvts.getRawParameterValue("sync_rate");
-    bool reactOn = *audioProcessor.apvts.getRawParameterValue("audio_react") > 0.5f;
-    float reactInt = *audioProcessor.apvts.getRawParameterValue("react_intensity");
-    float reactCol = *audioProcessor.apvts.getRawParameterValue("react_color");
-    float reactPumpAmount = *audioProcessor.apvts.getRawParameterValue("react_pump");
-   
-    // Grab the peaks from the DSP
-    float peakL = audioProcessor.outputLevelL.load();
-    float peakR = audioProcessor.outputLevelR.load();
-    
-    stereoMeter.setLevels(peakL, peakR);
+    bool parameterWasTouched = parameterTouched.exchange(false);
 
-    // Fade the peaks out slightly so the meter falls smoothly like a real LED
-    audioProcessor.outputLevelL.store(peakL * 0.85f, std::memory_order_relaxed);
-    audioProcessor.outputLevelR.store(peakR * 0.85f, std::memory_order_relaxed);
+    // A MIDI program change only left its look for us; copy it into the parameters (no-op otherwise)
+    audioProcessor.applyPendingLook();
 
+    // A program change or restored state moved the selection: follow it before reading the boxes
+    if (audioProcessor.selectionSerial.load() != shownSelectionSerial) {
+        showProcessorSelection();
+        prewarmPrograms();
+        parameterWasTouched = true;
+    }
 
-    spriteWindow->getContent()->updateAudioReact(reactOn, reactInt, reactCol, reactPumpAmount, audioProcessor.currentAudioLevel.load());
-    
-    const double syncBeatLengths[] = {
-        4.0/2048.0, 4.0/1024.0, 4.0/512.0, 4.0/256.0, 4.0/128.0, 4.0/64.0, 4.0/48.0, 4.0/32.0,
-        4.0/24.0, 4.0/16.0, 4.0/12.0, 4.0/8.0, 4.0/6.0, 12.0/16.0, 4.0/4.0, 20.0/16.0, 
-        4.0/3.0, 12.0/8.0, 4.0/2.0, 12.0/4.0, 4.0/1.0
-    };
+    // Per-frame data: every block since the last tick, drained from the telemetry ring in one go
+    float peakL = 0.0f;
+    float peakR = 0.0f;
+    audioProcessor.telemetry.drain([&](const TelemetryFrame& frame) {
+        peakL = juce::jmax(peakL, frame.truePeak[0]);
+        peakR = juce::jmax(peakR, frame.numChannels > 1 ? frame.truePeak[1] : frame.truePeak[0]);
+        latestTelemetry = frame;
+    });
+
+    stereoMeter.pushPeaks(peakL, peakR);
+    stereoMeter.setLoudness(latestTelemetry.shortTermLufs);
 
-    speedSlider.setVisible(!isSync);
-    syncSlider.setVisible(isSync);
-    
     if (spriteWindow == nullptr || spriteWindow->getContent() == nullptr) return;
+    auto* content = spriteWindow->getContent();
+
+    // Only what changed since the last tick
+    if (auto dirty = dirtyParameters.exchange(0)) pushParameterChanges(dirty);
+    if (selectionDirty) pushSelection();
+
+    audioProcessor.spectrum.read(latestSpectrum);
+    content->updateAudioReact(reactOn, reactIntensity, reactColor, reactPump, latestSpectrum);
+
+   #if JucePlugin_Build_Standalone
+    // In Standalone we own the audio device, so its output latency is known and can be compensated
+    if (juce::PluginHostType::getPluginLoadedAs() == juce::AudioProcessor::wrapperType_Standalone)
+        if (auto* holder = juce::StandalonePluginHolder::getInstance())
+            if (auto* device = holder->deviceManager.getCurrentAudioDevice())
+                audioProcessor.deviceOutputLatencySamples.store(device->getOutputLatencyInSamples(), std::memory_order_relaxed);
+   #endif
+
+    audioProcessor.visualMotion.store(content->getMotion(), std::memory_order_relaxed);
+    audioProcessor.visualHue.store(content->getHue(), std::memory_order_relaxed);
+    audioProcessor.visualPan.store(content->getPan(), std::memory_order_relaxed);
+
+    int quality = content->getQualityLevel();
+    audioProcessor.visualQuality.store(quality, std::memory_order_relaxed);
+    if (quality != shownQuality) {
+        shownQuality = quality;
+        qualityLabel.setText(quality == QualityGovernor::full ? juce::String("Quality: Full")
+                                                              : "Quality: " + juce::String(QualityGovernor::getLevelName(quality)),
+                             juce::dontSendNotification);
+    }
 
-    spriteWindow->getContent()->updateSync(isSync, syncBeatLengths[syncIdx], audioProcessor.currentPpq.load(), audioProcessor.isPlaying.load());
+    updateEditorActivity(parameterWasTouched);
+}
 
-    audioProcessor.visualMotion.store(spriteWindow->getContent()->getMotion(), std::memory_order_relaxed);
-    audioProcessor.visualHue.store(spriteWindow->getContent()->getHue(), std::memory_order_relaxed);
-    audioProcessor.visualPan.store(spriteWindow->getContent()->getPan(), std::memory_order_relaxed);
+void SquabDanceAudioProcessorEditor::watchParameters() {
+    auto watch = [this](const char* id) {
+        WatchedParameter watchedParameter;
+        watchedParameter.value = audioProcessor.apvts.getRawParameterValue(id);
+        if (auto* param = audioProcessor.apvts.getParameter(id))
+            watchedParameter.bit = (juce::uint64)1 << (param->getParameterIndex() & 63);
+        return watchedParameter;
+    };
 
-    // --- DEBUG: PRINT ONCE PER SECOND ---
-    static int debugTick = 0;
-    if (++debugTick % 30 == 0) {
-        float dyn = *audioProcessor.apvts.getRawParameterValue("manip_dynamic");
-        float mot = audioProcessor.visualMotion.load();
-       // DBG("1. BRIDGE Check | Dynamic Knob: " << dyn << " | Visual Motion: " << mot);
+    watched.speed = watch("speed");
+    watched.tween = watch("tween");
+    watched.scale = watch("scale");
+    watched.mirror = watch("mirror");
+    watched.syncMode = watch("sync_mode");
+    watched.syncRate = watch("sync_rate");
+    watched.crowd = watch("crowd");
+    watched.sharedStage = watch("shared_stage");
+    watched.frameShare = watch("frame_share");
+    watched.reactOn = watch("audio_react");
+    watched.reactIntensity = watch("react_intensity");
+    watched.reactColor = watch("react_color");
+    watched.reactPump = watch("react_pump");
+
+    for (auto* id : { "fx_outline", "fx_pixelate", "fx_posterize", "glow_mode", "glow_size" })
+        watched.styleBits |= watch(id).bit;
+}
+
+void SquabDanceAudioProcessorEditor::pushParameterChanges(juce::uint64 dirty) {
+    auto* content = spriteWindow->getContent();
+    auto changed = [dirty](const WatchedParameter& p) { return (dirty & p.bit) != 0; };
+
+    if (changed(watched.syncMode) || changed(watched.syncRate)) {
+        bool isSync = watched.syncMode.get() > 0.5f;
+        speedSlider.setVisible(!isSync);
+        syncSlider.setVisible(isSync);
+        content->updateSync(isSync, SyncRates::getBeatLength((int)watched.syncRate.get()));
     }
 
-    float speed = *audioProcessor.apvts.getRawParameterValue("speed");
-    bool mir = *audioProcessor.apvts.getRawParameterValue("mirror") > 0.5f;
-   int style = juce::jmax(0, animationBox.getSelectedId() - 1);
-    
-    mirrorButton.setButtonText(mir ? "Reflection" : "No Reflection");
+    if (changed(watched.reactOn) || changed(watched.reactIntensity) || changed(watched.reactColor) || changed(watched.reactPump)) {
+        reactOn = watched.reactOn.get() > 0.5f;
+        reactIntensity = watched.reactIntensity.get();
+        reactColor = watched.reactColor.get();
+        reactPump = watched.reactPump.get();
+    }
+
+    if ((dirty & watched.styleBits) != 0) content->setStyle(audioProcessor.getSpriteStyle());
+    if (changed(watched.speed)) content->setSpeed(watched.speed.get());
+    if (changed(watched.tween)) content->setTweenMode((int)watched.tween.get());
+    if (changed(watched.scale)) content->setScale(watched.scale.get() / 100.0f);
+    if (changed(watched.crowd)) content->setCrowdSize((int)watched.crowd.get());
+    if (changed(watched.sharedStage)) setOnSharedStage(watched.sharedStage.get() > 0.5f);
+    if (changed(watched.frameShare)) setFrameSharing(watched.frameShare.get() > 0.5f);
+
+    if (changed(watched.mirror)) {
+        mirrorButton.setButtonText(watched.mirror.get() > 0.5f ? "Reflection" : "No Reflection");
+        selectionDirty = true;
+    }
+}
 
-    float scaleVal = *audioProcessor.apvts.getRawParameterValue("scale") / 100.0f;
-    spriteWindow->getContent()->setScale(scaleVal);
+// The move, its frame count and the held move of the selected category, plus mirroring
+void SquabDanceAudioProcessorEditor::pushSelection() {
+    selectionDirty = false;
 
-   int catIdx = categoryBox.getSelectedId() - 1;
-    
+    int catIdx = categoryBox.getSelectedId() - 1;
+    int style = juce::jmax(0, animationBox.getSelectedId() - 1);
     int frames = 8;
-    int hRow = 0;    // Default to 0 instead of 9 to be inherently safe
-    int hFrames = 8; 
+    int hRow = 0;
+    int hFrames = 8;
 
     if (catIdx >= 0 && catIdx < (int)characterDB.size()) {
-        auto& anims = characterDB[catIdx].anims;
-        
+        auto& anims = characterDB[(size_t)catIdx].anims;
+
         // Ensure the style can NEVER exceed the available animations for this character
         style = juce::jlimit(0, juce::jmax(0, (int)anims.size() - 1), style);
-        
-        if (style >= 0 && style < (int)anims.size()) {
-            frames = anims[style].frameCount;
-        }
+        if (style < (int)anims.size()) frames = anims[(size_t)style].frameCount;
 
-        bool foundHeld = false;
-        for (int i = 0; i < (int)anims.size(); ++i) {
-            juce::String name = anims[i].name.toLowerCase();
-            if (name.contains("held") || name.contains("drag") || name.contains("pick")) {
-                hRow = i;
-                hFrames = anims[i].frameCount;
-                foundHeld = true;
-                break; 
-            }
-        }
+        hRow = heldRows[(size_t)catIdx];
+        if (hRow < (int)anims.size()) hFrames = anims[(size_t)hRow].frameCount;
+    }
 
-        // If no drag animation is found, safely default to the VERY LAST animation available
-        if (!foundHeld && !anims.empty()) {
-            hRow = anims.size() - 1;
-            hFrames = anims.back().frameCount;
-        }
+    spriteWindow->getContent()->updateParams(style, frames, hRow, hFrames, watched.mirror.get() > 0.5f);
+
+    // Frame sharing waits for a loaded character, so a pending request is retried here
+    setFrameSharing(watched.frameShare.get() > 0.5f);
+}
+
+void SquabDanceAudioProcessorEditor::setOnSharedStage(bool shouldBeOnStage) {
+    if (onSharedStage == shouldBeOnStage || spriteWindow == nullptr) return;
+    onSharedStage = shouldBeOnStage;
+
+    auto* content = spriteWindow->getContent();
+    bool isOpen = openButton.getToggleState();
+
+    if (onSharedStage) {
+        spriteWindow->setContentOnSharedStage(true);
+        sharedStage->addDancer(content);
+        content->setVisible(isOpen);
+    } else {
+        sharedStage->removeDancer(content);
+        content->setVisible(true);
+        spriteWindow->setContentOnSharedStage(false);
+        spriteWindow->setVisible(isOpen);
     }
+}
+
+void SquabDanceAudioProcessorEditor::setFrameSharing(bool shouldShare) {
+    if ((framePublisher != nullptr) == shouldShare || spriteWindow == nullptr) return;
+    if (shouldShare && !loadedSheets.isValid()) return;
+
+    auto* content = spriteWindow->getContent();
 
-    spriteWindow->getContent()->setSpeed(speed);
-    spriteWindow->getContent()->updateParams(style, frames, hRow, hFrames, mir);
+    if (shouldShare) {
+        framePublisher = std::make_unique<SharedFramePublisher>(loadedSheets);
+        content->setFramePublisher(framePublisher.get());
+    } else {
+        content->setFramePublisher(nullptr);
+        framePublisher = nullptr;
+    }
+}
+
+void SquabDanceAudioProcessorEditor::audioProcessorParameterChanged(juce::AudioProcessor*, int parameterIndex, float) {
+    // Host automation arrives on the audio thread: leave flags for the (slowed) timer to pick up
+    dirtyParameters.fetch_or((juce::uint64)1 << (parameterIndex & 63));
+    parameterTouched.store(true);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        wakeEditor(ActivityMonitor::WakeReason::parameter);
+}
+
+void SquabDanceAudioProcessorEditor::updateEditorActivity(bool parameterWasTouched) {
+    auto* content = getSpriteContent();
+
+    if (parameterWasTouched) {
+        wakeEditor(ActivityMonitor::WakeReason::parameter);
+    } else if (latestTelemetry.isPlaying) {
+        wakeEditor(ActivityMonitor::WakeReason::transport);
+    } else if (!stereoMeter.isSettled()) {
+        wakeEditor(ActivityMonitor::WakeReason::audio);
+    } else if (content != nullptr && !content->getActivity().isIdle()) {
+        wakeEditor(content->getActivity().getLastWakeReason());
+    } else if (editorActivity.setIdle(true)) {
+        startTimerHz(idleTimerHz);
+    }
+}
+
+void SquabDanceAudioProcessorEditor::wakeEditor(ActivityMonitor::WakeReason reason) {
+    if (editorActivity.wake(reason))
+        startTimerHz(activeTimerHz);
+}
+
+bool SquabDanceAudioProcessorEditor::keyPressed (const juce::KeyPress& key) {
+    if (key == juce::KeyPress('d', juce::ModifierKeys::ctrlModifier | juce::ModifierKeys::shiftModifier, 0)) {
+        debugOverlay.toggle();
+        return true;
+    }
+    return false;
 }
 
 void SquabDanceAudioProcessorEditor::paint (juce::Graphics& g) { 
@@ -425,14 +632,16 @@ void SquabDanceAudioProcessorEditor::resized() {
     // ==========================================
     titleLabel.setBounds(leftColX, topRowY, colWidth, 30);
     birdLogo.setBounds(leftColX, topRowY + 30, colWidth, 130); 
-    mirrorButton.setBounds(leftColX, topRowY + 170, colWidth, 25);
+    mirrorButton.setBounds(leftColX, topRowY + 170, colWidth / 2 - 5, 25);
+    crowdSlider.setBounds(leftColX + colWidth / 2 + 5, topRowY + 170, colWidth / 2 - 5, 25);
 
     // ==========================================
     // TOP RIGHT: Settings, Random Button & Speed
     // ==========================================
     categoryBox.setBounds(rightColX, topRowY + 15, colWidth, 24);
     animationBox.setBounds(rightColX, topRowY + 65, colWidth, 24);
-    randomButton.setBounds(rightColX, topRowY + 105, colWidth, 24); 
+    randomButton.setBounds(rightColX, topRowY + 105, colWidth - 90, 24); 
+    browseButton.setBounds(rightColX + colWidth - 80, topRowY + 105, 80, 24);
 
     int topKnobY = topRowY + 135;
     
@@ -505,67 +714,82 @@ void SquabDanceAudioProcessorEditor::resized() {
     outGainSlider.setBounds(meterX - 15, meterY, 54, meterHeight + 35); 
 
     squabDadLabel.setBounds(rightColX + colWidth - 100, botKnobY + 100, 100, 20);
+    qualityLabel.setBounds(rightColX, botKnobY + 100, colWidth - 100, 20);
+
+    if (thumbnailBrowser != nullptr) thumbnailBrowser->setBounds(getLocalBounds().reduced(20));   // setSize() runs before it exists
+    debugOverlay.setBounds(getLocalBounds());
 }
 
 void SquabDanceAudioProcessorEditor::preCacheImages() {
-    cachedSprites.clear();
-
-    // Launch a background thread so the UI doesn't freeze during startup
-    juce::Thread::launch([this]() {
+    // Warm the shared sheet cache on a background thread so the UI doesn't freeze during startup.
+    // Decoding everything would cost ~1 GB, so warming stops once the memory ceiling gets close;
+    // anything left over is decoded on demand when its category is picked.
+    juce::Thread::launch([cache = sheetCache, database = characterDB]() {
+        SQUAB_TRACE_THREAD("Decode");
         DBG("--- Background Image Caching Started ---");
-        
-        for (int i = 0; i < BinaryData::namedResourceListSize; ++i) {
-            int size = 0;
-            const char* data = BinaryData::getNamedResource(BinaryData::namedResourceList[i], size);
-            
-            if (data != nullptr) {
-                // 1. Decode the PNG data in the background (This is the heavy CPU math!)
-                juce::Image img = juce::ImageCache::getFromMemory(data, size);
-                
-                if (img.isValid()) {
-                    // 2. Safely push the decoded image to the main thread so it stays alive in RAM
-                    juce::MessageManager::callAsync([this, img]() {
-                        cachedSprites.push_back(img);
-                    });
+
+        auto& ledger = MemoryAccounting::Ledger::getInstance();
+        for (const auto& charDef : database) {
+            for (int index : SpriteDatabase::findSheetResources(charDef)) {
+                if (!ledger.hasHeadroom()) {
+                    DBG("--- Background Image Caching Stopped (memory ceiling) ---");
+                    return;
                 }
+                cache->get(index);
             }
         }
         DBG("--- Background Image Caching Complete ---");
     });
 }
+
+void SquabDanceAudioProcessorEditor::showProcessorSelection() {
+    shownSelectionSerial = audioProcessor.selectionSerial.load();
+    if (characterDB.empty()) return;
+
+    const int category = juce::jlimit(0, (int)characterDB.size() - 1, audioProcessor.selectedCategory.load());
+    const int animation = audioProcessor.selectedAnimation.load();
+
+    if (categoryBox.getSelectedId() != category + 1) categoryBox.setSelectedId(category + 1, juce::sendNotificationSync);
+    animationBox.setSelectedId(animation + 1, juce::sendNotificationSync);
+    if (thumbnailBrowser != nullptr) thumbnailBrowser->setSelected(category, animation);
+}
+
+void SquabDanceAudioProcessorEditor::prewarmPrograms() {
+    // Decode the sheets of the current program and the next few in the bank, so stepping through
+    // a set with program changes finds them in the cache. Only the newest request matters: one
+    // still queued is dropped. Touching cached sheets also moves them to the back of the LRU.
+    const int numPrograms = audioProcessor.getNumPrograms();
+    const int current = audioProcessor.getCurrentProgram();
+    std::vector<CharacterDef> upcoming;
+
+    for (int i = 0; i <= juce::jmin(PresetBank::prewarmAhead, numPrograms - 1); ++i)
+        if (auto* look = audioProcessor.getProgramLook((current + i) % numPrograms))
+            if (juce::isPositiveAndBelow(look->category, (int)characterDB.size()))
+                upcoming.push_back(characterDB[(size_t)look->category]);
+
+    prewarmPool.removeAllJobs(false, 0);
+    prewarmPool.addJob([cache = sheetCache, upcoming] {
+        SQUAB_TRACE_THREAD("Decode");
+        auto& ledger = MemoryAccounting::Ledger::getInstance();
+
+        for (const auto& charDef : upcoming)
+            for (int index : SpriteDatabase::findSheetResources(charDef)) {
+                if (!ledger.hasHeadroom() && !cache->contains(index)) return;
+                cache->get(index);
+            }
+    });
+}
+
 void SquabDanceAudioProcessorEditor::loadCharacterImage(int index) {
     if (index < 0 || index >= (int)characterDB.size()) return;
     
     auto& charDef = characterDB[index];
-    std::vector<juce::Image> loadedImages;
-    
-    for (const auto& fname : charDef.filenames) {
-        int size = 0;
-        juce::String searchTarget = fname.upToFirstOccurrenceOf(".", false, false)
-                                         .toLowerCase()
-                                         .replace("-", "");
-                                       
-        bool found = false;
-        
-        for (int i = 0; i < BinaryData::namedResourceListSize; ++i) {
-            juce::String resName = juce::String(BinaryData::namedResourceList[i]).toLowerCase();
-            
-            if (resName.contains(searchTarget.replace(" ", "_")) || resName.contains(searchTarget.replace(" ", ""))) {
-                const char* data = BinaryData::getNamedResource(BinaryData::namedResourceList[i], size);
-                if (data != nullptr) {
-                    juce::Image img = juce::ImageCache::getFromMemory(data, size);
-                    if (img.isValid()) {
-                        loadedImages.push_back(img);
-                        found = true;
-                    }
-                }
-                break;
-            }
-        }
-    }
+    loadedSheets = SpriteSheetSet::load(charDef);
     
     if (spriteWindow != nullptr && spriteWindow->getContent() != nullptr) {
         auto* content = spriteWindow->getContent();
-        content->setSpriteData(charDef.isGridSprite, charDef.anims, loadedImages);
+        content->setSpriteData(charDef.isGridSprite, charDef.anims, loadedSheets.sheets);
     }
+
+    if (framePublisher != nullptr) framePublisher->setSpriteData(loadedSheets);
 }
\ No newline at end of file
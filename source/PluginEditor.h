@@ -3,6 +3,11 @@
 #include "PluginProcessor.h"
 #include "SpriteData.h"
 #include "SpriteWindow.h"
+#include "SharedStage.h"
+#include "DebugOverlay.h"
+#include "ThumbnailBrowser.h"
+#include "MemoryAccounting.h"
+#include "KnobFilmstrip.h"
 
 // --- Custom Sleek Slider Look ---
 class CustomRotarySlider : public juce::LookAndFeel_V4
@@ -11,17 +16,24 @@ public:
     void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height,
                           float sliderPos, const float rotaryStartAngle, const float rotaryEndAngle,
                           juce::Slider& slider) override
+    {
+        // One blit from the pre-rendered strip; paintKnob only runs while the strip is built
+        filmstrip.draw(g, x, y, width, height, sliderPos, rotaryStartAngle, rotaryEndAngle, getKnobArea(width, height),
+                       [rotaryStartAngle, rotaryEndAngle](juce::Graphics& frame, int w, int h, float pos) {
+                           paintKnob(frame, w, h, pos, rotaryStartAngle, rotaryEndAngle);
+                       });
+    }
+
+    static void paintKnob(juce::Graphics& g, int width, int height, float sliderPos,
+                          float rotaryStartAngle, float rotaryEndAngle)
     {
         // Increased padding from 4.0f to 8.0f for more breathing room
-        auto radius = (float)juce::jmin(width / 2, height / 2) - 8.0f;
+        auto radius = getRadius(width, height);
         
-        auto centreX = (float)x + (float)width  * 0.5f;
+        auto centreX = (float)width  * 0.5f;
         // THE FIX: Removed the "- 10.0f" that was shoving the circle into the label!
-        auto centreY = (float)y + (float)height * 0.5f; 
+        auto centreY = (float)height * 0.5f; 
         
-        auto rx = centreX - radius;
-        auto ry = centreY - radius;
-        auto rw = radius * 2.0f;
         auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
         auto trackThickness = 2.5f; 
 
@@ -67,6 +79,18 @@ public:
         g.strokePath(path, juce::PathStrokeType(1.5f));
     }
 
+private:
+    static float getRadius(int width, int height) { return (float)juce::jmin(width / 2, height / 2) - 8.0f; }
+
+    // The square the arcs and the pointer dot can reach (half the dot plus a pixel of antialiasing)
+    static juce::Rectangle<int> getKnobArea(int width, int height) {
+        const float extent = getRadius(width, height) + 4.0f;
+        return juce::Rectangle<float>((float)width * 0.5f - extent, (float)height * 0.5f - extent, extent * 2.0f, extent * 2.0f)
+                   .getSmallestIntegerContainer()
+                   .getIntersection({ width, height });
+    }
+
+    KnobFilmstrip filmstrip;
 };
 
 // --- Custom Fader Handle  ---
@@ -90,7 +114,30 @@ public:
 // --- Stereo Color LED Meter ---
 class LevelMeter : public juce::Component {
 public:
-    void setLevels(float l, float r) { levelL = l; levelR = r; repaint(); }
+    // Meter ballistics live here on the UI side: instant attack, then a smooth LED-style fall.
+    // Called once per editor tick with the loudest true peaks drained from the telemetry ring.
+    void pushPeaks(float l, float r) {
+        auto release = [](float peak, float level) {
+            float next = juce::jmax(peak, level * releaseFactor);
+            return next < floorLevel ? 0.0f : next;
+        };
+
+        float newL = release(l, levelL);
+        float newR = release(r, levelR);
+        if (newL == levelL && newR == levelR) return; // Silence: nothing to redraw
+
+        levelL = newL;
+        levelR = newR;
+        repaint();
+    }
+
+    bool isSettled() const { return levelL == 0.0f && levelR == 0.0f; }
+
+    // Short-term loudness marker (LUFS), drawn as a thin line across both bars
+    void setLoudness(float lufs) { loudnessGain = juce::Decibels::decibelsToGain(lufs, -100.0f); }
+
+    void resized() override { gradientStrip = {}; stripBytes.reset(0); }
+
     void paint(juce::Graphics& g) override {
         auto bounds = getLocalBounds().toFloat();
         
@@ -99,28 +146,56 @@ public:
 
         float w = bounds.getWidth() / 2.0f - 1.0f; 
 
+        // The gradient never changes for a given size, so rasterise it once (in physical pixels,
+        // so it stays sharp on HiDPI) and blit slices of it. A DPI change re-renders it.
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (!gradientStrip.isValid() || scale != stripScale)
+            rebuildGradientStrip((int)std::ceil(w * scale), (int)std::ceil((float)getHeight() * scale), scale);
+
         auto drawBar = [&](float level, float x) {
-            float h = juce::jlimit(0.0f, 1.0f, level) * bounds.getHeight();
-            auto fillBounds = juce::Rectangle<float>(x, bounds.getBottom() - h, w, h);
-            
-            juce::ColourGradient grad(juce::Colour(0xFFFF3333), x, bounds.getY(),
-                                      juce::Colour(0xFF33FF55), x, bounds.getBottom(), false);
-            grad.addColour(0.25, juce::Colour(0xFFFFD700)); 
-            g.setGradientFill(grad);
-            g.fillRect(fillBounds);
+            int h = juce::roundToInt(juce::jlimit(0.0f, 1.0f, level) * bounds.getHeight());
+            if (h <= 0) return;
+            int srcH = juce::jmin(gradientStrip.getHeight(), juce::roundToInt((float)h * stripScale));
+            g.drawImage(gradientStrip, (int)x, getHeight() - h, (int)w, h,
+                        0, gradientStrip.getHeight() - srcH, gradientStrip.getWidth(), srcH);
         };
 
         drawBar(levelL, 0.0f);
         drawBar(levelR, w + 2.0f);
+
+        if (loudnessGain > 0.0f) {
+            float y = bounds.getBottom() - juce::jlimit(0.0f, 1.0f, loudnessGain) * bounds.getHeight();
+            g.setColour(juce::Colours::white.withAlpha(0.7f));
+            g.fillRect(0.0f, y, bounds.getWidth(), 1.0f);
+        }
     }    
 private:
+    void rebuildGradientStrip(int width, int height, float scale) {
+        stripScale = scale;
+        gradientStrip = juce::Image(juce::Image::RGB, juce::jmax(1, width), juce::jmax(1, height), false);
+        juce::Graphics g(gradientStrip);
+        juce::ColourGradient grad(juce::Colour(0xFFFF3333), 0.0f, 0.0f,
+                                  juce::Colour(0xFF33FF55), 0.0f, (float)height, false);
+        grad.addColour(0.25, juce::Colour(0xFFFFD700)); 
+        g.setGradientFill(grad);
+        g.fillAll();
+        stripBytes.reset(MemoryAccounting::getImageBytes(gradientStrip));
+    }
+
+    static constexpr float releaseFactor = 0.85f; // Per 30 Hz tick
+    static constexpr float floorLevel = 1.0e-4f;  // -80 dB, below a pixel on any meter height
     float levelL = 0.0f, levelR = 0.0f;
+    float loudnessGain = 0.0f;
+    juce::Image gradientStrip;
+    float stripScale = 1.0f;   // Physical pixels per logical pixel the strip was rendered at
+    MemoryAccounting::Allocation stripBytes { MemoryAccounting::Tag::ui, 0 };
 };
 
 
 
 class SquabDanceAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                       public juce::Timer
+                                       public juce::Timer,
+                                       private juce::AudioProcessorListener
 {
 public:
     SquabDanceAudioProcessorEditor (SquabDanceAudioProcessor&);
@@ -129,6 +204,10 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
     void timerCallback() override;
+    bool keyPressed (const juce::KeyPress& key) override;
+
+    // The dancer this editor drives (used by the headless render benchmark)
+    SpriteContent* getSpriteContent() { return spriteWindow != nullptr ? spriteWindow->getContent() : nullptr; }
 
 private:
     SquabDanceAudioProcessor& audioProcessor;
@@ -138,6 +217,7 @@ private:
     juce::Label titleLabel;
     juce::ImageComponent birdLogo;
     juce::Label squabDadLabel;
+    juce::Label qualityLabel; // Current QualityGovernor level
 
     juce::ComboBox categoryBox;
     juce::Label catLabel;
@@ -145,6 +225,7 @@ private:
     juce::Label animLabel;
 
     juce::TextButton randomButton;
+    juce::TextButton browseButton;
 
     juce::Slider speedSlider;
     juce::Label speedLabel;
@@ -184,6 +265,10 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> syncAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> scaleAttachment;
 
+    // Crowd size (shares the row with the mirror button)
+    juce::Slider crowdSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> crowdAttachment;
+
     // --- AUDIO MANIPULATION UI ---
     juce::Label manipTitleLabel;
     juce::TextButton manipButton;
@@ -215,15 +300,95 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> outGainAttachment;
 
 
+    // Most recent block drained from the processor's telemetry ring, and the latest analysed hop
+    TelemetryFrame latestTelemetry;
+    SpectralFeatures latestSpectrum;
+
+    // --- IDLE THROTTLING ---
+    // The editor ticks at 30 Hz while anything moves and drops to 5 Hz when the dancer is idle,
+    // the meters are settled and the transport is stopped. Parameter changes on the message
+    // thread wake it at once. Host automation from the audio thread only sets parameterTouched,
+    // which the next tick polls (at most 200 ms late while idle): nothing is posted to the
+    // message queue from the audio thread.
+    static constexpr int activeTimerHz = 30;
+    static constexpr int idleTimerHz = 5;
+
+    void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override;
+    void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails&) override {}
+    void updateEditorActivity(bool parameterWasTouched);
+    void wakeEditor(ActivityMonitor::WakeReason reason);
+
+    ActivityMonitor editorActivity;
+    std::atomic<bool> parameterTouched { false }; // Set from any thread (host automation)
+
+    // --- PARAMETER -> VISUALS SYNC ---
+    // Nothing is polled. The processor listener sets the changed parameter's bit in
+    // dirtyParameters (from any thread), combo box changes set selectionDirty, and the next tick
+    // pushes only what those flags cover into the widgets and SpriteContent. Both start out set,
+    // so the first tick pushes everything. Pointers and bits are resolved once.
+    struct WatchedParameter
+    {
+        std::atomic<float>* value = nullptr;
+        juce::uint64 bit = 0;   // Parameter index mod 64: a collision only costs a redundant push
+
+        float get() const { return value->load(std::memory_order_relaxed); }
+    };
+
+    struct WatchedParameters
+    {
+        WatchedParameter speed, tween, scale, mirror, syncMode, syncRate, crowd, sharedStage, frameShare;
+        WatchedParameter reactOn, reactIntensity, reactColor, reactPump;
+        juce::uint64 styleBits = 0;   // fx_* and glow_*, pushed together as one SpriteStyle
+    } watched;
+
+    void watchParameters();
+    void pushParameterChanges(juce::uint64 dirty);
+    void pushSelection();
+
+    std::atomic<juce::uint64> dirtyParameters { ~(juce::uint64)0 };
+    bool selectionDirty = true;
+
+    // Reactivity settings as last pushed; SpriteContent gets them with every spectrum hop
+    bool reactOn = false;
+    float reactIntensity = 0.0f, reactColor = 0.0f, reactPump = 0.0f;
+    int shownQuality = -1;
+
+    // Row of each category's held/drag move (SpriteDatabase::findHeldAnimation), found once
+    std::vector<int> heldRows;
+
+    // Live zone timings / trace export, hidden until Ctrl+Shift+D
+    DebugOverlay debugOverlay;
+
     std::vector<CharacterDef> characterDB;
+
+    // Animated previews of every move, over the whole editor while open (needs characterDB)
+    std::unique_ptr<ThumbnailBrowser> thumbnailBrowser;
     std::unique_ptr<SpriteWindow> spriteWindow;
+
+    // Shared compositor window (opt-in via "shared_stage")
+    juce::SharedResourcePointer<SharedStage> sharedStage;
+    bool onSharedStage = false;
+    void setOnSharedStage(bool shouldBeOnStage);
+
+    // Shared-memory frame output for streaming tools (opt-in via "frame_share")
+    std::unique_ptr<SharedFramePublisher> framePublisher;
+    SpriteSheetSet loadedSheets;   // What loadCharacterImage last decoded; the publisher shares these images
+    void setFrameSharing(bool shouldShare);
     
      void preCacheImages();
     void loadCharacterImage(int index);
+
+    // --- PRESET BANK ---
+    // Selection changes made by the processor (programs, restored state) are pulled in here
+    void showProcessorSelection();
+    void prewarmPrograms();
+    int shownSelectionSerial = -1;
     bool isSyncMode = false; 
     void triggerBackgroundLoad(int index);
     
-    std::vector<juce::Image> cachedSprites;
+    // Decoded sheets live in the process-wide cache (memory-accounted, evictable)
+    juce::SharedResourcePointer<SpriteSheetCache> sheetCache;
+    MemoryAccounting::Allocation logoBytes;
 
     struct ResourcePointer {
         const char* data = nullptr;
@@ -231,5 +396,7 @@ private:
     };
     std::vector<ResourcePointer> resourceCache;
 
+    juce::ThreadPool prewarmPool { 1 };   // Last, so it stops before the rest goes
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SquabDanceAudioProcessorEditor)
 };
\ No newline at end of file
@@ -9,9 +9,46 @@ SquabDanceAudioProcessor::SquabDanceAudioProcessor()
        apvts(*this, nullptr, "Parameters", createParameterLayout())
 #endif
 {
+    // Resolve every DSP parameter once; processBlock only dereferences these
+    manipParam   = apvts.getRawParameterValue("audio_manip");
+    dynamicParam = apvts.getRawParameterValue("manip_dynamic");
+    hueAmtParam  = apvts.getRawParameterValue("manip_hue");
+    panAmtParam  = apvts.getRawParameterValue("manip_pan");
+    satTypeParam = apvts.getRawParameterValue("sat_type");
+    dryWetParam  = apvts.getRawParameterValue("dry_wet");
+    outGainParam = apvts.getRawParameterValue("out_gain");
+
+    dancerParams.exportMode       = apvts.getRawParameterValue("export_mode");
+    dancerParams.exportFps        = apvts.getRawParameterValue("export_fps");
+    dancerParams.exportResolution = apvts.getRawParameterValue("export_res");
+    dancerParams.mirror           = apvts.getRawParameterValue("mirror");
+    dancerParams.scale            = apvts.getRawParameterValue("scale");
+    dancerParams.speed            = apvts.getRawParameterValue("speed");
+    dancerParams.syncMode         = apvts.getRawParameterValue("sync_mode");
+    dancerParams.syncRate         = apvts.getRawParameterValue("sync_rate");
+    dancerParams.reactOn          = apvts.getRawParameterValue("audio_react");
+    dancerParams.reactIntensity   = apvts.getRawParameterValue("react_intensity");
+    dancerParams.reactColor       = apvts.getRawParameterValue("react_color");
+    dancerParams.reactPump        = apvts.getRawParameterValue("react_pump");
+    dancerParams.fxOutline        = apvts.getRawParameterValue("fx_outline");
+    dancerParams.fxPixelate       = apvts.getRawParameterValue("fx_pixelate");
+    dancerParams.fxPosterize      = apvts.getRawParameterValue("fx_posterize");
+    dancerParams.glowMode         = apvts.getRawParameterValue("glow_mode");
+    dancerParams.glowSize         = apvts.getRawParameterValue("glow_size");
+
+    presets = PresetBank::createFactoryBank(apvts);
+
+    // One offline timeline slot per animation of every character, all empty until needed
+    for (const auto& character : SpriteDatabase::getDatabase()) {
+        offlineTimelineFirstSlot.push_back(numOfflineTimelineSlots);
+        numOfflineTimelineSlots += juce::jmax(1, (int)character.anims.size());
+    }
+    offlineTimelines = std::make_unique<std::atomic<const VisualTimeline*>[]>((size_t)juce::jmax(1, numOfflineTimelineSlots));
 }
 
-SquabDanceAudioProcessor::~SquabDanceAudioProcessor() {}
+SquabDanceAudioProcessor::~SquabDanceAudioProcessor()
+{
+}
 
 // Define your parameters here
 juce::AudioProcessorValueTreeState::ParameterLayout SquabDanceAudioProcessor::createParameterLayout()
@@ -31,11 +68,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout SquabDanceAudioProcessor::cr
         "Scale", 
         juce::NormalisableRange<float>(0.0f, 300.0f, 1.0f), 100.0f));
         
-    // 4. Speed (HZ) - Range 1Hz to 30Hz, default 12Hz
+    // 4. Speed (HZ) - Range 1Hz to 30Hz, default 12Hz (fractional rates need in-betweening)
    layout.add(std::make_unique<juce::AudioParameterFloat>(
     "speed", 
     "Speed", 
-    juce::NormalisableRange<float>(1.0f, 30.0f, 1.0f), 30.0f ));
+    juce::NormalisableRange<float>(1.0f, 30.0f, 0.1f), 30.0f ));
+
+    // In-betweening: display-rate frames blended between the authored ones
+    layout.add(std::make_unique<juce::AudioParameterChoice>("tween", "In-Betweening",
+        juce::StringArray { "Off", "Crossfade", "Motion" }, 0));
 
 // 1. The Mode Toggle (Hz vs Note)
     layout.add(std::make_unique<juce::AudioParameterBool>("sync_mode", "Sync Mode", false));
@@ -58,6 +99,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout SquabDanceAudioProcessor::cr
     layout.add(std::make_unique<juce::AudioParameterFloat>("react_color", "Color", 0.0f, 100.0f, 0.0f));
     layout.add(std::make_unique<juce::AudioParameterFloat>("react_pump", "Pump", 0.0f, 100.0f, 0.0f));
 
+    // --- SPRITE EFFECTS: stylising passes fused with the grade (pixel size 1 / 0 levels = off) ---
+    layout.add(std::make_unique<juce::AudioParameterBool>("fx_outline", "Outline", false));
+    layout.add(std::make_unique<juce::AudioParameterInt>("fx_pixelate", "Pixelate", 1, 16, 1));
+    layout.add(std::make_unique<juce::AudioParameterInt>("fx_posterize", "Posterize", 0, 16, 0));
+
+    // --- GLOW / DROP SHADOW: behind the dancer, strength follows react_intensity (and the beat) ---
+    layout.add(std::make_unique<juce::AudioParameterChoice>("glow_mode", "Glow",
+        juce::StringArray { "Off", "Glow", "Shadow" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterInt>("glow_size", "Glow Size", 1, 16, 6));
+
     // --- AUDIO MANIPULATION ---
     layout.add(std::make_unique<juce::AudioParameterBool>("audio_manip", "Audio Manipulation", false));
     layout.add(std::make_unique<juce::AudioParameterFloat>("manip_dynamic", "Dynamic", 0.0f, 100.0f, 0.0f));
@@ -72,6 +123,23 @@ juce::AudioProcessorValueTreeState::ParameterLayout SquabDanceAudioProcessor::cr
     layout.add(std::make_unique<juce::AudioParameterFloat>("dry_wet", "Dry/Wet", 0.0f, 100.0f, 100.0f));
     layout.add(std::make_unique<juce::AudioParameterFloat>("out_gain", "Output Gain", -60.0f, 12.0f, 0.0f));
 
+    // --- CROWD MODE: total dancers on stage (1 = just the lead) ---
+    layout.add(std::make_unique<juce::AudioParameterInt>("crowd", "Crowd Size", 1, 128, 1));
+
+    // --- SHARED STAGE: one compositor window for every instance in the process (opt-in) ---
+    layout.add(std::make_unique<juce::AudioParameterBool>("shared_stage", "Shared Stage", false));
+
+    // --- FRAME SHARING: publish the dancer to a shared-memory ring for streaming tools (opt-in) ---
+    layout.add(std::make_unique<juce::AudioParameterBool>("frame_share", "Frame Sharing", false));
+
+    // --- OFFLINE FRAME EXPORT: renders the dancer frame-accurately during an offline bounce ---
+    layout.add(std::make_unique<juce::AudioParameterChoice>("export_mode", "Export Mode",
+        juce::StringArray { "Off", "PNG Sequence", "Raw RGBA Pipe" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("export_fps", "Export FPS",
+        juce::StringArray { "24", "25", "30", "50", "60" }, 2));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("export_res", "Export Resolution",
+        juce::StringArray { "540p", "720p", "1080p", "1440p", "2160p" }, 2));
+
 
     return layout;
 }
@@ -81,11 +149,57 @@ bool SquabDanceAudioProcessor::acceptsMidi() const { return true; }
 bool SquabDanceAudioProcessor::producesMidi() const { return false; }
 bool SquabDanceAudioProcessor::isMidiEffect() const { return false; }
 double SquabDanceAudioProcessor::getTailLengthSeconds() const { return 0.0; }
-int SquabDanceAudioProcessor::getNumPrograms() { return 1; }
-int SquabDanceAudioProcessor::getCurrentProgram() { return 0; }
-void SquabDanceAudioProcessor::setCurrentProgram (int index) {}
-const juce::String SquabDanceAudioProcessor::getProgramName (int index) { return {}; }
-void SquabDanceAudioProcessor::changeProgramName (int index, const juce::String& newName) {}
+int SquabDanceAudioProcessor::getNumPrograms() { return juce::jmax(1, (int)presets.size()); }
+int SquabDanceAudioProcessor::getCurrentProgram() { return currentProgram.load(std::memory_order_relaxed); }
+
+void SquabDanceAudioProcessor::setCurrentProgram (int index)
+{
+    selectProgram(index);
+
+    // Never called on the audio thread, though not always on the message thread either. Hosts
+    // expect the parameters to show the program as soon as this returns, so apply it here:
+    // setting parameters is fine from any thread but the audio one.
+    applyPendingLook();
+}
+
+const juce::String SquabDanceAudioProcessor::getProgramName (int index)
+{
+    auto* look = getProgramLook(index);
+    return look != nullptr ? look->name : juce::String();
+}
+
+void SquabDanceAudioProcessor::changeProgramName (int index, const juce::String& newName) {}   // Factory bank
+
+// --- PRESET BANK ---
+// Safe on the audio thread: two atomic stores, nothing else. The look reaches the parameters
+// through applyPendingLook (editor tick, or setCurrentProgram).
+void SquabDanceAudioProcessor::selectProgram (int index)
+{
+    auto* look = getProgramLook(index);
+    if (look == nullptr) return;
+
+    currentProgram.store(index, std::memory_order_relaxed);
+    pendingLook.store(look, std::memory_order_release);
+}
+
+void SquabDanceAudioProcessor::applyPendingLook()
+{
+    auto* look = pendingLook.load(std::memory_order_acquire);
+    if (look == nullptr) return;
+
+    for (int slot = 0; slot < PresetBank::numSlots; ++slot)
+        if (auto* param = apvts.getParameter(PresetBank::getParameterID(slot)))
+            param->setValueNotifyingHost(param->convertTo0to1(look->values[(size_t)slot]));
+
+    selectedCategory.store(look->category, std::memory_order_relaxed);
+    selectedAnimation.store(look->animation, std::memory_order_relaxed);
+    selectionSerial.fetch_add(1);
+    prepareOfflineVisuals();
+
+    // The parameters now match the look, so the audio thread can go back to them. If another
+    // program came in meanwhile it stays pending for the next call.
+    pendingLook.compare_exchange_strong(look, nullptr);
+}
 
 void SquabDanceAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock) {
     // 1. Ask the DAW how many channels we need to support
@@ -105,120 +219,513 @@ void SquabDanceAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
     itdBuffer.setSize(maxChannels, (int)(sampleRate * 0.005) + 1);
     itdBuffer.clear();
     itdWritePosition = 0;
+
+    // 4. Metering runs on the output bus
+    outputMeter.prepare(sampleRate, getChannelLayoutOfBus(false, 0), samplesPerBlock);
+
+    // 5. Smoothers are defined in milliseconds so they behave the same at 44.1 kHz and 192 kHz
+    auto resetSmoother = [sampleRate](juce::SmoothedValue<float>& smoother, float value) {
+        smoother.reset(sampleRate, parameterRampMs / 1000.0);
+        smoother.setCurrentAndTargetValue(value);
+    };
+    resetSmoother(dynamicSmoothed, dynamicParam->load() / 100.0f);
+    resetSmoother(hueAmtSmoothed, hueAmtParam->load() / 100.0f);
+    resetSmoother(panAmtSmoothed, panAmtParam->load() / 100.0f);
+    resetSmoother(dryWetSmoothed, dryWetParam->load() / 100.0f);
+    resetSmoother(outGainSmoothed, juce::Decibels::decibelsToGain(outGainParam->load()));
+
+    // Analysis and visual smoothers start from rest, so every offline render starts identically
+    spectrum.prepare(sampleRate, !isNonRealtime());
+    offlineSpectrum = {};
+    onsetDetector.prepare(sampleRate, !isNonRealtime());
+    onsetClock.prepare(sampleRate);
+    smoothMotion = 0.0f;
+    smoothHue = 0.0f;
+    smoothPan = 0.5f;
+
+    motionCoeff = onePoleCoefficient(motionSmoothingMs, sampleRate);
+    hueCoeff = onePoleCoefficient(colourSmoothingMs, sampleRate);
+    panCoeff = onePoleCoefficient(colourSmoothingMs, sampleRate);
+
+    // 6. Offline: the timelines and the frame export are set up here, never in processBlock
+    prepareOfflineVisuals();
+    if (isNonRealtime()) startExport();
+}
+
+void SquabDanceAudioProcessor::releaseResources()
+{
+    exporter.finish();
+    spectrum.release();
+    onsetDetector.release();
 }
 
-void SquabDanceAudioProcessor::releaseResources() {}
+void SquabDanceAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    // Offline the analysis hops and tempo estimates run inline in processBlock instead of on
+    // workers. processBlock picks the path from isNonRealtime(), so the workers must be stopped
+    // before the flag says offline, and only started again once it says realtime; otherwise a
+    // block in between runs the inline analysis while a worker is still on the same state.
+    if (isNonRealtime) {
+        spectrum.setRealtime(false);
+        onsetDetector.setRealtime(false);
+        AudioProcessor::setNonRealtime(true);
+        prepareOfflineVisuals();
+        startExport();
+    } else {
+        AudioProcessor::setNonRealtime(false);
+        spectrum.setRealtime(true);
+        onsetDetector.setRealtime(true);
+    }
+
+    // The bounce is over: flush the last frames and close the encoder
+    if (!isNonRealtime) exporter.finish();
+}
 
 void SquabDanceAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    SQUAB_TRACE_THREAD("Audio");
+    SQUAB_TRACE_ZONE("processBlock");
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
+    // Everything the UI needs about this block goes into one record
+    TelemetryFrame frame;
+    frame.numSamples = buffer.getNumSamples();
+    frame.sampleRate = getSampleRate();
+    frame.samplePosition = fallbackSamplePosition;
+
+    PlayheadSnapshot playhead;
+    bool hostTransport = false;
+
     if (auto* ph = getPlayHead()) {
         if (auto pos = ph->getPosition()) { 
-            currentBpm.store(pos->getBpm().orFallback(120.0), std::memory_order_relaxed);
-            currentPpq.store(pos->getPpqPosition().orFallback(0.0), std::memory_order_relaxed);
-            isPlaying.store(pos->getIsPlaying(), std::memory_order_relaxed);
+            frame.bpm = pos->getBpm().orFallback(120.0);
+            frame.ppq = pos->getPpqPosition().orFallback(0.0);
+            frame.isPlaying = pos->getIsPlaying();
+            frame.samplePosition = pos->getTimeInSamples().orFallback(fallbackSamplePosition);
+            playhead.hostTimeNs = pos->getHostTimeNs().orFallback(0);
+            hostTransport = pos->getPpqPosition().hasValue() && pos->getBpm().hasValue();
         }
     }
-
-    // --- AUDIO ENVELOPE FOLLOWER ---
-    float rms = 0.0f;
-    for (int channel = 0; channel < totalNumInputChannels; ++channel) {
-        auto* readPointer = buffer.getReadPointer(channel);
-        for (int i = 0; i < buffer.getNumSamples(); ++i) rms += readPointer[i] * readPointer[i];
+    fallbackSamplePosition += buffer.getNumSamples();
+
+    // --- ONSET-DRIVEN TRANSPORT ---
+    // No tempo from the host: sync mode follows the beats detected in the input instead. Runs
+    // before the beat clock is published so an onset in this block already moves this snapshot.
+    if (!hostTransport) {
+        SQUAB_TRACE_ZONE("processBlock.onsets");
+        int numOnsets = onsetDetector.process(buffer, totalNumInputChannels);
+        if (isNonRealtime()) onsetDetector.analyseTempo();
+        onsetClock.advance(onsetDetector, numOnsets, buffer.getNumSamples());
+
+        frame.ppq = onsetClock.getBlockPpq();
+        frame.bpm = onsetClock.getBpm();
+        frame.isPlaying = onsetClock.isPlaying();
     }
 
-    rms = std::sqrt(rms / (totalNumInputChannels * buffer.getNumSamples() + 1e-6f)) * 10.0f;
+    // --- PUBLISH THE BEAT CLOCK FIRST ---
+    // Stamped before the DSP runs so the timestamp is as close as possible to the block start.
+    playhead.ppq = frame.ppq;
+    playhead.bpm = frame.bpm;
+    playhead.isPlaying = frame.isPlaying;
+    playhead.samplePosition = frame.samplePosition;
+    playhead.sampleRate = frame.sampleRate;
+    playhead.blockSize = frame.numSamples;
+    playhead.latencySamples = getLatencySamples() + deviceOutputLatencySamples.load(std::memory_order_relaxed);
+    playhead.publishTicks = juce::Time::getHighResolutionTicks();
+    beatClock.publish(playhead);
+
+    // --- MIDI -> ANIMATION EVENTS ---
+    // Read straight from the raw bytes so nothing is allocated, and stamp each event with the time
+    // its sample offset will be heard, using the same latency model as the beat clock.
+    if (!midiMessages.isEmpty() && frame.sampleRate > 0.0) {
+        const double ticksPerSample = (double)juce::Time::getHighResolutionTicksPerSecond() / frame.sampleRate;
+        const int audibleOffset = playhead.blockSize + playhead.latencySamples;
+
+        for (const auto metadata : midiMessages) {
+            const auto* bytes = metadata.data;
+            const int status = bytes[0] & 0xF0;
+
+            // Program change: switch the whole look (applies from this block on, see below)
+            if (status == 0xC0 && metadata.numBytes >= 2) { selectProgram(bytes[1]); continue; }
+            if (metadata.numBytes < 3) continue;
+
+            AnimationEvent event;
+            if (status == 0x90 && bytes[2] > 0) event.type = AnimationEvent::Type::noteOn;
+            else if (status == 0xB0)            event.type = AnimationEvent::Type::controller;
+            else continue;
+
+            event.number = bytes[1];
+            event.value = (float)bytes[2] / 127.0f;
+            event.dueTicks = playhead.publishTicks + (juce::int64)((audibleOffset + metadata.samplePosition) * ticksPerSample);
+            animationEvents.push(event);
+        }
+    }
 
-    float prevLevel = currentAudioLevel.load(std::memory_order_relaxed);
+    // --- PRESET SNAPSHOT ---
+    // One load per block: everything below reads the pending look, if any, through blockLook
+    blockLook = pendingLook.load(std::memory_order_acquire);
 
-    float smoothedLevel = prevLevel;
-    if (rms > prevLevel) smoothedLevel = prevLevel + 0.4f * (rms - prevLevel); 
-    else smoothedLevel = prevLevel + 0.08f * (rms - prevLevel); 
-    currentAudioLevel.store(juce::jmin(1.0f, smoothedLevel), std::memory_order_relaxed);
+    // --- INPUT SPECTRUM ---
+    // Realtime this is only a copy into the analyser's FIFO, the FFTs run on its worker
+    {
+        SQUAB_TRACE_ZONE("processBlock.spectrum");
+        spectrum.push(buffer, totalNumInputChannels);
+    }
 
+    if (isNonRealtime()) {
+        SQUAB_TRACE_ZONE("processBlock.export");
+        offlineSpectrum = spectrum.analysePending();
+        processExportFrames(midiMessages, frame);
+    }
 
 // ========================================================
     // --- OPTIMIZED AUDIO MANIPULATION ENGINE
     // ========================================================
-    bool manipOn = *apvts.getRawParameterValue("audio_manip") > 0.5f;
-    float dynamicAmt = *apvts.getRawParameterValue("manip_dynamic") / 100.0f; 
-    float hueAmt = *apvts.getRawParameterValue("manip_hue") / 100.0f;
-    float panAmt = *apvts.getRawParameterValue("manip_pan") / 100.0f;
+    // Cached parameter pointers: no string lookups on the audio thread
+    bool manipOn = readParameter(blockLook, PresetBank::manipOn, manipParam) > 0.5f;
+    int satType = (int)readParameter(blockLook, PresetBank::satType, satTypeParam);
 
-    // Grab these parameters BEFORE the loop so they are ready to use
-    float dryWet = *apvts.getRawParameterValue("dry_wet") / 100.0f;
-    float outGainDb = *apvts.getRawParameterValue("out_gain");
-    float outGainAmt = juce::Decibels::decibelsToGain(outGainDb);
-    int satType = (int)*apvts.getRawParameterValue("sat_type");
+    // New values become smoother targets, so automation (and program changes) ramp instead of stepping
+    dynamicSmoothed.setTargetValue(readParameter(blockLook, PresetBank::manipDynamic, dynamicParam) / 100.0f);
+    hueAmtSmoothed.setTargetValue(readParameter(blockLook, PresetBank::manipHue, hueAmtParam) / 100.0f);
+    panAmtSmoothed.setTargetValue(readParameter(blockLook, PresetBank::manipPan, panAmtParam) / 100.0f);
+    dryWetSmoothed.setTargetValue(readParameter(blockLook, PresetBank::dryWet, dryWetParam) / 100.0f);
+    outGainSmoothed.setTargetValue(juce::Decibels::decibelsToGain(readParameter(blockLook, PresetBank::outGain, outGainParam)));
 
     float targetMotion = visualMotion.load(std::memory_order_relaxed);
     float targetHue = visualHue.load(std::memory_order_relaxed);
     float targetPan = visualPan.load(std::memory_order_relaxed);
 
+    if (isNonRealtime()) {
+        const auto& offline = getOfflineVisuals(frame);
+        targetMotion = offline.motion;
+        targetHue = offline.hue;
+        targetPan = offline.pan;
+    }
+
+    frame.visualMotion = targetMotion;
+    frame.visualHue = targetHue;
+    frame.visualPan = targetPan;
+    frame.visualQuality = visualQuality.load(std::memory_order_relaxed);
+
     int delayBufferSize = delayBuffer.getNumSamples();
     int itdBufferSize = itdBuffer.getNumSamples();
     
     if (delayBufferSize < 2 || itdBufferSize < 2 || delayBuffer.getNumChannels() == 0) return;
 
-    float maxItdSamples = 0.00075f * getSampleRate(); 
-
     // THE DYNAMIC CEILING: 
     // This guarantees we NEVER process more channels than we have allocated memory for, 
     // instantly preventing Ableton/Reaper phantom channel crashes.
     int safeNumChannels = juce::jmin(buffer.getNumChannels(), (int)svfLp.size());
 
-    // We track peaks out here so they survive the sample loop
-    float peakL = 0.0f;
-    float peakR = 0.0f;
+    // --- SUB-BLOCK SCHEDULER ---
+    // While any control is still moving, split the block into short sub-blocks so the expensive
+    // coefficients (filter, pan, crusher) follow the ramp. Once everything has settled, the rest
+    // of the block runs as a single sub-block with one set of coefficients.
+    const int numSamples = buffer.getNumSamples();
+    {
+        SQUAB_TRACE_ZONE("processBlock.dsp");
+        for (int start = 0; start < numSamples;) {
+            bool moving = dynamicSmoothed.isSmoothing() || hueAmtSmoothed.isSmoothing() || panAmtSmoothed.isSmoothing()
+                       || dryWetSmoothed.isSmoothing() || outGainSmoothed.isSmoothing()
+                       || std::abs(targetMotion - smoothMotion) > settledThreshold
+                       || std::abs(targetHue - smoothHue) > settledThreshold
+                       || std::abs(targetPan - smoothPan) > settledThreshold;
+
+            int num = moving ? juce::jmin(subBlockSize, numSamples - start) : numSamples - start;
+            processSubBlock(buffer, start, num, safeNumChannels, manipOn, satType, targetMotion, targetHue, targetPan);
+            start += num;
+        }
+    }
 
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-        
-        smoothMotion += 0.01f * (targetMotion - smoothMotion);
-        smoothHue += 0.002f * (targetHue - smoothHue);
-        smoothPan += 0.002f * (targetPan - smoothPan);
+    if (!manipOn) {
+        delayBuffer.clear(); 
+        itdBuffer.clear();
+    }
 
-        float drive = 1.0f + (smoothMotion * dynamicAmt * 40.0f); 
-        float delayMs = 0.1f + (smoothHue * 15.0f * hueAmt); 
-        int delaySamples = (int)(delayMs * getSampleRate() / 1000.0f);
-        
-        if (delaySamples < 1) delaySamples = 1;
-        if (delaySamples >= delayBufferSize) delaySamples = delayBufferSize - 1;
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
 
-        float panAngle = (smoothPan - 0.5f) * panAmt * juce::MathConstants<float>::pi;
+    // --- PUBLISH TELEMETRY ---
+    // Output levels are measured in a post-processing pass per channel, not inside the sample loop.
+    {
+        SQUAB_TRACE_ZONE("processBlock.metering");
+        outputMeter.process(buffer, frame);
+    }
 
-        // MULTI-CHANNEL LOOP
-        for (int channel = 0; channel < safeNumChannels; ++channel) {
-            float cleanSig = buffer.getReadPointer(channel)[sample];
+    frame.timestampTicks = juce::Time::getHighResolutionTicks();
+    telemetry.push(frame);
+}
+
+
+// --- OFFLINE VISUAL MODEL ---
+// Every look a bounce can switch to (the selection and each program) gets its timeline here, on
+// whichever non-audio thread changed the selection or the render mode.
+void SquabDanceAudioProcessor::prepareOfflineVisuals()
+{
+    if (!isNonRealtime()) return;
+
+    buildOfflineTimeline(selectedCategory.load(), selectedAnimation.load());
+    for (const auto& look : presets) buildOfflineTimeline(look.category, look.animation);
+}
+
+int SquabDanceAudioProcessor::getOfflineTimelineSlot(int category, int row) const
+{
+    const int numCategories = (int)offlineTimelineFirstSlot.size();
+    if (numCategories == 0) return -1;
+
+    category = juce::jlimit(0, numCategories - 1, category);
+    const int first = offlineTimelineFirstSlot[(size_t)category];
+    const int end = category + 1 < numCategories ? offlineTimelineFirstSlot[(size_t)category + 1] : numOfflineTimelineSlots;
+    return first + juce::jlimit(0, end - first - 1, row);
+}
+
+void SquabDanceAudioProcessor::buildOfflineTimeline(int category, int row)
+{
+    const int slot = getOfflineTimelineSlot(category, row);
+    if (slot < 0 || offlineTimelines[(size_t)slot].load(std::memory_order_acquire) != nullptr) return;
+
+    const juce::ScopedLock sl(offlineTimelineLock);
+    if (offlineTimelines[(size_t)slot].load(std::memory_order_acquire) != nullptr) return;   // Built meanwhile
+
+    auto db = SpriteDatabase::getDatabase();
+    category = juce::jlimit(0, (int)db.size() - 1, category);
+    offlineTimelineStore.push_back(std::make_unique<VisualTimeline>(VisualTimeline::build(SpriteSheetSet::load(db[(size_t)category]), row)));
+    offlineTimelines[(size_t)slot].store(offlineTimelineStore.back().get(), std::memory_order_release);
+}
+
+// The frame the dancer would show at this block's position, looked up in the timeline of the
+// selected animation. A timeline that isn't built yet (the selection changed mid-bounce and the
+// builder hasn't caught up) reads as a still dancer.
+const VisualSample& SquabDanceAudioProcessor::getOfflineVisuals(const TelemetryFrame& frame)
+{
+    static const VisualTimeline notBuilt;
+    const int category = blockLook != nullptr ? blockLook->category : selectedCategory.load(std::memory_order_relaxed);
+    const int row = blockLook != nullptr ? blockLook->animation : selectedAnimation.load(std::memory_order_relaxed);
+
+    const int slot = getOfflineTimelineSlot(category, row);
+    const VisualTimeline* timeline = slot >= 0 ? offlineTimelines[(size_t)slot].load(std::memory_order_acquire) : nullptr;
+    if (timeline == nullptr) timeline = &notBuilt;
+
+    juce::int64 animationFrame = 0;
+    if (readParameter(blockLook, PresetBank::syncMode, dancerParams.syncMode) > 0.5f)
+        animationFrame = (juce::int64)std::floor(frame.ppq / SyncRates::getBeatLength((int)readParameter(blockLook, PresetBank::syncRate, dancerParams.syncRate)));
+    else if (frame.sampleRate > 0.0)
+        animationFrame = (juce::int64)std::floor((double)frame.samplePosition / frame.sampleRate
+                                                 * juce::jmax(1.0f, readParameter(blockLook, PresetBank::speed, dancerParams.speed)));
+
+    return timeline->at(animationFrame);
+}
+
+// --- OFFLINE FRAME EXPORT ---
+// Called when the processor goes offline (setNonRealtime, prepareToPlay), never on the audio
+// thread: finishing a previous run, spawning the workers and launching the encoder all block.
+void SquabDanceAudioProcessor::startExport()
+{
+    auto mode = (ExportSettings::Mode)(int)dancerParams.exportMode->load(std::memory_order_relaxed);
+    if (mode == ExportSettings::Mode::off) return;
+
+    // Hosts call both setNonRealtime(true) and prepareToPlay before a bounce; keep the first run
+    if (exporter.isRunning() && exporter.getNumSubmitted() == 0) return;
+
+    static constexpr double fpsOptions[] = { 24.0, 25.0, 30.0, 50.0, 60.0 };
+    static constexpr int heightOptions[] = { 540, 720, 1080, 1440, 2160 };
+
+    // A program picked but not applied yet is what the bounce will start with
+    const auto* look = pendingLook.load(std::memory_order_acquire);
+
+    ExportSettings settings;
+    settings.mode = mode;
+    settings.fps = fpsOptions[juce::jlimit(0, 4, (int)dancerParams.exportFps->load())];
+    settings.height = heightOptions[juce::jlimit(0, 4, (int)dancerParams.exportResolution->load())];
+    settings.width = settings.height * 16 / 9;
+    settings.category = look != nullptr ? look->category : selectedCategory.load(std::memory_order_relaxed);
+    settings.directory = juce::File(apvts.state.getProperty("exportDirectory", ExportSettings::getDefaultDirectory().getFullPathName()).toString());
+    settings.encoderCommand = apvts.state.getProperty("exportEncoder", ExportSettings::getDefaultEncoderCommand()).toString();
+
+    exporter.finish();
+    auto db = SpriteDatabase::getDatabase();
+    exportAnims = db.empty() ? std::vector<AnimationDef>() : db[(size_t)juce::jlimit(0, (int)db.size() - 1, settings.category)].anims;
+    if (exportAnims.empty()) return;
+
+    exportFps = settings.fps;
+    exportFrameIndex = 0;
+    exportClockStarted = false;
+    exporter.start(settings);   // On failure the reason shows in the export status
+}
+
+// --- OFFLINE FRAME EXPORT CLOCK ---
+// Mirrors what SpriteContent does live (pump physics, MIDI moves, sync/Hz stepping, grading), but
+// stepped once per export frame from the bounce's own sample clock instead of the display clock.
+void SquabDanceAudioProcessor::processExportFrames(const juce::MidiBuffer& midiMessages, const TelemetryFrame& frame)
+{
+    if (!exporter.isRunning() || exportAnims.empty() || frame.sampleRate <= 0.0) return;
+
+    // First block of the bounce, or the host jumped: the next frame lands on this block's first
+    // sample. Frame numbers carry on, so a jump never overwrites frames already written.
+    if (!exportClockStarted || frame.samplePosition != exportNextBlockSample) {
+        exportStartSample = frame.samplePosition - (juce::int64)std::llround((double)exportFrameIndex * frame.sampleRate / exportFps);
+        exportHzPhase = 0.0;
+        exportPump = exportMidiPump = exportHueShift = exportScaleBoost = 0.0f;
+        exportMidiRow = -1;
+        exportClockStarted = true;
+    }
+    exportNextBlockSample = frame.samplePosition + frame.numSamples;
+
+    const float decay = std::pow(0.85f, (float)(60.0 / exportFps)); // Same per-second decay as the live vblank clock
+    const bool syncMode = readParameter(blockLook, PresetBank::syncMode, dancerParams.syncMode) > 0.5f;
+    const double beatLength = SyncRates::getBeatLength((int)readParameter(blockLook, PresetBank::syncRate, dancerParams.syncRate));
+    const bool reactOn = readParameter(blockLook, PresetBank::reactOn, dancerParams.reactOn) > 0.5f;
+    const float reactPump = readParameter(blockLook, PresetBank::reactPump, dancerParams.reactPump);
+    const float reactIntensity = readParameter(blockLook, PresetBank::reactIntensity, dancerParams.reactIntensity);
+    const float reactColor = readParameter(blockLook, PresetBank::reactColor, dancerParams.reactColor);
+    const float speed = readParameter(blockLook, PresetBank::speed, dancerParams.speed);
+    const float scale = readParameter(blockLook, PresetBank::scale, dancerParams.scale);
+    const bool mirror = readParameter(blockLook, PresetBank::mirror, dancerParams.mirror) > 0.5f;
+    const int selectedRow = blockLook != nullptr ? blockLook->animation : selectedAnimation.load(std::memory_order_relaxed);
+    const auto style = makeSpriteStyle(blockLook);
+
+    auto midiIterator = midiMessages.cbegin();
+
+    for (;;) {
+        auto frameSample = exportStartSample + (juce::int64)std::llround((double)exportFrameIndex * frame.sampleRate / exportFps);
+        auto offset = frameSample - frame.samplePosition;
+        if (offset >= frame.numSamples) break;
+
+        // MIDI heard up to this frame
+        for (; midiIterator != midiMessages.cend() && (*midiIterator).samplePosition <= offset; ++midiIterator)
+            applyExportMidiEvent(*midiIterator);
+
+        exportMidiPump *= decay;
+        exportPump = offlineSpectrum.bass > exportPump ? offlineSpectrum.bass : exportPump * decay;
+
+        int selected = exportMidiRow >= 0 ? exportMidiRow : selectedRow;
+        int row = juce::jlimit(0, (int)exportAnims.size() - 1, selected);
+
+        ExportFrameJob job;
+        job.index = exportFrameIndex;
+        job.state.row = row;
+
+        if (syncMode) {
+            double ppq = frame.ppq + (double)offset / frame.sampleRate * frame.bpm / 60.0;
+            job.state.frame = (int)(std::floor(ppq / beatLength));
+        } else {
+            job.state.frame = (int)std::floor(exportHzPhase);
+            exportHzPhase += juce::jmax(1.0f, speed) / exportFps;
+        }
+
+        job.state.scale = scale / 100.0f * (1.0f + exportScaleBoost);
+        job.state.pump = exportMidiPump * 0.45f;
+        if (reactOn && reactPump > 0.0f) job.state.pump += exportPump * (reactPump / 100.0f) * 0.45f;
+        job.state.mirror = mirror;
+        job.state.grade = SpriteGrade::fromReactivity(reactOn, offlineSpectrum.brightness, offlineSpectrum.flux,
+                                                      reactIntensity, reactColor, exportHueShift);
+        job.state.style = style;
+        job.state.glow = SpriteGlow::getStrength(reactOn, reactIntensity, exportPump);
+
+        exporter.submit(job);
+        ++exportFrameIndex;
+    }
+
+    // Events after the block's last frame still land before the next one
+    for (; midiIterator != midiMessages.cend(); ++midiIterator)
+        applyExportMidiEvent(*midiIterator);
+}
+
+// Same note/CC mapping as SpriteContent::applyMidiEvent
+void SquabDanceAudioProcessor::applyExportMidiEvent(const juce::MidiMessageMetadata& metadata)
+{
+    if (metadata.numBytes < 3) return;
+
+    const auto* bytes = metadata.data;
+    const int status = bytes[0] & 0xF0;
+    const float value = (float)bytes[2] / 127.0f;
+
+    if (status == 0x90 && bytes[2] > 0) {
+        int selected = (int)bytes[1] - MidiAnimationMap::firstSelectNote;
+        if (selected >= 0 && selected < (int)exportAnims.size()) exportMidiRow = selected;
+
+        exportMidiPump = juce::jmax(exportMidiPump, value);
+        exportHzPhase = 0.0;
+    } else if (status == 0xB0 && bytes[1] == MidiAnimationMap::scaleController) {
+        exportScaleBoost = value;
+    } else if (status == 0xB0 && bytes[1] == MidiAnimationMap::hueController) {
+        exportHueShift = value;
+    }
+}
+
+void SquabDanceAudioProcessor::processSubBlock (juce::AudioBuffer<float>& buffer, int start, int num, int numChannels,
+                                                bool manipOn, int satType, float targetMotion, float targetHue, float targetPan)
+{
+    const float sampleRate = (float)getSampleRate();
+    const float invNum = 1.0f / (float)num;
+    const int delayBufferSize = delayBuffer.getNumSamples();
+    const int itdBufferSize = itdBuffer.getNumSamples();
+
+    // 1. Move every smoother to the end of this sub-block (values at the start are kept for ramps)
+    float motionStart = smoothMotion;
+    smoothMotion = advanceOnePole(smoothMotion, targetMotion, motionCoeff, num);
+    smoothHue = advanceOnePole(smoothHue, targetHue, hueCoeff, num);
+    smoothPan = advanceOnePole(smoothPan, targetPan, panCoeff, num);
+
+    float dynamicStart = dynamicSmoothed.getCurrentValue();
+    float dynamicAmt = dynamicSmoothed.skip(num);
+    float hueAmt = hueAmtSmoothed.skip(num);
+    float panAmt = panAmtSmoothed.skip(num);
+
+    float wetStart = dryWetSmoothed.getCurrentValue();
+    float wetEnd = dryWetSmoothed.skip(num);
+    float gainStart = outGainSmoothed.getCurrentValue();
+    float gainEnd = outGainSmoothed.skip(num);
+
+    bool processing = manipOn && (dynamicAmt > 0.01f || hueAmt > 0.01f || panAmt > 0.01f);
+
+    // 2. Per-sub-block coefficients (trig and pow calls hoisted out of the sample loop)
+    float driveStart = 1.0f + (motionStart * dynamicStart * 40.0f);
+    float driveEnd = 1.0f + (smoothMotion * dynamicAmt * 40.0f);
+    float crushRes = std::pow(2.0f, 2.0f + (1.0f - smoothMotion) * 10.0f);
+
+    float cutoffFreq = 80.0f + (smoothHue * 7920.0f);
+    float damp = 1.0f / (0.5f + (hueAmt * 4.0f));
+    float f = juce::jlimit(0.0f, 1.0f, 2.0f * std::sin(juce::MathConstants<float>::pi * cutoffFreq / sampleRate));
+
+    float panAngle = (smoothPan - 0.5f) * panAmt * juce::MathConstants<float>::pi;
+    float maxItdSamples = 0.00075f * sampleRate;
+
+    // MULTI-CHANNEL LOOP
+    for (int channel = 0; channel < numChannels; ++channel) {
+        float* data = buffer.getWritePointer(channel, start);
+
+        // Even channels (0, 2, 4) act as Left Ear, Odd channels (1, 3, 5) act as Right Ear
+        float shadowAngle = (channel % 2 == 0) ? panAngle : -panAngle; 
+        float penalty = juce::jmax(0.0f, shadowAngle); 
+        float ildGain = std::cos(penalty);
+        float shadowCutoff = 1.0f - juce::jmin(0.9f, penalty * 0.7f);
+        int itdDelaySamples = (int)((penalty / juce::MathConstants<float>::halfPi) * maxItdSamples);
+        auto* itdData = itdBuffer.getWritePointer(channel);
+
+        for (int i = 0; i < num; ++i) {
+            float t = (float)(i + 1) * invNum;
+            float cleanSig = data[i];
             float drySig = cleanSig; 
 
-            if (manipOn && (dynamicAmt > 0.01f || hueAmt > 0.01f || panAmt > 0.01f)) {
+            if (processing) {
                 
                 // A. SATURATION
                 if (dynamicAmt > 0.01f) {
-                    float pushedSig = cleanSig * drive;
+                    float pushedSig = cleanSig * (driveStart + (driveEnd - driveStart) * t);
                     switch (satType) {
                         case 0: cleanSig = std::sin(pushedSig) * 0.7f; break;
                         case 1: cleanSig = std::tanh(pushedSig) * 0.8f; break;
                         case 2: cleanSig = juce::jlimit(-0.8f, 0.8f, pushedSig); break;
-                        case 3: 
-                            float res = std::pow(2.0f, 2.0f + (1.0f - smoothMotion) * 10.0f);
-                            cleanSig = std::round(pushedSig * res) / res;
-                            break;
+                        case 3: cleanSig = std::round(pushedSig * crushRes) / crushRes; break;
                     }
                 }
 
                 // B. SYNESTHESIA FILTER (Color = Frequency Cutoff)
                 if (hueAmt > 0.01f) {
-                    float cutoffFreq = 80.0f + (smoothHue * 7920.0f);
-                    float q = 0.5f + (hueAmt * 4.0f); 
-                    float damp = 1.0f / q;
-                    
-                    float f = 2.0f * std::sin(juce::MathConstants<float>::pi * cutoffFreq / getSampleRate());
-                    f = juce::jlimit(0.0f, 1.0f, f);
-
                     svfHp[channel] = cleanSig - (damp * svfBp[channel]) - svfLp[channel];
                     svfBp[channel] += f * svfHp[channel];
                     svfLp[channel] += f * svfBp[channel];
@@ -228,62 +735,33 @@ void SquabDanceAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
 
                 // C. MULTI-CHANNEL 3D PANNING
                 if (panAmt > 0.01f) {
-                    // Even channels (0, 2, 4) act as Left Ear, Odd channels (1, 3, 5) act as Right Ear
-                    float shadowAngle = (channel % 2 == 0) ? panAngle : -panAngle; 
-                    float penalty = juce::jmax(0.0f, shadowAngle); 
-                    float ildGain = std::cos(penalty);
                     cleanSig *= ildGain;
 
-                    float shadowCutoff = 1.0f - juce::jmin(0.9f, penalty * 0.7f);
                     lpfState[channel] = (cleanSig * shadowCutoff) + (lpfState[channel] * (1.0f - shadowCutoff));
                     cleanSig = lpfState[channel];
 
-                    int itdDelaySamples = (int)((penalty / juce::MathConstants<float>::halfPi) * maxItdSamples);
-                    auto* itdData = itdBuffer.getWritePointer(channel);
-                    itdData[itdWritePosition] = cleanSig;
+                    int writePos = (itdWritePosition + i) % itdBufferSize;
+                    itdData[writePos] = cleanSig;
                     
-                    int readPos = itdWritePosition - itdDelaySamples;
+                    int readPos = writePos - itdDelaySamples;
                     while (readPos < 0) readPos += itdBufferSize;
                     cleanSig = itdData[readPos];
                 }
             }
 
-            cleanSig = (drySig * (1.0f - dryWet)) + (cleanSig * dryWet);
-            cleanSig *= outGainAmt;
-
-            if (channel == 0) peakL = juce::jmax(peakL, std::abs(cleanSig));
-            if (channel == 1) peakR = juce::jmax(peakR, std::abs(cleanSig));
-
-            buffer.getWritePointer(channel)[sample] = cleanSig;
-        }
-        
-        // Advance the timelines
-        if (manipOn) {
-            if (hueAmt > 0.01f) {
-                delayWritePosition++;
-                if (delayWritePosition >= delayBufferSize) delayWritePosition = 0;
-            }
-            if (panAmt > 0.01f) {
-                itdWritePosition++;
-                if (itdWritePosition >= itdBufferSize) itdWritePosition = 0;
-            }
+            float wet = wetStart + (wetEnd - wetStart) * t;
+            float gain = gainStart + (gainEnd - gainStart) * t;
+            data[i] = ((drySig * (1.0f - wet)) + (cleanSig * wet)) * gain;
         }
     }
-
-    if (!manipOn) {
-        delayBuffer.clear(); 
-        itdBuffer.clear();
+    
+    // 3. Advance the timelines
+    if (manipOn) {
+        if (hueAmt > 0.01f) delayWritePosition = (delayWritePosition + num) % delayBufferSize;
+        if (panAmt > 0.01f) itdWritePosition = (itdWritePosition + num) % itdBufferSize;
     }
-
-    // Push the final peaks to the UI thread
-    outputLevelL.store(peakL, std::memory_order_relaxed);
-    outputLevelR.store(peakR, std::memory_order_relaxed);
-
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
 }
 
-
 bool SquabDanceAudioProcessor::hasEditor() const { return true; }
 
 juce::AudioProcessorEditor* SquabDanceAudioProcessor::createEditor()
@@ -293,8 +771,22 @@ juce::AudioProcessorEditor* SquabDanceAudioProcessor::createEditor()
 
 void SquabDanceAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Save state
+    // Save state (the selection and program aren't parameters, so they ride along as properties)
     auto state = apvts.copyState();
+    state.setProperty("category", selectedCategory.load(), nullptr);
+    state.setProperty("animation", selectedAnimation.load(), nullptr);
+    state.setProperty("program", currentProgram.load(), nullptr);
+
+    // A program picked by MIDI with no editor open to apply it: save what is actually playing
+    if (auto* look = pendingLook.load(std::memory_order_acquire)) {
+        for (int slot = 0; slot < PresetBank::numSlots; ++slot) {
+            auto param = state.getChildWithProperty("id", PresetBank::getParameterID(slot));
+            if (param.isValid()) param.setProperty("value", look->values[(size_t)slot], nullptr);
+        }
+        state.setProperty("category", look->category, nullptr);
+        state.setProperty("animation", look->animation, nullptr);
+    }
+
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
 }
@@ -304,8 +796,26 @@ void SquabDanceAudioProcessor::setStateInformation (const void* data, int sizeIn
     // Load state
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName (apvts.state.getType()))
+        if (xmlState->hasTagName (apvts.state.getType())) {
+            // A program still waiting to be applied would overwrite what we restore
+            pendingLook.store(nullptr);
             apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+            // The selection drives the offline export too, so a session saved against a bigger
+            // sprite database must not restore an index that no longer exists
+            auto db = SpriteDatabase::getDatabase();
+            int category = (int)apvts.state.getProperty("category", selectedCategory.load());
+            int animation = (int)apvts.state.getProperty("animation", selectedAnimation.load());
+            if (!db.empty()) {
+                category = juce::jlimit(0, (int)db.size() - 1, category);
+                animation = juce::jlimit(0, juce::jmax(0, (int)db[(size_t)category].anims.size() - 1), animation);
+            }
+            selectedCategory.store(category);
+            selectedAnimation.store(animation);
+            currentProgram.store(juce::jlimit(0, getNumPrograms() - 1, (int)apvts.state.getProperty("program", currentProgram.load())));
+            selectionSerial.fetch_add(1);
+            prepareOfflineVisuals();
+        }
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,5 +1,15 @@
 #pragma once
 #include <JuceHeader.h>
+#include "Telemetry.h"
+#include "OutputMeter.h"
+#include "BeatClock.h"
+#include "MidiAnimationQueue.h"
+#include "Tracing.h"
+#include "FrameExporter.h"
+#include "VisualTimeline.h"
+#include "SpectralAnalyser.h"
+#include "OnsetDetector.h"
+#include "PresetBank.h"
 
 class SquabDanceAudioProcessor : public juce::AudioProcessor
 {
@@ -9,6 +19,7 @@ public:
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void setNonRealtime (bool isNonRealtime) noexcept override;
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
@@ -32,23 +43,127 @@ public:
     // This handles your parameters (Mirror, X, Y, Sync)
     juce::AudioProcessorValueTreeState apvts;
 
-    // NEW PLAYHEAD VARIABLES ---
-    std::atomic<double> currentBpm { 120.0 };
-    std::atomic<double> currentPpq { 0.0 };
-    std::atomic<bool> isPlaying { false };
-    std::atomic<float> currentAudioLevel { 0.0f };
+    // --- AUDIO -> UI TELEMETRY ---
+    // Playhead, envelope and output levels are published together, one record per block.
+    TelemetryRing telemetry;
 
-    // OUTPUT METER LEVELS ---
-    std::atomic<float> outputLevelL { 0.0f };
-    std::atomic<float> outputLevelR { 0.0f };
+    // --- INPUT SPECTRUM FOR THE SPRITE REACTIVITY ---
+    // Analysed off the audio thread; the editor reads the latest features each tick.
+    SpectralAnalyser spectrum;
+
+    // --- SAMPLE-ACCURATE PLAYHEAD ---
+    // Read by the sprite renderer at every vblank and extrapolated to the audible position.
+    BeatClock beatClock;
+
+    // --- MIDI NOTES / CCs FOR THE RENDERER ---
+    AnimationEventQueue animationEvents;
+
+    // Audio device output latency, filled in by the wrapper side when it is known (Standalone)
+    std::atomic<int> deviceOutputLatencySamples { 0 };
 
     // --- VISUAL ANALYSIS SENSORS ---
     std::atomic<float> visualMotion { 0.0f }; // 0.0 to 1.0
     std::atomic<float> visualHue { 0.0f };    // 0.0 to 1.0
     std::atomic<float> visualPan { 0.5f };    // 0.0 to 1.0
+    std::atomic<int> visualQuality { 0 };     // Render quality level, 0 = full
+
+    // --- SELECTED CHARACTER AND MOVE ---
+    // Not parameters: saved as state properties, set by the editor and by program changes
+    std::atomic<int> selectedCategory { 10 };
+    std::atomic<int> selectedAnimation { 0 };
+
+    // Bumped on the message thread when the selection changes under the editor (a program was
+    // applied or a state restored), so it re-reads the two values above
+    std::atomic<int> selectionSerial { 0 };
+
+    // Builds the offline visual timelines the selection and the programs need, so processBlock
+    // never decodes anything (no-op while realtime). Call from any non-audio thread after
+    // changing the selection.
+    void prepareOfflineVisuals();
+
+    juce::String getExportStatus() const { return exporter.describe(); }
+
+    // --- SPRITE EFFECTS (fx_* parameters) ---
+    SpriteStyle getSpriteStyle() const { return makeSpriteStyle(nullptr); }
+
+    // Look for a program (nullptr if out of range); used to prewarm its sheets
+    const PresetBank::Look* getProgramLook(int index) const {
+        return juce::isPositiveAndBelow(index, (int)presets.size()) ? &presets[(size_t)index] : nullptr;
+    }
+
+    // Copies a program picked on the audio thread (MIDI program change) into the parameters and
+    // the selection. Never call on the audio thread; the editor calls it every tick.
+    void applyPendingLook();
 
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    // --- PRESET BANK ---
+    // Switching is two steps. Whoever picks a program (host, MIDI program change) publishes its
+    // look in pendingLook; from the next block on the audio thread reads every preset parameter
+    // from that snapshot instead of the parameters. The message thread then copies the look into
+    // the parameters and the selection, and clears pendingLook. Either way a block sees all of
+    // one look, never half of one. The audio thread only stores the pointer (posting a message
+    // from there can lock or allocate) and the editor's tick applies it; setCurrentProgram
+    // applies its own program straight away. Without an editor a MIDI-picked look just stays
+    // pending: the audio keeps reading it, and getStateInformation saves it.
+    void selectProgram(int index);
+
+    static float readParameter(const PresetBank::Look* look, PresetBank::Slot slot, const std::atomic<float>* param) {
+        return look != nullptr ? look->values[(size_t)slot] : param->load(std::memory_order_relaxed);
+    }
+
+    SpriteStyle makeSpriteStyle(const PresetBank::Look* look) const {
+        SpriteStyle style;
+        style.outline = readParameter(look, PresetBank::fxOutline, dancerParams.fxOutline) > 0.5f;
+        style.pixelSize = (int)readParameter(look, PresetBank::fxPixelate, dancerParams.fxPixelate);
+        style.posterizeLevels = (int)readParameter(look, PresetBank::fxPosterize, dancerParams.fxPosterize);
+        style.glowMode = (int)readParameter(look, PresetBank::glowMode, dancerParams.glowMode);
+        style.glowRadius = (int)readParameter(look, PresetBank::glowSize, dancerParams.glowSize);
+        return style;
+    }
+
+    std::vector<PresetBank::Look> presets;                    // Built in the constructor, never changed
+    std::atomic<const PresetBank::Look*> pendingLook { nullptr };
+    std::atomic<int> currentProgram { 0 };
+    const PresetBank::Look* blockLook = nullptr;              // pendingLook as of this block (audio thread)
+
+    // One slice of the DSP chain with a single set of per-sub-block coefficients
+    void processSubBlock(juce::AudioBuffer<float>& buffer, int start, int num, int numChannels,
+                         bool manipOn, int satType, float targetMotion, float targetHue, float targetPan);
+
+    // Runs the deterministic export frame clock over one offline block
+    void processExportFrames(const juce::MidiBuffer& midiMessages, const TelemetryFrame& frame);
+    void applyExportMidiEvent(const juce::MidiMessageMetadata& metadata);
+
+    // --- CACHED PARAMETER POINTERS (resolved once in the constructor) ---
+    std::atomic<float>* manipParam = nullptr;
+    std::atomic<float>* dynamicParam = nullptr;
+    std::atomic<float>* hueAmtParam = nullptr;
+    std::atomic<float>* panAmtParam = nullptr;
+    std::atomic<float>* satTypeParam = nullptr;
+    std::atomic<float>* dryWetParam = nullptr;
+    std::atomic<float>* outGainParam = nullptr;
+
+    // --- SAMPLE-RATE-CORRECT SMOOTHING ---
+    static constexpr double parameterRampMs = 20.0;
+    static constexpr double motionSmoothingMs = 2.27;   // Same feel as the old 0.01/sample at 44.1 kHz
+    static constexpr double colourSmoothingMs = 11.3;   // Same feel as the old 0.002/sample at 44.1 kHz
+    static constexpr int subBlockSize = 32;
+    static constexpr float settledThreshold = 1.0e-4f;
+
+    static float onePoleCoefficient(double timeMs, double sampleRate) {
+        return (float)(1.0 - std::exp(-1000.0 / (timeMs * sampleRate)));
+    }
+
+    // Closed form of n one-pole steps towards a fixed target
+    static float advanceOnePole(float state, float target, float coeff, int numSteps) {
+        return target + (state - target) * std::pow(1.0f - coeff, (float)numSteps);
+    }
+
+    juce::SmoothedValue<float> dynamicSmoothed, hueAmtSmoothed, panAmtSmoothed;
+    juce::SmoothedValue<float> dryWetSmoothed, outGainSmoothed;
+    float motionCoeff = 0.01f, hueCoeff = 0.002f, panCoeff = 0.002f;
     
     // --- NEW: FLANGER / DELAY MEMORY ---
     juce::AudioBuffer<float> delayBuffer;
@@ -65,9 +180,74 @@ private:
     std::vector<float> svfBp;
 
 
+    // --- OUTPUT METERING (true peak / LUFS / RMS) ---
+    OutputMeter outputMeter;
+
+    // Offline the analysis runs inline in processBlock; the export clock reads it from here
+    SpectralFeatures offlineSpectrum;
+
+    // --- ONSET-DRIVEN TRANSPORT ---
+    // Stands in for the host transport when there is none (Standalone, hosts without a playhead)
+    OnsetDetector onsetDetector;
+    OnsetBeatClock onsetClock;
+    juce::int64 fallbackSamplePosition = 0;
+
     float smoothMotion = 0.0f;
     float smoothHue = 0.0f;
     float smoothPan = 0.5f;
 
+    // Dancer and export parameters the processor itself needs for offline rendering
+    struct DancerParams {
+        std::atomic<float>* exportMode = nullptr;
+        std::atomic<float>* exportFps = nullptr;
+        std::atomic<float>* exportResolution = nullptr;
+        std::atomic<float>* mirror = nullptr;
+        std::atomic<float>* scale = nullptr;
+        std::atomic<float>* speed = nullptr;
+        std::atomic<float>* syncMode = nullptr;
+        std::atomic<float>* syncRate = nullptr;
+        std::atomic<float>* reactOn = nullptr;
+        std::atomic<float>* reactIntensity = nullptr;
+        std::atomic<float>* reactColor = nullptr;
+        std::atomic<float>* reactPump = nullptr;
+        std::atomic<float>* fxOutline = nullptr;
+        std::atomic<float>* fxPixelate = nullptr;
+        std::atomic<float>* fxPosterize = nullptr;
+        std::atomic<float>* glowMode = nullptr;
+        std::atomic<float>* glowSize = nullptr;
+    } dancerParams;
+
+    // --- OFFLINE VISUAL MODEL ---
+    // Offline the DSP follows the selected animation's precomputed timeline at the playhead
+    // instead of the live dancer, so bounces (and SquabDanceBatch) are reproducible.
+    // Timelines are built off the audio thread and published per (category, row) slot. A slot goes
+    // from null to its timeline once and never changes after that, so the audio thread only does
+    // an atomic load and nothing it reads is ever freed under it.
+    const VisualSample& getOfflineVisuals(const TelemetryFrame& frame);
+    int getOfflineTimelineSlot(int category, int row) const;
+    void buildOfflineTimeline(int category, int row);
+
+    std::vector<int> offlineTimelineFirstSlot;    // Per category; fixed in the constructor
+    int numOfflineTimelineSlots = 0;
+    std::unique_ptr<std::atomic<const VisualTimeline*>[]> offlineTimelines;
+    std::vector<std::unique_ptr<VisualTimeline>> offlineTimelineStore;   // Owns what the slots point at
+    juce::CriticalSection offlineTimelineLock;    // Builders only, never taken on the audio thread
+
+    // --- OFFLINE FRAME EXPORT ---
+    // Frame k of a bounce sits at sample exportStartSample + k * sampleRate / fps. Everything a
+    // frame shows is derived from the audio, the playhead and the parameters at that sample, so
+    // repeated bounces submit identical jobs. The exporter (threads, encoder process) is started
+    // by startExport when the processor goes offline; processBlock only submits frames to it.
+    void startExport();
+
+    FrameExporter exporter;
+    std::vector<AnimationDef> exportAnims;
+    double exportFps = 30.0;
+    bool exportClockStarted = false;               // Set by the first offline block
+    juce::int64 exportStartSample = 0, exportNextBlockSample = 0, exportFrameIndex = 0;
+    double exportHzPhase = 0.0;
+    float exportPump = 0.0f, exportMidiPump = 0.0f, exportHueShift = 0.0f, exportScaleBoost = 0.0f;
+    int exportMidiRow = -1;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SquabDanceAudioProcessor)
 };
\ No newline at end of file
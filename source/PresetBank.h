@@ -0,0 +1,87 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+// --- PRESET BANK ---
+// The host-visible programs: whole "looks" (character, move, scale, reactivity, effects and the
+// DSP chain) for flipping between on a MIDI program change during a show. A look is an immutable
+// snapshot of plain parameter values, built once; switching publishes a pointer to one, so the
+// audio thread and the editor each pick up all of it at once instead of parameter by parameter.
+struct PresetBank
+{
+    // The parameters a look sets; everything else (offsets, crowd, export, sharing) is left alone
+    enum Slot
+    {
+        scale, speed, tween, mirror, syncMode, syncRate,
+        reactOn, reactIntensity, reactColor, reactPump,
+        fxOutline, fxPixelate, fxPosterize, glowMode, glowSize,
+        manipOn, manipDynamic, manipHue, manipPan, satType, dryWet, outGain,
+        numSlots
+    };
+
+    static const char* getParameterID(int slot) {
+        static constexpr const char* ids[numSlots] = {
+            "scale", "speed", "tween", "mirror", "sync_mode", "sync_rate",
+            "audio_react", "react_intensity", "react_color", "react_pump",
+            "fx_outline", "fx_pixelate", "fx_posterize", "glow_mode", "glow_size",
+            "audio_manip", "manip_dynamic", "manip_hue", "manip_pan", "sat_type", "dry_wet", "out_gain"
+        };
+        return ids[slot];
+    }
+
+    struct Look
+    {
+        juce::String name;
+        int category = 10, animation = 0;
+        std::array<float, numSlots> values {};   // Plain (not normalised) parameter values
+    };
+
+    // Programs whose sheets are decoded ahead of time, after the current one
+    static constexpr int prewarmAhead = 3;
+
+    // Every look starts from the parameter defaults and changes only what makes it distinct
+    static std::vector<Look> createFactoryBank(juce::AudioProcessorValueTreeState& apvts) {
+        Look defaults;
+        for (int slot = 0; slot < numSlots; ++slot)
+            if (auto* param = apvts.getParameter(getParameterID(slot)))
+                defaults.values[(size_t)slot] = param->convertFrom0to1(param->getDefaultValue());
+
+        struct Entry
+        {
+            const char* name;
+            int category, animation;
+            std::vector<std::pair<Slot, float>> changes;
+        };
+
+        // Categories and moves index SpriteDatabase; sync_rate 11 = 1/8, 14 = 1/4, 18 = 1/2
+        const Entry entries[] = {
+            { "Fruity Chan",        10, 0, {} },
+            { "Maxwell Rock",        0, 1, { { syncMode, 1 }, { syncRate, 14 }, { reactOn, 1 }, { reactIntensity, 40 } } },
+            { "Party Dog Pump",      1, 8, { { syncMode, 1 }, { syncRate, 11 }, { reactOn, 1 }, { reactPump, 60 } } },
+            { "Pepe Jam",            2, 1, { { fxPixelate, 3 }, { reactOn, 1 }, { reactColor, 50 } } },
+            { "Nyan Glow",           4, 0, { { speed, 12 }, { tween, 1 }, { glowMode, 1 }, { glowSize, 10 }, { reactOn, 1 }, { reactIntensity, 60 } } },
+            { "8-Bit Link",          5, 2, { { fxPixelate, 4 }, { fxPosterize, 6 }, { scale, 150 } } },
+            { "Hadouken",            6, 0, { { fxOutline, 1 }, { syncMode, 1 }, { syncRate, 14 } } },
+            { "Twice Stage",         7, 1, { { mirror, 1 }, { glowMode, 2 }, { reactOn, 1 }, { reactPump, 40 } } },
+            { "Haruhi",              8, 5, { { syncMode, 1 }, { syncRate, 11 }, { reactOn, 1 }, { reactColor, 70 } } },
+            { "Chika Filter",        9, 1, { { manipOn, 1 }, { manipHue, 60 }, { reactOn, 1 }, { reactIntensity, 50 } } },
+            { "Fruity Hula",        10, 5, { { speed, 6 }, { tween, 2 }, { mirror, 1 } } },
+            { "Burnout Drive",      11, 5, { { manipOn, 1 }, { manipDynamic, 50 }, { satType, 1 }, { dryWet, 70 } } },
+            { "Leek Spin",          12, 9, { { speed, 10 }, { tween, 1 }, { glowMode, 1 } } },
+            { "Snoop Bounce",       12, 0, { { syncMode, 1 }, { syncRate, 18 }, { reactOn, 1 }, { reactPump, 80 }, { scale, 120 } } },
+            { "Polish Cow Poster",   3, 4, { { fxPosterize, 4 }, { fxOutline, 1 }, { manipOn, 1 }, { manipPan, 60 } } },
+            { "Vaporwave Crush",     3, 0, { { manipOn, 1 }, { manipDynamic, 70 }, { satType, 3 }, { reactOn, 1 }, { reactColor, 80 }, { fxPosterize, 8 } } },
+        };
+
+        std::vector<Look> bank;
+        for (const auto& entry : entries) {
+            auto look = defaults;
+            look.name = entry.name;
+            look.category = entry.category;
+            look.animation = entry.animation;
+            for (const auto& change : entry.changes) look.values[(size_t)change.first] = change.second;
+            bank.push_back(look);
+        }
+        return bank;
+    }
+};
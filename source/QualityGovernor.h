@@ -0,0 +1,90 @@
+#pragma once
+#include <JuceHeader.h>
+
+// --- FRAME-TIME QUALITY GOVERNOR ---
+// SpriteContent reports how long each paint took; when the smoothed paint time runs over the
+// budget the governor steps down one quality level at a time, and steps back up only after a
+// long stretch well under budget (separate thresholds + dwell times = no oscillation).
+// Levels are cumulative: each one keeps every saving of the levels above it.
+class QualityGovernor
+{
+public:
+    enum Level
+    {
+        full = 0,
+        coarseMotionScan,   // Motion sensor samples every 8th pixel instead of every 4th
+        alternateGrade,     // Hue engine re-grades an unchanged frame only every other paint
+        cachedReflection,   // Reflection is rebuilt only when the sprite frame changes
+        lowInterpolation,   // Low resampling quality for the scaled draw
+        reducedFrameRate,   // Animation repaints capped at 20 fps
+        numLevels
+    };
+
+    static const char* getLevelName(int level) {
+        switch (level) {
+            case full:             return "Full";
+            case coarseMotionScan: return "Coarse motion scan";
+            case alternateGrade:   return "Alternate-frame grading";
+            case cachedReflection: return "Cached reflection";
+            case lowInterpolation: return "Low interpolation";
+            case reducedFrameRate: return "Reduced frame rate";
+            default:               return "?";
+        }
+    }
+
+    // Paint budget in ms. Half a 60 Hz frame leaves the host's own UI room to breathe.
+    void setBudgetMs(double ms) { budgetMs = juce::jmax(0.5, ms); }
+    double getBudgetMs() const { return budgetMs; }
+
+    void addPaintTime(double ms) {
+        averageMs = (numSamples == 0) ? ms : averageMs + smoothing * (ms - averageMs);
+        ++numSamples;
+        ++paintsAtThisLevel;
+
+        if (averageMs > budgetMs && paintsAtThisLevel >= minPaintsBeforeStepDown && level < numLevels - 1) {
+            setLevel(level + 1);
+        } else if (averageMs < budgetMs * stepUpFraction && paintsAtThisLevel >= minPaintsBeforeStepUp && level > full) {
+            setLevel(level - 1);
+        }
+    }
+
+    int getLevel() const { return level; }
+    double getAveragePaintMs() const { return averageMs; }
+    int getNumLevelChanges() const { return numLevelChanges; }
+
+    // --- What each level means for the renderer ---
+    int getMotionScanStep() const { return level >= coarseMotionScan ? 8 : 4; }
+    bool canReuseGrade(juce::uint32 paintIndex) const { return level >= alternateGrade && (paintIndex & 1) != 0; }
+    bool useCachedReflection() const { return level >= cachedReflection; }
+
+    juce::Graphics::ResamplingQuality getResamplingQuality() const {
+        return level >= lowInterpolation ? juce::Graphics::lowResamplingQuality : juce::Graphics::mediumResamplingQuality;
+    }
+
+    double getMinPaintIntervalSeconds() const { return level >= reducedFrameRate ? 1.0 / 20.0 : 0.0; }
+
+    juce::String describe() const {
+        return juce::String("level ") + juce::String(level) + " (" + getLevelName(level) + "), paint "
+             + juce::String(averageMs, 2) + " ms avg / " + juce::String(budgetMs, 1) + " ms budget, "
+             + juce::String(numLevelChanges) + " change(s)";
+    }
+
+private:
+    void setLevel(int newLevel) {
+        level = newLevel;
+        paintsAtThisLevel = 0;
+        ++numLevelChanges;
+    }
+
+    static constexpr double smoothing = 0.1;          // EMA weight of the newest paint
+    static constexpr double stepUpFraction = 0.6;     // Step up only below 60% of budget...
+    static constexpr int minPaintsBeforeStepDown = 10; // ...react to overload within ~1/3 s
+    static constexpr int minPaintsBeforeStepUp = 90;   // ...but recover only after ~3 s of headroom
+
+    double budgetMs = 8.0;
+    double averageMs = 0.0;
+    juce::int64 numSamples = 0;
+    int paintsAtThisLevel = 0;
+    int level = full;
+    int numLevelChanges = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+// --- SHARED-MEMORY FRAME RING: LAYOUT ---
+// Shared by the plugin (writer) and external readers such as Tools/SquabFrameReader.cpp, so this
+// header must stay free of JUCE and of anything else a reader would have to link against.
+//
+//   [Header, padded to pixelOffset][slot 0 pixels][slot 1 pixels][slot 2 pixels]
+//
+// The writer fills the slot after the latest one, then bumps that slot's sequence (seqlock: odd
+// while being written), points latestSlot at it and increments publishCount. publishCount is
+// also the notification word: on Linux readers sleep on it with FUTEX_WAIT and the writer wakes
+// them with FUTEX_WAKE; elsewhere readers poll it. A reader uses the pixels in place (no copy)
+// and afterwards re-checks the slot's sequence; a changed value means the writer lapped it and
+// that frame should be dropped. With three slots the writer needs two further frames to reach
+// the slot being read (~33 ms at 60 fps).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__linux__)
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace SharedFrameFormat
+{
+    constexpr std::uint32_t magic = 0x46425153;   // "SQBF"
+    constexpr std::uint32_t version = 1;
+    constexpr std::uint32_t numSlots = 3;
+    constexpr std::size_t pixelAlignment = 4096;
+
+    // Pixel layouts a reader may see in Header::pixelFormat
+    enum PixelFormat : std::uint32_t
+    {
+        bgraPremultiplied = 1   // 8-bit B,G,R,A in memory, colour premultiplied by alpha (OBS "BGRA")
+    };
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "futex word must be a plain 32-bit int");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "counters are shared across processes");
+
+    struct SlotHeader
+    {
+        std::atomic<std::uint32_t> sequence;   // Odd while the writer is filling this slot
+        std::uint32_t reserved;
+        std::uint64_t frameCounter;            // Frame number of the picture in this slot
+        double ppq;                            // Host playhead (quarter notes) the frame shows
+        std::int64_t timestampNs;              // CLOCK_MONOTONIC when the frame was published
+    };
+
+    struct Header
+    {
+        std::uint32_t magic;            // Written last, once everything else is valid
+        std::uint32_t version;
+        std::uint32_t pixelFormat;
+        std::uint32_t slotCount;        // = numSlots
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t stride;           // Bytes per pixel row
+        std::uint32_t reserved;
+        std::uint64_t pixelOffset;      // Start of slot 0's pixels from the start of the mapping
+        std::uint64_t slotBytes;        // Pixel bytes per slot (stride * height, page aligned)
+
+        alignas(64) std::atomic<std::uint32_t> publishCount;   // Futex word, +1 per frame
+        std::atomic<std::uint32_t> latestSlot;
+        std::atomic<std::uint64_t> frameCounter;               // Frames published so far
+
+        alignas(64) SlotHeader slots[numSlots];
+    };
+
+    inline std::size_t alignUp(std::size_t bytes) { return (bytes + pixelAlignment - 1) / pixelAlignment * pixelAlignment; }
+    inline std::size_t getPixelOffset() { return alignUp(sizeof(Header)); }
+    inline std::size_t getSlotBytes(std::uint32_t width, std::uint32_t height) { return alignUp((std::size_t)width * 4 * height); }
+    inline std::size_t getMappingBytes(std::uint32_t width, std::uint32_t height) { return getPixelOffset() + numSlots * getSlotBytes(width, height); }
+
+    inline std::int64_t getMonotonicNs()
+    {
+        timespec ts {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (std::int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+
+    // Blocks until publishCount differs from lastSeen or the timeout passes
+    inline void waitForFrame(Header& header, std::uint32_t lastSeen, int timeoutMs)
+    {
+       #if defined(__linux__)
+        timespec timeout { timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000000L };
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&header.publishCount), FUTEX_WAIT, lastSeen, &timeout, nullptr, 0);
+       #else
+        // No portable cross-process futex: poll at 1 ms
+        for (int i = 0; i < timeoutMs && header.publishCount.load(std::memory_order_acquire) == lastSeen; ++i) {
+            timespec oneMs { 0, 1000000L };
+            nanosleep(&oneMs, nullptr);
+        }
+       #endif
+    }
+
+    inline void wakeReaders(Header& header)
+    {
+       #if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&header.publishCount), FUTEX_WAKE, 0x7fffffff, nullptr, nullptr, 0);
+       #else
+        (void)header;
+       #endif
+    }
+}
@@ -0,0 +1,260 @@
+#pragma once
+#include <JuceHeader.h>
+#include <optional>
+#include "Telemetry.h"
+#include "SpriteFrameRenderer.h"
+#include "Tracing.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #define SQUAB_SHARED_FRAMES 1
+ #include "SharedFrameFormat.h"
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+#else
+ #define SQUAB_SHARED_FRAMES 0
+#endif
+
+// --- SHARED-MEMORY FRAME SINK ---
+// Publishes the dancer into a POSIX shared-memory ring ("/squabdance-N") that streaming and
+// overlay tools map directly, instead of capturing the transparent window. The message thread
+// only posts the dancer's frame state (cheap, wait-free); a publisher thread renders it with
+// SpriteFrameRenderer straight into the next ring slot and wakes the readers. Layout and
+// protocol: SharedFrameFormat.h. Reference reader: Tools/SquabFrameReader.cpp.
+class SharedFramePublisher
+{
+public:
+    struct Post
+    {
+        SpriteFrameState state;
+        double ppq = 0.0;
+        juce::int64 postedTicks = 0;
+    };
+
+    SharedFramePublisher(SpriteSheetSet sheetSet, int width = 1920, int height = 1080)
+        : sheets(std::move(sheetSet)), frameWidth(width), frameHeight(height)
+    {
+       #if SQUAB_SHARED_FRAMES
+        if (openMapping()) thread = std::make_unique<PublishThread>(*this);
+       #endif
+    }
+
+    ~SharedFramePublisher() {
+        thread = nullptr;
+       #if SQUAB_SHARED_FRAMES
+        closeMapping();
+       #endif
+    }
+
+    bool isOpen() const { return thread != nullptr; }
+    juce::String getName() const { return name; }
+
+    void setSpriteData(SpriteSheetSet sheetSet) {
+        const juce::ScopedLock sl(sheetLock);
+        sheets = std::move(sheetSet);
+        glowScratch.invalidate();   // Its cache is keyed by sheet index, not by image
+        sheetsChanged = true;
+    }
+
+    // Message thread: hand over the frame to show. Unchanged frames are not re-rendered.
+    void post(const SpriteFrameState& state, double ppq) {
+        if (thread == nullptr) return;
+        latest.write({ state, ppq, juce::Time::getHighResolutionTicks() });
+        thread->notify();
+    }
+
+    // Renders and publishes one frame on the calling thread. Returns false if nothing was published.
+    bool publish(const Post& post) {
+       #if SQUAB_SHARED_FRAMES
+        if (header == nullptr) return false;
+        SQUAB_TRACE_ZONE("sharedFramePublish");
+        auto start = juce::Time::getHighResolutionTicks();
+
+        auto slot = (header->latestSlot.load(std::memory_order_relaxed) + 1) % SharedFrameFormat::numSlots;
+        auto& slotHeader = header->slots[slot];
+
+        slotHeader.sequence.fetch_add(1, std::memory_order_acq_rel);   // Odd: readers keep out
+        {
+            const juce::ScopedLock sl(sheetLock);
+            SpriteFrameRenderer::render(slotImages[(size_t)slot], sheets, post.state, frameScratch, reflectionScratch, glowScratch);
+        }
+        slotHeader.frameCounter = header->frameCounter.load(std::memory_order_relaxed) + 1;
+        slotHeader.ppq = post.ppq;
+        slotHeader.timestampNs = SharedFrameFormat::getMonotonicNs();
+        slotHeader.sequence.fetch_add(1, std::memory_order_release);   // Even: complete
+
+        header->latestSlot.store(slot, std::memory_order_release);
+        header->frameCounter.fetch_add(1, std::memory_order_release);
+        header->publishCount.fetch_add(1, std::memory_order_release);
+        SharedFrameFormat::wakeReaders(*header);
+
+        auto end = juce::Time::getHighResolutionTicks();
+        recordTiming(juce::Time::highResolutionTicksToSeconds(end - start) * 1000.0,
+                     juce::Time::highResolutionTicksToSeconds(end - post.postedTicks) * 1000.0);
+        return true;
+       #else
+        juce::ignoreUnused(post);
+        return false;
+       #endif
+    }
+
+    juce::String describe() const {
+       #if SQUAB_SHARED_FRAMES
+        if (!isOpen()) return "not open (" + lastError + ")";
+        const juce::ScopedLock sl(statsLock);
+        juce::String t;
+        t << name << ", " << frameWidth << "x" << frameHeight << " BGRA, " << numPublished << " frame(s)\n"
+          << "publish " << juce::String(averagePublishMs, 2) << " ms avg, post->visible " << juce::String(averageLatencyMs, 2)
+          << " ms avg / " << juce::String(maxLatencyMs, 2) << " ms max";
+        return t;
+       #else
+        return "not supported on this platform";
+       #endif
+    }
+
+private:
+    // Runs the renderer on the posted state; the triple buffer means only the newest post matters
+    class PublishThread : public juce::Thread
+    {
+    public:
+        explicit PublishThread(SharedFramePublisher& o) : juce::Thread("Squab Frame Share"), owner(o) { startThread(); }
+        ~PublishThread() override { stopThread(1000); }
+
+        void run() override {
+            SQUAB_TRACE_THREAD("FrameShare");
+            while (!threadShouldExit()) {
+                Post post;
+                if (owner.latest.read(post) && !owner.isAlreadyPublished(post.state))
+                    owner.publish(post);
+                wait(100);
+            }
+        }
+
+    private:
+        SharedFramePublisher& owner;
+    };
+
+    bool isAlreadyPublished(const SpriteFrameState& state) {
+        if (!sheetsChanged.exchange(false) && lastPublished.has_value() && *lastPublished == state) return true;
+        lastPublished = state;
+        return false;
+    }
+
+    void recordTiming(double publishMs, double latencyMs) {
+        const juce::ScopedLock sl(statsLock);
+        averagePublishMs = (numPublished == 0) ? publishMs : averagePublishMs + 0.05 * (publishMs - averagePublishMs);
+        averageLatencyMs = (numPublished == 0) ? latencyMs : averageLatencyMs + 0.05 * (latencyMs - averageLatencyMs);
+        maxLatencyMs = juce::jmax(maxLatencyMs, latencyMs);
+        ++numPublished;
+    }
+
+   #if SQUAB_SHARED_FRAMES
+    // First free "/squabdance-N", so every instance in every host gets its own ring
+    bool openMapping() {
+        using namespace SharedFrameFormat;
+        mappingBytes = getMappingBytes((std::uint32_t)frameWidth, (std::uint32_t)frameHeight);
+
+        for (int i = 0; i < 64 && fd < 0; ++i) {
+            name = "/squabdance-" + juce::String(i);
+            fd = shm_open(name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+
+        if (fd < 0) { lastError = "shm_open failed"; return false; }
+
+        if (ftruncate(fd, (off_t)mappingBytes) != 0) { lastError = "ftruncate failed"; closeMapping(); return false; }
+
+        mapping = mmap(nullptr, mappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) { mapping = nullptr; lastError = "mmap failed"; closeMapping(); return false; }
+
+        header = new (mapping) Header();
+        header->version = version;
+        header->pixelFormat = bgraPremultiplied;
+        header->slotCount = numSlots;
+        header->width = (std::uint32_t)frameWidth;
+        header->height = (std::uint32_t)frameHeight;
+        header->stride = (std::uint32_t)frameWidth * 4;
+        header->pixelOffset = getPixelOffset();
+        header->slotBytes = getSlotBytes(header->width, header->height);
+
+        // Each slot is wrapped as a juce::Image, so the renderer draws straight into shared memory
+        for (std::uint32_t i = 0; i < numSlots; ++i) {
+            auto* pixels = static_cast<juce::uint8*>(mapping) + header->pixelOffset + i * header->slotBytes;
+            slotImages.push_back(juce::Image(new MappedPixelData(pixels, frameWidth, frameHeight)));
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = magic;
+        return true;
+    }
+
+    void closeMapping() {
+        slotImages.clear();
+        if (mapping != nullptr) munmap(mapping, mappingBytes);
+        if (fd >= 0) { close(fd); shm_unlink(name.toRawUTF8()); }
+        mapping = nullptr;
+        header = nullptr;
+        fd = -1;
+    }
+
+    // A juce::Image whose pixels live in the mapping (BGRA premultiplied = juce's ARGB on little-endian)
+    class MappedPixelData : public juce::ImagePixelData
+    {
+    public:
+        MappedPixelData(juce::uint8* data, int w, int h) : ImagePixelData(juce::Image::ARGB, w, h), pixels(data) {}
+
+        std::unique_ptr<juce::LowLevelGraphicsContext> createLowLevelContext() override {
+            sendDataChangeMessage();
+            return std::make_unique<juce::LowLevelGraphicsSoftwareRenderer>(juce::Image(this));
+        }
+
+        void initialiseBitmapData(juce::Image::BitmapData& bitmap, int x, int y, juce::Image::BitmapData::ReadWriteMode mode) override {
+            bitmap.pixelFormat = pixelFormat;
+            bitmap.pixelStride = 4;
+            bitmap.lineStride = width * 4;
+            bitmap.width = width - x;
+            bitmap.height = height - y;
+            bitmap.data = pixels + (size_t)y * (size_t)bitmap.lineStride + (size_t)x * 4;
+            bitmap.size = (size_t)(height - y) * (size_t)bitmap.lineStride - (size_t)x * 4;
+            if (mode != juce::Image::BitmapData::readOnly) sendDataChangeMessage();
+        }
+
+        juce::ImagePixelData::Ptr clone() override {
+            auto copy = juce::Image(juce::Image::ARGB, width, height, false, juce::SoftwareImageType());
+            juce::Image::BitmapData src(juce::Image(this), juce::Image::BitmapData::readOnly);
+            juce::Image::BitmapData dest(copy, juce::Image::BitmapData::writeOnly);
+            for (int y = 0; y < height; ++y) std::memcpy(dest.getLinePointer(y), src.getLinePointer(y), (size_t)width * 4);
+            return copy.getPixelData();
+        }
+
+        std::unique_ptr<juce::ImageType> createType() const override { return std::make_unique<juce::SoftwareImageType>(); }
+
+    private:
+        juce::uint8* pixels;
+    };
+
+    int fd = -1;
+    void* mapping = nullptr;
+    size_t mappingBytes = 0;
+    SharedFrameFormat::Header* header = nullptr;
+   #endif
+
+    juce::CriticalSection sheetLock;
+    SpriteSheetSet sheets;
+    const int frameWidth, frameHeight;
+    std::vector<juce::Image> slotImages;
+    juce::Image frameScratch { SpriteFrameRenderer::createScratchImage() };
+    juce::Image reflectionScratch { SpriteFrameRenderer::createScratchImage() };
+    SpriteGlow glowScratch;
+
+    TripleBuffer<Post> latest;
+    std::optional<SpriteFrameState> lastPublished;   // Publisher thread only
+    std::atomic<bool> sheetsChanged { false };
+    std::unique_ptr<PublishThread> thread;
+
+    juce::String name, lastError;
+    mutable juce::CriticalSection statsLock;
+    juce::int64 numPublished = 0;
+    double averagePublishMs = 0.0, averageLatencyMs = 0.0, maxLatencyMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedFramePublisher)
+};
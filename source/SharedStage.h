@@ -0,0 +1,161 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpriteWindow.h"
+
+// --- SHARED STAGE ---
+// Opt-in ("shared_stage"): instead of one 960x2280 layered window per instance, every instance
+// in the host process puts its dancer on a single transparent overlay. The OS composites one
+// window, one VBlankAttachment ticks every dancer, and all of them are painted in the same
+// paint pass of that window. Held through juce::SharedResourcePointer by the editors; the window
+// exists only while at least one dancer is on it, and always hugs the union of the dancers'
+// bounds (X11 has no click-through for transparent pixels, so a desktop-sized window would eat
+// every click on the host).
+class SharedStage
+{
+public:
+    SharedStage() = default;
+    ~SharedStage() { window = nullptr; }
+
+    void addDancer(SpriteContent* dancer) {
+        JUCE_ASSERT_MESSAGE_THREAD
+        if (dancer == nullptr || canvas.contains(dancer)) return;
+
+        if (window == nullptr) {
+            // The first dancer opens the stage in the middle of the primary display
+            dancer->setTopLeftPosition(0, 0);
+            canvas.setSize(dancer->getWidth(), dancer->getHeight());
+            window = std::make_unique<StageWindow>(canvas);
+        } else {
+            // New dancers line up beside the ones already there
+            auto area = canvas.getLocalBounds();
+            int slot = canvas.getNumDancers();
+            int centreX = area.getCentreX() + ((slot % 2 == 0) ? 1 : -1) * ((slot + 1) / 2) * slotSpacing;
+            dancer->setTopLeftPosition(centreX - dancer->getWidth() / 2, area.getCentreY() - dancer->getHeight() / 2);
+        }
+
+        canvas.add(dancer);
+        dancer->setOnSharedStage(true);
+    }
+
+    // Leaves the stage (and takes the window down with the last dancer)
+    void removeDancer(SpriteContent* dancer) {
+        JUCE_ASSERT_MESSAGE_THREAD
+        if (dancer == nullptr || !canvas.contains(dancer)) return;
+
+        canvas.remove(dancer);
+        dancer->setOnSharedStage(false);
+
+        if (canvas.getNumDancers() == 0) window = nullptr;
+    }
+
+    int getNumDancers() const { return canvas.getNumDancers(); }
+
+private:
+    static constexpr int slotSpacing = 260;
+
+    class StageCanvas : public juce::Component
+    {
+    public:
+        StageCanvas() {
+            setOpaque(false);
+            setInterceptsMouseClicks(false, true); // Only the dancers themselves take clicks
+        }
+
+        void add(SpriteContent* dancer) {
+            dancers.add(dancer);
+            addAndMakeVisible(dancer);
+            if (vblank == nullptr) vblank = std::make_unique<juce::VBlankAttachment>(this, [this] { tick(); });
+            fitToDancers();
+        }
+
+        void remove(SpriteContent* dancer) {
+            removeChildComponent(dancer);
+            dancers.removeFirstMatchingValue(dancer);
+            if (dancers.isEmpty()) vblank = nullptr;
+            fitToDancers();
+        }
+
+        bool contains(SpriteContent* dancer) const { return dancers.contains(dancer); }
+        int getNumDancers() const { return dancers.size(); }
+
+        // Only a drawn dancer is solid; the window asks the same question
+        bool hitTest(int x, int y) override {
+            for (auto* d : dancers)
+                if (d->getBounds().contains(x, y) && d->hitTest(x - d->getX(), y - d->getY())) return true;
+            return false;
+        }
+
+        // A dancer was dragged (or resized itself)
+        void childBoundsChanged(juce::Component*) override { fitToDancers(); }
+
+    private:
+        // Shrinks or grows the canvas (and, through resize-to-fit, the window) to the union of the
+        // dancers, moving the window by as much as the dancers move so none of them jumps on screen
+        void fitToDancers() {
+            if (fitting || dancers.isEmpty()) return;
+
+            auto area = dancers.getFirst()->getBounds();
+            for (auto* d : dancers) area = area.getUnion(d->getBounds());
+            if (area == getLocalBounds()) return;
+
+            const juce::ScopedValueSetter<bool> fittingNow(fitting, true);
+            for (auto* d : dancers) d->setTopLeftPosition(d->getPosition() - area.getPosition());
+            if (auto* window = getParentComponent()) window->setTopLeftPosition(window->getPosition() + area.getPosition());
+            setSize(area.getWidth(), area.getHeight());
+        }
+
+
+        // The one frame clock for every instance
+        void tick() {
+            SQUAB_TRACE_ZONE("sharedStageTick");
+            for (auto* d : dancers) d->stageTick();
+        }
+
+        juce::Array<SpriteContent*> dancers;
+        std::unique_ptr<juce::VBlankAttachment> vblank;
+        bool fitting = false;
+    };
+
+    class StageWindow : public juce::DocumentWindow
+    {
+    public:
+        explicit StageWindow(StageCanvas& stageCanvas)
+            : DocumentWindow("Squab Stage", juce::Colours::transparentBlack, 0), canvas(stageCanvas)
+        {
+            setUsingNativeTitleBar(false); setTitleBarHeight(0); setResizable(false, false);
+            setAlwaysOnTop(true); setOpaque(false); setBackgroundColour(juce::Colours::transparentBlack);
+            setDropShadowEnabled(false);
+
+            if (auto* constrainer = getConstrainer()) constrainer->setMinimumOnscreenAmounts(0, 0, 0, 0);
+
+            // Sized by the canvas (the dancers' union), centred on the primary display to start with
+            auto area = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay() != nullptr
+                      ? juce::Desktop::getInstance().getDisplays().getPrimaryDisplay()->userArea
+                      : juce::Rectangle<int>(0, 0, 1920, 1080);
+
+            setContentNonOwned(&stageCanvas, true);
+            setCentrePosition(area.getCentre());
+            setVisible(true);
+        }
+
+        ~StageWindow() override { clearContentComponent(); }
+
+        void closeButtonPressed() override {}
+
+        // Clicks between and around the dancers go to whatever is below (where the OS allows it)
+        bool hitTest(int x, int y) override {
+            auto p = canvas.getLocalPoint(this, juce::Point<int>(x, y));
+            return canvas.hitTest(p.x, p.y);
+        }
+
+    private:
+        StageCanvas& canvas;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageWindow)
+    };
+
+    StageCanvas canvas;
+    std::unique_ptr<StageWindow> window;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedStage)
+};
@@ -0,0 +1,251 @@
+#pragma once
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+// --- SPECTRAL FEATURES FOR THE VISUALS ---
+// Everything the dancer reacts to, all 0.0 to 1.0. Each drive has its own job: bass pumps the
+// sprite, brightness (the spectral centroid) shifts its hue, flux (how much the spectrum just
+// changed, i.e. onsets) drives the saturation / brightness intensity.
+struct SpectralFeatures
+{
+    static constexpr int numBands = 8;
+
+    std::array<float, numBands> bands {};   // Roughly octave bands from 40 Hz to 16 kHz
+    float level = 0.0f;        // Broadband envelope (decides whether there is anything to react to)
+    float bass = 0.0f;         // 30 - 150 Hz
+    float brightness = 0.0f;   // Centroid on a log-frequency axis, faded out with the level
+    float flux = 0.0f;         // Positive spectral change relative to its recent peak
+};
+
+// --- OFF-THREAD SPECTRAL ANALYSER ---
+// The audio thread only copies each block into a wait-free FIFO (one copy per channel, no maths).
+// A low-priority worker drains the FIFO in fixed 512-sample hops, runs a 2048-point windowed FFT
+// per hop and publishes the features through a triple buffer. Hops and smoothing are defined in
+// samples / milliseconds, so the response no longer depends on the host's buffer size.
+//
+// Offline (bounce, SquabDanceBatch) the worker is stopped and the same hops run inline on the
+// calling thread, so every render sees the same features at the same sample.
+class SpectralAnalyser
+{
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;   // 2048: ~43 ms / 23 Hz bins at 48 kHz
+    static constexpr int hopSize = 512;
+    static constexpr int numChannels = 2;           // Analysed as a mono sum of the first two inputs
+    static constexpr int fifoCapacity = 1 << 15;    // ~0.7 s at 48 kHz
+
+    SpectralAnalyser() : fifoStorage(numChannels, fifoCapacity) {
+        history.resize((size_t)fftSize, 0.0f);
+        fftData.resize((size_t)fftSize * 2, 0.0f);
+        magnitudes.resize((size_t)fftSize / 2 + 1, 0.0f);
+        previousMagnitudes.resize((size_t)fftSize / 2 + 1, 0.0f);
+        hopBuffer.setSize(numChannels, hopSize);
+    }
+
+    ~SpectralAnalyser() { worker.stopThread(1000); }
+
+    // Message thread, with audio stopped (prepareToPlay). Resets all analysis state.
+    void prepare(double newSampleRate, bool realtime) {
+        worker.stopThread(1000);
+
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+        fifo.reset();
+        std::fill(history.begin(), history.end(), 0.0f);
+        std::fill(previousMagnitudes.begin(), previousMagnitudes.end(), 0.0f);
+        historyIndex = 0;
+        fluxPeak = minimumFluxPeak;
+        features = {};
+        published.write(features);
+
+        const double binHz = sampleRate / fftSize;
+        auto toBin = [binHz](double hz) { return juce::jlimit(1, fftSize / 2, (int)std::round(hz / binHz)); };
+        for (int band = 0; band <= SpectralFeatures::numBands; ++band)
+            bandEdges[(size_t)band] = toBin(lowestHz * std::pow(highestHz / lowestHz, (double)band / SpectralFeatures::numBands));
+        bassFirstBin = toBin(30.0);
+        bassLastBin = juce::jmax(bassFirstBin + 1, toBin(150.0));
+
+        const double hopMs = 1000.0 * hopSize / sampleRate;
+        auto coefficient = [hopMs](double timeMs) { return (float)(1.0 - std::exp(-hopMs / timeMs)); };
+        attackCoeff = coefficient(23.0);        // The old 0.4 / 0.08 per-block follower at 512 @ 44.1 kHz
+        releaseCoeff = coefficient(140.0);
+        brightnessCoeff = coefficient(80.0);
+        fluxReleaseCoeff = coefficient(150.0);
+        fluxPeakDecay = (float)std::exp(-hopMs / 2000.0);
+
+        workerWaitMs = juce::jmax(1, (int)(500.0 * hopSize / sampleRate));   // Half a hop
+        setRealtime(realtime);
+    }
+
+    void release() { worker.stopThread(1000); }
+
+    // Realtime: the worker consumes the FIFO. Offline: the caller does, through analysePending().
+    void setRealtime(bool realtime) {
+        if (realtime) worker.startThread(juce::Thread::Priority::low);
+        else worker.stopThread(1000);
+    }
+
+    // Audio thread. Mono inputs are copied to both analysis channels.
+    void push(const juce::AudioBuffer<float>& buffer, int numInputChannels) {
+        const int numSamples = buffer.getNumSamples();
+        if (numInputChannels <= 0 || numSamples <= 0) return;
+
+        if (fifo.getFreeSpace() < numSamples) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const auto scope = fifo.write(numSamples);
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const auto* source = buffer.getReadPointer(juce::jmin(channel, numInputChannels - 1));
+            if (scope.blockSize1 > 0)
+                juce::FloatVectorOperations::copy(fifoStorage.getWritePointer(channel, scope.startIndex1), source, scope.blockSize1);
+            if (scope.blockSize2 > 0)
+                juce::FloatVectorOperations::copy(fifoStorage.getWritePointer(channel, scope.startIndex2), source + scope.blockSize1, scope.blockSize2);
+        }
+    }
+
+    // Offline only: runs every complete hop pushed so far on the calling thread
+    const SpectralFeatures& analysePending() {
+        drain();
+        return features;
+    }
+
+    // Single reader (the editor timer). Returns true if a new hop was analysed since the last read.
+    bool read(SpectralFeatures& out) { return published.read(out); }
+
+    juce::uint32 getNumDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr double lowestHz = 40.0, highestHz = 16000.0;
+    static constexpr float bandFloorDb = -60.0f, bandCeilingDb = -6.0f;
+    static constexpr float minimumFluxPeak = 1.0e-3f;
+
+    class Worker : public juce::Thread
+    {
+    public:
+        explicit Worker(SpectralAnalyser& o) : juce::Thread("Squab Spectrum"), owner(o) {}
+
+        void run() override {
+            while (!threadShouldExit()) {
+                owner.drain();
+                wait(owner.workerWaitMs);
+            }
+        }
+
+    private:
+        SpectralAnalyser& owner;
+    };
+
+    // Consumer side: whole hops only, the remainder waits in the FIFO for the next call
+    void drain() {
+        while (fifo.getNumReady() >= hopSize) {
+            {
+                const auto scope = fifo.read(hopSize);
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    auto* dest = hopBuffer.getWritePointer(channel);
+                    if (scope.blockSize1 > 0)
+                        juce::FloatVectorOperations::copy(dest, fifoStorage.getReadPointer(channel, scope.startIndex1), scope.blockSize1);
+                    if (scope.blockSize2 > 0)
+                        juce::FloatVectorOperations::copy(dest + scope.blockSize1, fifoStorage.getReadPointer(channel, scope.startIndex2), scope.blockSize2);
+                }
+            }
+
+            analyseHop();
+            published.write(features);
+        }
+    }
+
+    void analyseHop() {
+        // --- TIME DOMAIN: mono sum into the sliding window, RMS of the new hop ---
+        const auto* left = hopBuffer.getReadPointer(0);
+        const auto* right = hopBuffer.getReadPointer(1);
+        float sumSquares = 0.0f;
+        for (int i = 0; i < hopSize; ++i) {
+            float mono = 0.5f * (left[i] + right[i]);
+            sumSquares += mono * mono;
+            history[(size_t)historyIndex] = mono;
+            historyIndex = (historyIndex + 1) & (fftSize - 1);
+        }
+        const float rms = std::sqrt(sumSquares / hopSize) * 10.0f;   // Same scaling as the old envelope
+
+        // --- FREQUENCY DOMAIN ---
+        for (int i = 0; i < fftSize; ++i) fftData[(size_t)i] = history[(size_t)((historyIndex + i) & (fftSize - 1))];
+        std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+        window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        // Full-scale sine -> 1.0 (the Hann window halves the coherent gain)
+        const float norm = 4.0f / fftSize;
+        const double binHz = sampleRate / fftSize;
+        float weightedSum = 0.0f, magnitudeSum = 0.0f, flux = 0.0f;
+        for (int bin = 1; bin <= fftSize / 2; ++bin) {
+            float magnitude = fftData[(size_t)bin] * norm;
+            magnitudes[(size_t)bin] = magnitude;
+            weightedSum += magnitude * (float)(bin * binHz);
+            magnitudeSum += magnitude;
+            flux += juce::jmax(0.0f, magnitude - previousMagnitudes[(size_t)bin]);
+        }
+
+        // Nothing left to react to once the input is quiet
+        const float presence = juce::jmin(1.0f, rms * 4.0f);
+
+        for (int band = 0; band < SpectralFeatures::numBands; ++band)
+            follow(features.bands[(size_t)band], bandEnergy(bandEdges[(size_t)band], bandEdges[(size_t)band + 1]));
+        follow(features.bass, bandEnergy(bassFirstBin, bassLastBin));
+        follow(features.level, juce::jmin(1.0f, rms));
+
+        float brightness = 0.0f;
+        if (magnitudeSum > 1.0e-6f) {
+            double centroid = juce::jmax(lowestHz, (double)(weightedSum / magnitudeSum));
+            brightness = (float)juce::jlimit(0.0, 1.0, std::log(centroid / lowestHz) / std::log(highestHz / lowestHz));
+        }
+        features.brightness += brightnessCoeff * (brightness * presence - features.brightness);
+
+        // Flux against its own recent peak, so it reads as "how big an onset is this" at any loudness
+        fluxPeak = juce::jmax(minimumFluxPeak, juce::jmax(flux, fluxPeak * fluxPeakDecay));
+        const float onset = juce::jmin(1.0f, flux / fluxPeak) * presence;
+        if (onset > features.flux) features.flux = onset;
+        else features.flux += fluxReleaseCoeff * (onset - features.flux);
+
+        std::swap(magnitudes, previousMagnitudes);
+    }
+
+    // RMS magnitude of this hop's bins [first, last) on a -60..-6 dB scale
+    float bandEnergy(int first, int last) const {
+        last = juce::jmax(first + 1, last);
+        float power = 0.0f;
+        for (int bin = first; bin < last && bin < (int)magnitudes.size(); ++bin)
+            power += magnitudes[(size_t)bin] * magnitudes[(size_t)bin];
+        float db = juce::Decibels::gainToDecibels(std::sqrt(power), bandFloorDb);
+        return juce::jlimit(0.0f, 1.0f, (db - bandFloorDb) / (bandCeilingDb - bandFloorDb));
+    }
+
+    // Fast attack, slow release
+    void follow(float& state, float target) const {
+        state += (target > state ? attackCoeff : releaseCoeff) * (target - state);
+    }
+
+    // --- AUDIO THREAD -> WORKER ---
+    juce::AbstractFifo fifo { fifoCapacity };
+    juce::AudioBuffer<float> fifoStorage;
+    std::atomic<juce::uint32> dropped { 0 };
+
+    // --- WORKER (or the offline caller) ONLY ---
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    juce::AudioBuffer<float> hopBuffer;
+    std::vector<float> history, fftData, magnitudes, previousMagnitudes;
+    int historyIndex = 0;
+
+    double sampleRate = 44100.0;
+    std::array<int, SpectralFeatures::numBands + 1> bandEdges {};
+    int bassFirstBin = 1, bassLastBin = 2;
+    float attackCoeff = 0.4f, releaseCoeff = 0.08f, brightnessCoeff = 0.1f, fluxReleaseCoeff = 0.07f;
+    float fluxPeak = minimumFluxPeak, fluxPeakDecay = 0.99f;
+    int workerWaitMs = 5;
+
+    SpectralFeatures features;
+    TripleBuffer<SpectralFeatures> published;
+
+    Worker worker { *this };
+};
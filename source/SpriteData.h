@@ -1,5 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
+#include "Tracing.h"
+#include "SpriteSheetCache.h"
 
 struct AnimationDef {
     juce::String name;
@@ -13,6 +15,23 @@ struct CharacterDef {
     bool isGridSprite = false;           // Engine flag
 };
 
+// --- SYNC RATES ---
+// Beat length (in quarter notes) of every "sync_rate" choice, shared by the live dancer and the
+// offline exporter so both step frames on exactly the same beats.
+struct SyncRates
+{
+    static constexpr int numRates = 21;
+
+    static double getBeatLength(int index) {
+        static constexpr double beatLengths[numRates] = {
+            4.0/2048.0, 4.0/1024.0, 4.0/512.0, 4.0/256.0, 4.0/128.0, 4.0/64.0, 4.0/48.0, 4.0/32.0,
+            4.0/24.0, 4.0/16.0, 4.0/12.0, 4.0/8.0, 4.0/6.0, 12.0/16.0, 4.0/4.0, 20.0/16.0,
+            4.0/3.0, 12.0/8.0, 4.0/2.0, 12.0/4.0, 4.0/1.0
+        };
+        return beatLengths[juce::jlimit(0, numRates - 1, index)];
+    }
+};
+
 class SpriteDatabase
 {
 public:
@@ -157,4 +176,73 @@ public:
 
         return db;
     }
+
+    // The move the dancer switches to while it is dragged: the first one named held/drag/pick,
+    // otherwise the last one. Names don't change, so callers look this up once per category.
+    static int findHeldAnimation(const CharacterDef& charDef)
+    {
+        for (int i = 0; i < (int)charDef.anims.size(); ++i) {
+            juce::String name = charDef.anims[(size_t)i].name.toLowerCase();
+            if (name.contains("held") || name.contains("drag") || name.contains("pick")) return i;
+        }
+
+        return juce::jmax(0, (int)charDef.anims.size() - 1);
+    }
+
+    // BinaryData indices of every sheet a character uses, in filename order.
+    // Shared by the editor and the headless tools so they always agree on the lookup rules.
+    static std::vector<int> findSheetResources(const CharacterDef& charDef)
+    {
+        std::vector<int> indices;
+
+        for (const auto& fname : charDef.filenames) {
+            juce::String searchTarget = fname.upToFirstOccurrenceOf(".", false, false)
+                                             .toLowerCase()
+                                             .replace("-", "");
+
+            for (int i = 0; i < BinaryData::namedResourceListSize; ++i) {
+                juce::String resName = juce::String(BinaryData::namedResourceList[i]).toLowerCase();
+
+                if (resName.contains(searchTarget.replace(" ", "_")) || resName.contains(searchTarget.replace(" ", ""))) {
+                    indices.push_back(i);
+                    break;
+                }
+            }
+        }
+
+        return indices;
+    }
+
+    // Decodes (or fetches from the shared, memory-accounted cache) every sheet of a character
+    static std::vector<juce::Image> loadSheets(const CharacterDef& charDef)
+    {
+        SQUAB_TRACE_ZONE("decodeSheets");
+        juce::SharedResourcePointer<SpriteSheetCache> cache;
+        std::vector<juce::Image> loadedImages;
+
+        for (int index : findSheetResources(charDef)) {
+            juce::Image img = cache->get(index);
+            if (img.isValid()) loadedImages.push_back(img);
+        }
+
+        return loadedImages;
+    }
+};
+
+// A character's animations and decoded sheets: everything needed to find any of its frames
+struct SpriteSheetSet
+{
+    bool isGrid = false;
+    std::vector<AnimationDef> anims;
+    std::vector<juce::Image> sheets;
+
+    static SpriteSheetSet load(const CharacterDef& charDef) {
+        SpriteSheetSet set;
+        set.isGrid = charDef.isGridSprite;
+        set.anims = charDef.anims;
+        set.sheets = SpriteDatabase::loadSheets(charDef);
+        return set;
+    }
+
+    bool isValid() const { return !sheets.empty() && !anims.empty(); }
 };
\ No newline at end of file
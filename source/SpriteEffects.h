@@ -0,0 +1,267 @@
+#pragma once
+#include <JuceHeader.h>
+#include <optional>
+#include "SpriteGrade.h"
+
+// --- SPRITE STYLE ---
+// The stylising effects on top of the colour grade, from the fx_* parameters
+struct SpriteStyle
+{
+    bool outline = false;      // 1 px outline around the sprite's silhouette
+    int pixelSize = 1;         // Pixelate block size in sprite pixels (1 = off)
+    int posterizeLevels = 0;   // Levels per colour channel (below 2 = off)
+    int glowMode = 0;          // SpriteGlow::Mode: off / glow / shadow (drawn behind, not a pipeline stage)
+    int glowRadius = 6;        // Blur radius in half-resolution pixels
+
+    bool operator==(const SpriteStyle& other) const {
+        return outline == other.outline && pixelSize == other.pixelSize && posterizeLevels == other.posterizeLevels
+            && glowMode == other.glowMode && glowRadius == other.glowRadius;
+    }
+};
+
+// --- FUSED SPRITE EFFECT PIPELINE ---
+// Every per-frame pixel effect of the dancer in one pass over the 220x256 frame: each sheet row is
+// fetched from memory once (neighbour rows for the outline are still in L1), and each output row
+// is written once. There is one kernel per combination of active effects, generated from a
+// template, so a disabled effect costs nothing inside the pixel loop.
+//
+// Per pixel the order is: pixelate (source lookup) -> analyse (motion sensor, on the raw pixel)
+// -> outline -> grade -> posterize -> frame out -> reflection out.
+class SpriteEffectPipeline
+{
+public:
+    static constexpr int frameWidth = 220;
+    static constexpr int frameHeight = 256;
+    static constexpr int reflectionFadeRows = 100;
+
+    enum Effect : unsigned
+    {
+        grade     = 1 << 0,
+        analyse   = 1 << 1,
+        reflect   = 1 << 2,
+        outline   = 1 << 3,
+        pixelate  = 1 << 4,
+        posterize = 1 << 5,
+        numCombinations = 1 << 6
+    };
+
+    static juce::String describe(unsigned effects) {
+        if (effects == 0) return "none";
+        static const char* names[] = { "grade", "analyse", "reflect", "outline", "pixelate", "posterize" };
+        juce::StringArray active;
+        for (int i = 0; i < 6; ++i)
+            if ((effects & (1u << i)) != 0) active.add(names[i]);
+        return active.joinIntoString("+");
+    }
+
+    // Effects that change the sprite's own pixels (anything else draws straight from the sheet)
+    static constexpr unsigned frameEffects = grade | outline | pixelate | posterize;
+
+    static unsigned getFrameEffects(const SpriteGrade& spriteGrade, const SpriteStyle& style) {
+        unsigned effects = 0;
+        if (!spriteGrade.isNeutral()) effects |= grade;
+        if (style.outline) effects |= outline;
+        if (style.pixelSize > 1) effects |= pixelate;
+        if (style.posterizeLevels >= 2) effects |= posterize;
+        return effects;
+    }
+
+    // What the motion sensor accumulates over one frame (see MotionSensor)
+    struct MotionScan
+    {
+        float totalX = 0.0f, totalHue = 0.0f, pixelCount = 0.0f, deltaCount = 0.0f;
+    };
+
+    struct Analysis
+    {
+        MotionScan scan;
+        juce::Image* previousFrame = nullptr;   // 220x256 ARGB; compared against, then overwritten with this frame
+        int scanStep = 4;
+    };
+
+    // Runs the given effects over the frame at (sx, sy) of sheet. frameOut is needed for frame
+    // effects, reflectionOut for reflect (only its first 100 rows are written; the rest must stay
+    // transparent), analysis for analyse. Outputs are 220x256 ARGB images.
+    static void run(unsigned effects, const juce::Image& sheet, int sx, int sy,
+                    const SpriteGrade& spriteGrade, const SpriteStyle& style,
+                    juce::Image* frameOut, juce::Image* reflectionOut, Analysis* analysis) {
+        effects &= numCombinations - 1;
+        if ((effects & frameEffects) != 0 && frameOut == nullptr) effects &= ~frameEffects;
+        if ((effects & reflect) != 0 && reflectionOut == nullptr) effects &= ~reflect;
+        if ((effects & analyse) != 0 && (analysis == nullptr || analysis->previousFrame == nullptr)) effects &= ~analyse;
+        if (effects == 0) return;
+
+        // The kernels read ARGB pixels directly (PNG sheets with alpha always are)
+        juce::Image source = sheet;
+        if (source.getFormat() != juce::Image::ARGB) source = source.convertedToFormat(juce::Image::ARGB);
+
+        juce::Image::BitmapData srcData(source, sx, sy, frameWidth, frameHeight, juce::Image::BitmapData::readOnly);
+
+        Context context;
+        context.source = &srcData;
+        context.grade = spriteGrade;
+        context.pixelSize = juce::jmax(1, style.pixelSize);
+        context.posterizeLevels = juce::jmax(2, style.posterizeLevels);
+
+        std::optional<juce::Image::BitmapData> frameData, reflectionData, previousData;
+        if ((effects & frameEffects) != 0) context.frame = &frameData.emplace(*frameOut, juce::Image::BitmapData::writeOnly);
+        if ((effects & reflect) != 0) context.reflection = &reflectionData.emplace(*reflectionOut, juce::Image::BitmapData::writeOnly);
+        if ((effects & analyse) != 0) {
+            context.previous = &previousData.emplace(*analysis->previousFrame, juce::Image::BitmapData::readWrite);
+            context.scan = &analysis->scan;
+            context.scanStep = juce::jmax(1, analysis->scanStep);
+        }
+
+        getKernels()[effects](context);
+    }
+
+private:
+    struct Context
+    {
+        const juce::Image::BitmapData* source = nullptr;
+        juce::Image::BitmapData* frame = nullptr;
+        juce::Image::BitmapData* reflection = nullptr;
+        juce::Image::BitmapData* previous = nullptr;
+        MotionScan* scan = nullptr;
+        int scanStep = 4;
+        SpriteGrade grade;
+        int pixelSize = 1;
+        int posterizeLevels = 2;
+    };
+
+    using Kernel = void (*)(const Context&);
+
+    template <size_t... Index>
+    static std::array<Kernel, sizeof...(Index)> makeKernelTable(std::index_sequence<Index...>) {
+        return { { &kernel<(unsigned)Index>... } };
+    }
+
+    static const std::array<Kernel, numCombinations>& getKernels() {
+        static const auto table = makeKernelTable(std::make_index_sequence<numCombinations>());
+        return table;
+    }
+
+    // Posterize: rounds a channel to one of n evenly spaced values
+    static juce::uint8 quantise(juce::uint8 v, float levelsMinusOne) {
+        return (juce::uint8)juce::roundToInt(std::round(v / 255.0f * levelsMinusOne) / levelsMinusOne * 255.0f);
+    }
+
+    static const juce::PixelARGB* sourceRow(const Context& c, int y) {
+        return reinterpret_cast<const juce::PixelARGB*>(c.source->getLinePointer(y));
+    }
+
+    template <unsigned Effects>
+    static void kernel(const Context& c) {
+        constexpr bool doGrade = (Effects & grade) != 0;
+        constexpr bool doAnalyse = (Effects & analyse) != 0;
+        constexpr bool doReflect = (Effects & reflect) != 0;
+        constexpr bool doOutline = (Effects & outline) != 0;
+        constexpr bool doPixelate = (Effects & pixelate) != 0;
+        constexpr bool doPosterize = (Effects & posterize) != 0;
+        constexpr bool writesFrame = (Effects & frameEffects) != 0;
+        constexpr int alphaThreshold = 50;   // Same "is this part of the sprite" test as the motion sensor
+
+        const int block = doPixelate ? c.pixelSize : 1;
+        auto snap = [block](int v) { return doPixelate ? v - v % block : v; };
+
+        const float levelsMinusOne = (float)(c.posterizeLevels - 1);
+
+        for (int y = 0; y < frameHeight; ++y) {
+            const juce::PixelARGB* row = sourceRow(c, snap(y));
+
+            // --- ANALYSE: the raw frame against the previous one, then remember this row ---
+            if constexpr (doAnalyse) {
+                const juce::PixelARGB* raw = sourceRow(c, y);
+                auto* previousRow = reinterpret_cast<juce::PixelARGB*>(c.previous->getLinePointer(y));
+
+                if (y % c.scanStep == 0) {
+                    for (int x = 0; x < frameWidth; x += c.scanStep) {
+                        juce::Colour current(raw[x].getUnpremultiplied());
+                        juce::Colour old(previousRow[x].getUnpremultiplied());
+
+                        if (current.getAlpha() > alphaThreshold) {
+                            c.scan->totalX += (float)x;
+                            c.scan->totalHue += current.getHue();
+                            c.scan->pixelCount += 1.0f;
+                        }
+                        if (std::abs(current.getBrightness() - old.getBrightness()) > 0.05f) c.scan->deltaCount += 1.0f;
+                    }
+                }
+
+                std::memcpy(previousRow, raw, sizeof(juce::PixelARGB) * frameWidth);
+            }
+
+            if constexpr (!writesFrame && !doReflect) continue;
+
+            juce::PixelARGB* out = nullptr;
+            if constexpr (writesFrame) out = reinterpret_cast<juce::PixelARGB*>(c.frame->getLinePointer(y));
+
+            juce::PixelARGB* mirrored = nullptr;
+            float mirroredAlpha = 0.0f;
+            if constexpr (doReflect) {
+                const int reflectedY = frameHeight - 1 - y;
+                if (reflectedY < reflectionFadeRows) {
+                    mirrored = reinterpret_cast<juce::PixelARGB*>(c.reflection->getLinePointer(reflectedY));
+                    float curve = 1.0f - (float)reflectedY / (float)reflectionFadeRows;
+                    mirroredAlpha = 0.45f * curve * curve;
+                }
+            }
+
+            if constexpr (!writesFrame) {
+                if (mirrored == nullptr) continue;
+            }
+
+            const juce::PixelARGB* above = nullptr;
+            const juce::PixelARGB* below = nullptr;
+            if constexpr (doOutline) {
+                above = y > 0 ? sourceRow(c, snap(y - 1)) : nullptr;
+                below = y < frameHeight - 1 ? sourceRow(c, snap(y + 1)) : nullptr;
+            }
+
+            for (int x = 0; x < frameWidth; ++x) {
+                const int sxSnapped = snap(x);
+                juce::PixelARGB pixel = row[sxSnapped];
+                bool isOutline = false;
+
+                if constexpr (doOutline) {
+                    if (pixel.getAlpha() <= alphaThreshold) {
+                        isOutline = (x > 0 && row[snap(x - 1)].getAlpha() > alphaThreshold)
+                                 || (x < frameWidth - 1 && row[snap(x + 1)].getAlpha() > alphaThreshold)
+                                 || (above != nullptr && above[sxSnapped].getAlpha() > alphaThreshold)
+                                 || (below != nullptr && below[sxSnapped].getAlpha() > alphaThreshold);
+                        if (isOutline) pixel.setARGB(255, 0, 0, 0);
+                    }
+                }
+
+                if constexpr (doGrade || doPosterize) {
+                    // Same alpha gate and HSV maths as SpriteGrade::apply, so the result is identical
+                    if (!isOutline && pixel.getAlpha() > 10) {
+                        juce::Colour colour(pixel.getUnpremultiplied());
+
+                        if constexpr (doGrade) {
+                            colour = juce::Colour::fromHSV(std::fmod(colour.getHue() + c.grade.hueShift, 1.0f),
+                                                           juce::jmin(1.0f, colour.getSaturation() * (1.0f + c.grade.satBoost)),
+                                                           juce::jmin(1.0f, colour.getBrightness() + c.grade.brightBoost),
+                                                           colour.getFloatAlpha());
+                        }
+
+                        if constexpr (doPosterize)
+                            colour = juce::Colour(quantise(colour.getRed(), levelsMinusOne), quantise(colour.getGreen(), levelsMinusOne),
+                                                  quantise(colour.getBlue(), levelsMinusOne), colour.getAlpha());
+
+                        pixel = colour.getPixelARGB();
+                    }
+                }
+
+                if constexpr (writesFrame) out[x] = pixel;
+
+                if constexpr (doReflect) {
+                    if (mirrored != nullptr) {
+                        if (pixel.getAlpha() > 0) mirrored[x] = juce::Colour(pixel.getUnpremultiplied()).withMultipliedAlpha(mirroredAlpha).getPixelARGB();
+                        else mirrored[x].setARGB(0, 0, 0, 0);
+                    }
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpriteData.h"
+#include "SpriteGrade.h"
+#include "SpriteEffects.h"
+#include "SpriteGlow.h"
+
+// Everything that decides what one exported frame looks like
+struct SpriteFrameState
+{
+    int row = 0;            // Animation within the character
+    int frame = 0;          // Frame within the animation
+    float scale = 1.0f;     // "scale" parameter, 1.0 = 100%
+    float pump = 0.0f;      // Audio + MIDI pump (0.45 = 45% bigger)
+    bool mirror = false;
+    SpriteGrade grade;
+    SpriteStyle style;
+    float glow = 0.0f;      // Glow / shadow opacity (SpriteGlow::getStrength)
+
+    bool operator==(const SpriteFrameState& other) const {
+        return row == other.row && frame == other.frame && scale == other.scale && pump == other.pump
+            && mirror == other.mirror && grade == other.grade && style == other.style
+            && glow == other.glow;
+    }
+};
+
+// --- STATELESS FRAME RENDERER ---
+// Draws one dancer frame from nothing but its inputs, so the offline exporter can render any
+// frame on any worker in any order and always get the same pixels. All images are software
+// images: the scratch buffers are created that way and SpriteSheetCache converts the sheets when
+// it decodes them. Native (CoreGraphics / Direct2D) backed ones are neither thread-safe nor
+// guaranteed bit-exact across runs.
+class SpriteFrameRenderer
+{
+public:
+    static constexpr int frameWidth = SpriteEffectPipeline::frameWidth;
+    static constexpr int frameHeight = SpriteEffectPipeline::frameHeight;
+    static constexpr int reflectionFadeRows = SpriteEffectPipeline::reflectionFadeRows;
+
+    static juce::Image createScratchImage(int width = frameWidth, int height = frameHeight) {
+        return juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    }
+
+    static bool locateFrame(const SpriteSheetSet& set, int row, int frame, int& sheetIndex, int& sx, int& sy) {
+        if (!set.isValid()) return false;
+
+        row = juce::jlimit(0, (int)set.anims.size() - 1, row);
+        int numFrames = juce::jmax(1, set.anims[(size_t)row].frameCount);
+        frame = ((frame % numFrames) + numFrames) % numFrames;
+
+        if (set.isGrid) {
+            int globalFrame = frame;
+            for (int i = 0; i < row; ++i) globalFrame += set.anims[(size_t)i].frameCount;
+            sheetIndex = globalFrame / 72;
+            sx = (globalFrame % 72 % 9) * frameWidth;
+            sy = (globalFrame % 72 / 9) * frameHeight;
+        } else {
+            sheetIndex = 0;
+            sx = frame * frameWidth;
+            sy = row * frameHeight;
+        }
+
+        if (sheetIndex < 0 || sheetIndex >= (int)set.sheets.size()) return false;
+        const auto& sheet = set.sheets[(size_t)sheetIndex];
+        return sheet.isValid() && sx + frameWidth <= sheet.getWidth() && sy + frameHeight <= sheet.getHeight();
+    }
+
+    // Upside-down copy of the frame's bottom rows, fading out over the first 100 rows. The pipeline's
+    // reflect stage produces the same pixels in its single pass; this multi-pass version stays as the
+    // reference EffectsBench measures against.
+    static void buildReflection(const juce::Image& src, juce::Image& dest) {
+        dest.clear(dest.getBounds(), juce::Colours::transparentBlack);
+
+        juce::Image::BitmapData srcData(src, juce::Image::BitmapData::readOnly);
+        juce::Image::BitmapData destData(dest, juce::Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < reflectionFadeRows; ++y) {
+            int flippedY = frameHeight - 1 - y;
+            float progress = (float)y / (float)reflectionFadeRows;
+            float curve = (1.0f - progress) * (1.0f - progress);
+            float alphaMod = 0.45f * curve;
+
+            for (int x = 0; x < frameWidth; ++x) {
+                juce::Colour c = srcData.getPixelColour(x, flippedY);
+                if (c.getAlpha() > 0) destData.setPixelColour(x, y, c.withMultipliedAlpha(alphaMod));
+            }
+        }
+    }
+
+    // Renders into target (cleared first). At 100% scale the dancer is half the frame height and
+    // stands on a floor line at 75% of it, leaving room for the reflection below.
+    // frameScratch / reflectionScratch are per-worker 220x256 images from createScratchImage(),
+    // glowScratch a per-worker SpriteGlow (it keeps the last frame's blur).
+    static void render(juce::Image& target, const SpriteSheetSet& set, const SpriteFrameState& state,
+                       juce::Image& frameScratch, juce::Image& reflectionScratch, SpriteGlow& glowScratch) {
+        target.clear(target.getBounds(), juce::Colours::transparentBlack);
+
+        int sheetIndex = 0, sx = 0, sy = 0;
+        if (!locateFrame(set, state.row, state.frame, sheetIndex, sx, sy)) return;
+
+        // One fused pass for the frame effects and the reflection; unstyled frames draw from the sheet
+        const auto& sheet = set.sheets[(size_t)sheetIndex];
+        unsigned effects = SpriteEffectPipeline::getFrameEffects(state.grade, state.style);
+        if (state.mirror) {
+            effects |= SpriteEffectPipeline::reflect;
+            reflectionScratch.clear(reflectionScratch.getBounds(), juce::Colours::transparentBlack);
+        }
+        SpriteEffectPipeline::run(effects, sheet, sx, sy, state.grade, state.style, &frameScratch, &reflectionScratch, nullptr);
+        const bool styled = (effects & SpriteEffectPipeline::frameEffects) != 0;
+
+        float pixelScale = (float)target.getHeight() / (2.0f * frameHeight) * state.scale * (1.0f + state.pump);
+        float destW = frameWidth * pixelScale;
+        float destH = frameHeight * pixelScale;
+        float floorY = target.getHeight() * 0.75f;
+        float destX = target.getWidth() * 0.5f - destW * 0.5f;
+
+        juce::Graphics g(target);
+        g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+        juce::Rectangle<float> dest(destX, floorY - destH, destW, destH);
+        if (SpriteGlow::isActive(state.style, state.glow)) {
+            auto key = SpriteGlow::makeKey(sheetIndex, sx, sy, effects, state.style);
+            if (styled) glowScratch.update(key, frameScratch, 0, 0);
+            else glowScratch.update(key, sheet, sx, sy);
+            glowScratch.draw(g, dest, state.style.glowMode, SpriteGlow::getColour(state.style.glowMode, state.grade, state.glow));
+        }
+
+        if (styled) g.drawImage(frameScratch, dest);
+        else g.drawImage(sheet.getClippedImage({ sx, sy, frameWidth, frameHeight }), dest);
+
+        if (state.mirror) {
+            g.drawImage(reflectionScratch, juce::Rectangle<float>(destX, floorY, destW, destH));
+        }
+    }
+};
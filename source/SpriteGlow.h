@@ -0,0 +1,165 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpriteEffects.h"
+
+// --- SPRITE GLOW / DROP SHADOW ---
+// A soft halo (or offset shadow) behind the dancer so it stays readable over busy backgrounds.
+// It is the frame's alpha, downsampled 2x and blurred with three box passes (close to a
+// Gaussian). Each pass is a running sum down the rows, vectorised across the columns with
+// FloatVectorOperations; the horizontal passes run the same code on the transposed buffer.
+// Only the blurred alpha is cached, per frame: colour and strength are applied by the brush
+// when it is drawn, so following the beat costs nothing extra.
+class SpriteGlow
+{
+public:
+    enum Mode { off = 0, glow = 1, shadow = 2 };
+
+    static constexpr int downsample = 2;
+    static constexpr int maskWidth = SpriteEffectPipeline::frameWidth / downsample;
+    static constexpr int maskHeight = SpriteEffectPipeline::frameHeight / downsample;
+    static constexpr int maxRadius = 16;   // In mask pixels
+
+    // Everything the cached blur depends on
+    struct Key
+    {
+        int sheet = -1, sx = 0, sy = 0;
+        unsigned effects = 0;   // Pipeline effects that change the alpha (outline, pixelate)
+        int pixelSize = 1, radius = 0;
+        bool tweened = false;   // A blend of two frames: never matches, never reused
+
+        bool operator==(const Key& other) const {
+            return !tweened && !other.tweened
+                && sheet == other.sheet && sx == other.sx && sy == other.sy && effects == other.effects
+                && pixelSize == other.pixelSize && radius == other.radius;
+        }
+    };
+
+    static Key makeKey(int sheet, int sx, int sy, unsigned frameEffects, const SpriteStyle& style, bool tweened = false) {
+        Key key;
+        key.sheet = sheet; key.sx = sx; key.sy = sy; key.tweened = tweened;
+        key.effects = frameEffects & (SpriteEffectPipeline::outline | SpriteEffectPipeline::pixelate);
+        key.pixelSize = style.pixelSize;
+        key.radius = juce::jlimit(1, maxRadius, style.glowRadius);
+        return key;
+    }
+
+    // Opacity from react_intensity; with audio reactivity on it breathes with the bass pump
+    static float getStrength(bool reactOn, float reactIntensity, float pump) {
+        float strength = juce::jlimit(0.0f, 1.0f, reactIntensity / 100.0f);
+        if (reactOn) strength *= 0.35f + 0.65f * juce::jlimit(0.0f, 1.0f, pump);
+        return strength;
+    }
+
+    static bool isActive(const SpriteStyle& style, float strength) { return style.glowMode != off && strength > 0.001f; }
+
+    // The glow follows the grade's hue shift from a cyan base; the shadow is black
+    static juce::Colour getColour(int mode, const SpriteGrade& grade, float strength) {
+        if (mode == shadow) return juce::Colours::black.withAlpha(0.75f * strength);
+        return juce::Colour::fromHSV(std::fmod(0.55f + grade.hueShift, 1.0f), 0.55f, 1.0f, strength);
+    }
+
+    // Re-blurs the alpha of the 220x256 frame at (sx, sy) of source, unless key is already cached
+    void update(const Key& key, const juce::Image& source, int sx, int sy) {
+        if (mask.isValid() && key == cachedKey) return;
+        cachedKey = key;
+
+        const int radius = key.radius;
+        padding = 3 * radius;   // How far three box passes spread the alpha
+        const int w = maskWidth + 2 * padding, h = maskHeight + 2 * padding;
+
+        buffer.assign((size_t)(w * h), 0.0f);
+        scratch.resize(buffer.size());
+        runningSum.resize((size_t)juce::jmax(w, h));
+
+        // 1. Alpha at half resolution (2x2 average), centred in the padded buffer
+        {
+            juce::Image frame = source;
+            if (frame.getFormat() != juce::Image::ARGB) frame = frame.convertedToFormat(juce::Image::ARGB);
+            juce::Image::BitmapData data(frame, sx, sy, SpriteEffectPipeline::frameWidth, SpriteEffectPipeline::frameHeight,
+                                         juce::Image::BitmapData::readOnly);
+
+            for (int y = 0; y < maskHeight; ++y) {
+                auto* row0 = reinterpret_cast<const juce::PixelARGB*>(data.getLinePointer(y * downsample));
+                auto* row1 = reinterpret_cast<const juce::PixelARGB*>(data.getLinePointer(y * downsample + 1));
+                float* out = buffer.data() + (size_t)((y + padding) * w + padding);
+
+                for (int x = 0; x < maskWidth; ++x) {
+                    const int x0 = x * downsample;
+                    out[x] = 0.25f * (float)(row0[x0].getAlpha() + row0[x0 + 1].getAlpha() + row1[x0].getAlpha() + row1[x0 + 1].getAlpha());
+                }
+            }
+        }
+
+        // 2. Three vertical passes, then three horizontal ones on the transposed buffer
+        for (int pass = 0; pass < 3; ++pass) blurColumns(w, h, radius);
+        transpose(w, h);
+        for (int pass = 0; pass < 3; ++pass) blurColumns(h, w, radius);
+        transpose(h, w);
+
+        // 3. Into an 8-bit mask the brush colours when it is drawn
+        if (mask.getWidth() != w || mask.getHeight() != h)
+            mask = juce::Image(juce::Image::SingleChannel, w, h, false, juce::SoftwareImageType());
+
+        juce::Image::BitmapData maskData(mask, juce::Image::BitmapData::writeOnly);
+        for (int y = 0; y < h; ++y) {
+            const float* in = buffer.data() + (size_t)(y * w);
+            juce::uint8* line = maskData.getLinePointer(y);
+            for (int x = 0; x < w; ++x)
+                line[x * maskData.pixelStride] = (juce::uint8)juce::jlimit(0, 255, juce::roundToInt(in[x]));
+        }
+    }
+
+    // frameArea is where the 220x256 frame itself is drawn
+    void draw(juce::Graphics& g, juce::Rectangle<float> frameArea, int mode, juce::Colour colour) const {
+        if (!mask.isValid()) return;
+
+        const float unit = frameArea.getWidth() / (float)SpriteEffectPipeline::frameWidth;
+        auto area = frameArea.expanded((float)(padding * downsample) * unit);
+        if (mode == shadow) area.translate(frameArea.getWidth() * 0.05f, frameArea.getHeight() * 0.03f);
+
+        g.setColour(colour);
+        g.drawImage(mask, area, juce::RectanglePlacement::stretchToFit, true);
+    }
+
+    void invalidate() { cachedKey = Key(); }
+
+private:
+    // One box pass down the columns of buffer (width x height), into scratch, then swapped back
+    void blurColumns(int width, int height, int radius) {
+        const float* in = buffer.data();
+        float* out = scratch.data();
+        float* sum = runningSum.data();
+        const float scale = 1.0f / (float)(2 * radius + 1);
+
+        juce::FloatVectorOperations::clear(sum, width);
+        for (int k = 0; k <= radius && k < height; ++k)
+            juce::FloatVectorOperations::add(sum, in + (size_t)(k * width), width);
+
+        for (int y = 0; y < height; ++y) {
+            juce::FloatVectorOperations::multiply(out + (size_t)(y * width), sum, scale, width);
+
+            const int entering = y + radius + 1, leaving = y - radius;
+            if (entering < height) juce::FloatVectorOperations::add(sum, in + (size_t)(entering * width), width);
+            if (leaving >= 0) juce::FloatVectorOperations::subtract(sum, in + (size_t)(leaving * width), width);
+        }
+
+        buffer.swap(scratch);
+    }
+
+    // buffer (width x height) -> buffer (height x width)
+    void transpose(int width, int height) {
+        constexpr int tile = 16;
+        for (int y0 = 0; y0 < height; y0 += tile)
+            for (int x0 = 0; x0 < width; x0 += tile)
+                for (int y = y0; y < juce::jmin(height, y0 + tile); ++y)
+                    for (int x = x0; x < juce::jmin(width, x0 + tile); ++x)
+                        scratch[(size_t)(x * height + y)] = buffer[(size_t)(y * width + x)];
+
+        buffer.swap(scratch);
+    }
+
+    std::vector<float> buffer, scratch, runningSum;
+    juce::Image mask;
+    int padding = 0;
+    Key cachedKey;
+};
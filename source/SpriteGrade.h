@@ -0,0 +1,55 @@
+#pragma once
+#include <JuceHeader.h>
+
+// --- SPRITE COLOUR GRADE ---
+// The audio/MIDI-driven hue, saturation and brightness shift, shared by the single dancer and
+// the crowd so both always grade identically.
+struct SpriteGrade
+{
+    float hueShift = 0.0f;
+    float satBoost = 0.0f;
+    float brightBoost = 0.0f;
+
+    // Whether the audio side of the grade does anything at all (hue from the spectral brightness,
+    // intensity from the spectral flux)
+    static bool isAudioGraded(bool reactOn, float hueDrive, float intensityDrive, float reactIntensity, float reactColor) {
+        return reactOn && ((hueDrive > 0.001f && reactColor > 0.0f) || (intensityDrive > 0.001f && reactIntensity > 0.0f));
+    }
+
+    // Audio reactivity plus the CC74 hue shift. Amounts are the 0..100 parameter values.
+    static SpriteGrade fromReactivity(bool reactOn, float hueDrive, float intensityDrive, float reactIntensity, float reactColor, float midiHueShift) {
+        SpriteGrade grade;
+        bool audioGrade = isAudioGraded(reactOn, hueDrive, intensityDrive, reactIntensity, reactColor);
+        float intensityFactor = audioGrade ? intensityDrive * (reactIntensity / 100.0f) : 0.0f;
+        grade.hueShift = (audioGrade ? hueDrive * (reactColor / 100.0f) : 0.0f) + midiHueShift;
+        grade.satBoost = intensityFactor * 2.0f;
+        grade.brightBoost = intensityFactor * 0.6f;
+        return grade;
+    }
+
+    bool operator==(const SpriteGrade& other) const {
+        return hueShift == other.hueShift && satBoost == other.satBoost && brightBoost == other.brightBoost;
+    }
+
+    bool isNeutral() const { return hueShift <= 0.0f && satBoost <= 0.0f && brightBoost <= 0.0f; }
+
+    // Grades an ARGB image in place (pixels at or below alpha 10 are left alone)
+    void apply(juce::Image& img) const {
+        juce::Image::BitmapData data(img, juce::Image::BitmapData::readWrite);
+
+        for (int y = 0; y < data.height; ++y) {
+            for (int x = 0; x < data.width; ++x) {
+                juce::Colour c = data.getPixelColour(x, y);
+
+                if (c.getAlpha() > 10) {
+                    data.setPixelColour(x, y, juce::Colour::fromHSV(
+                        std::fmod(c.getHue() + hueShift, 1.0f),
+                        juce::jmin(1.0f, c.getSaturation() * (1.0f + satBoost)),
+                        juce::jmin(1.0f, c.getBrightness() + brightBoost),
+                        c.getFloatAlpha()
+                    ));
+                }
+            }
+        }
+    }
+};
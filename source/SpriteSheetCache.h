@@ -0,0 +1,99 @@
+#pragma once
+#include <JuceHeader.h>
+#include <map>
+#include "MemoryAccounting.h"
+#include "Tracing.h"
+
+// --- DECODED SPRITE SHEET CACHE ---
+// Used instead of juce::ImageCache for the embedded sheets, so every decoded byte is on the
+// memory ledger (Tag::sheetCache) and can be given back when the process-wide ceiling is hit.
+// Shared by every editor in the process through juce::SharedResourcePointer. Sheets still held
+// by a SpriteContent are never evicted; idle ones go least-recently-used first.
+class SpriteSheetCache
+{
+public:
+    SpriteSheetCache() {
+        evictorId = MemoryAccounting::Ledger::getInstance().addEvictor([this](juce::int64 bytesNeeded) { return evict(bytesNeeded); });
+    }
+
+    ~SpriteSheetCache() { MemoryAccounting::Ledger::getInstance().removeEvictor(evictorId); }
+
+    // Decoded image for BinaryData::namedResourceList[resourceIndex] (decodes on a miss)
+    juce::Image get(int resourceIndex) {
+        {
+            const juce::ScopedLock sl(lock);
+            auto it = entries.find(resourceIndex);
+            if (it != entries.end()) {
+                it->second.lastUse = ++useCounter;
+                return it->second.image;
+            }
+        }
+
+        int size = 0;
+        const char* data = BinaryData::getNamedResource(BinaryData::namedResourceList[resourceIndex], size);
+        if (data == nullptr) return {};
+
+        juce::Image img;
+        {
+            SQUAB_TRACE_ZONE("decodeImage");
+            // Decoders hand back native images, but these sheets are read concurrently by the
+            // export workers, the crowd workers and the frame publisher, which is only safe (and
+            // only bit-exact) on plain memory bitmaps
+            img = juce::SoftwareImageType().convert(juce::ImageFileFormat::loadFrom(data, (size_t)size));
+        }
+        if (!img.isValid()) return {};
+
+        // Registering can evict other sheets, so it must happen before we take the lock
+        MemoryAccounting::Allocation bytes(MemoryAccounting::Tag::sheetCache, MemoryAccounting::getImageBytes(img));
+
+        const juce::ScopedLock sl(lock);
+        auto& entry = entries[resourceIndex];
+
+        // Another thread may have decoded the same sheet meanwhile; keep theirs, drop ours
+        if (!entry.image.isValid()) {
+            entry.image = img;
+            entry.bytes = std::move(bytes);
+        }
+        entry.lastUse = ++useCounter;
+        return entry.image;
+    }
+
+    bool contains(int resourceIndex) const {
+        const juce::ScopedLock sl(lock);
+        return entries.find(resourceIndex) != entries.end();
+    }
+
+    // Drops idle sheets (oldest first) until `bytesNeeded` is freed or nothing idle is left
+    juce::int64 evict(juce::int64 bytesNeeded) {
+        const juce::ScopedLock sl(lock);
+        juce::int64 freed = 0;
+
+        while (freed < bytesNeeded) {
+            auto victim = entries.end();
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->second.image.getReferenceCount() > 1) continue; // Someone is drawing it
+                if (victim == entries.end() || it->second.lastUse < victim->second.lastUse) victim = it;
+            }
+            if (victim == entries.end()) break;
+
+            freed += victim->second.bytes.getBytes();
+            entries.erase(victim);
+        }
+        return freed;
+    }
+
+private:
+    struct Entry
+    {
+        juce::Image image;
+        MemoryAccounting::Allocation bytes;
+        juce::uint64 lastUse = 0;
+    };
+
+    juce::CriticalSection lock;
+    std::map<int, Entry> entries;
+    juce::uint64 useCounter = 0;
+    int evictorId = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpriteSheetCache)
+};
@@ -1,6 +1,18 @@
 #pragma once
 #include <JuceHeader.h>
 #include "SpriteData.h"
+#include "BeatClock.h"
+#include "MidiAnimationQueue.h"
+#include "Tracing.h"
+#include "ActivityMonitor.h"
+#include "QualityGovernor.h"
+#include "SpriteGrade.h"
+#include "FrameTweener.h"
+#include "CrowdRenderer.h"
+#include "SpriteFrameRenderer.h"
+#include "SharedFramePublisher.h"
+#include "MotionSensor.h"
+#include "SpectralAnalyser.h"
 
 class SpriteContent : public juce::Component, public juce::Timer
 {
@@ -10,18 +22,51 @@ public:
         setSize(960, 2280); 
         frameBuffer = juce::Image(juce::Image::ARGB, 220, 256, true);
         reflectionBuffer = juce::Image(juce::Image::ARGB, 220, 256, true);
-        lastFrameBuffer = juce::Image(juce::Image::ARGB, 220, 256, true); 
+        tweenBuffer = SpriteFrameRenderer::createScratchImage();
+        scratchBytes = MemoryAccounting::Allocation(MemoryAccounting::Tag::scratch,
+                                                    MemoryAccounting::getImageBytes(frameBuffer) + MemoryAccounting::getImageBytes(motionSensor.getLastFrame())
+                                                    + MemoryAccounting::getImageBytes(tweenBuffer));
+        reflectionBytes = MemoryAccounting::Allocation(MemoryAccounting::Tag::reflection, MemoryAccounting::getImageBytes(reflectionBuffer));
+        pendingEvents.reserve(4096);
         
         startTimerHz(30); 
+
+        // The display-rate clock: MIDI events in both modes, plus frame advance in sync mode
+        vblank = std::make_unique<juce::VBlankAttachment>(this, [this] { vblankCallback(); });
     }
     
-    ~SpriteContent() override { stopTimer(); }
+    ~SpriteContent() override { stopTimer(); vblank = nullptr; }
+
+    // In-betweening (FrameTweener::Mode): renders at display rate between the authored frames.
+    // In Hz mode the vblank then runs the frame clock instead of the Hz timer.
+    void setTweenMode(int mode) {
+        if (tweenMode == mode) return;
+        tweenMode = mode;
+        framePhase = 0.0f;
+        hzPhase = 0.0;
+        if (!isSyncMode && !activity.isIdle()) startFrameTimer();
+        wake(ActivityMonitor::WakeReason::parameter);
+        repaint();
+    }
+
+    // The processor's beat clock; sync mode reads the audible ppq from it at every vblank
+    void setBeatClock(BeatClock* clock) { beatClock = clock; }
+
+    // The processor's MIDI event queue (notes/CCs stamped with the time they are heard). Whatever
+    // piled up while no editor was open is long past its due time, so it is thrown away rather
+    // than replayed as one burst on the first frame.
+    void setEventQueue(AnimationEventQueue* queue) {
+        eventQueue = queue;
+        if (eventQueue != nullptr) eventQueue->discardPending();
+        pendingEvents.clear();
+    }
 
     void setSpeed(float hz) {
-        int newHz = (int)juce::jmax(1.0f, hz); 
-        if (currentHz != newHz) {              
-            currentHz = newHz;
-            startTimerHz(currentHz);
+        speedHz = juce::jmax(1.0f, hz);   // In-betweening runs the clock at the exact rate
+        int newInterval = juce::roundToInt(1000.0f / speedHz);   // 12.5 Hz is 80 ms, not 12 Hz
+        if (frameIntervalMs != newInterval) {
+            frameIntervalMs = newInterval;
+            if (!isSyncMode && !activity.isIdle()) startFrameTimer();
         }
     }
     
@@ -31,6 +76,7 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
         // against a newly loaded (smaller) sprite sheet.
         currentFrame = 0;
         currentRow   = 0;
+        midiRow      = -1;
         totalFrames  = (!anims.empty()) ? anims[0].frameCount : 1;
         heldRow      = 0;
         heldFrames   = totalFrames;
@@ -39,39 +85,304 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
         isGridSprite = isGrid;
         currentAnims = anims;
         spriteSheets = imgs;
+        gradeCacheValid = reflectionCacheValid = false;
+        glow.invalidate();
+        tweener.clearCache();
+        framePhase = 0.0f;
+        crowd.setSpriteData(isGrid, anims, imgs);
+        crowdLayoutDirty = true;
+        wake(ActivityMonitor::WakeReason::parameter);
         repaint();
     }
     
     void updateParams(int row, int frames, int hRow, int hFrames, bool mir) {
+        // A new pick in the UI wins over whatever move MIDI selected last
+        if (row != lastEditorRow) { lastEditorRow = row; midiRow = -1; }
+
+        if (midiRow >= 0 && midiRow < (int)currentAnims.size()) {
+            row = midiRow;
+            frames = currentAnims[(size_t)midiRow].frameCount;
+        }
+
+        // The editor calls this for any selection or mirror change, so only a real change may repaint or wake us
+        if (currentRow == row && totalFrames == frames && heldRow == hRow && heldFrames == hFrames && mirror == mir) return;
+
+        if (heldRow != hRow) crowdLayoutDirty = true;
         currentRow = row; totalFrames = frames; heldRow = hRow; heldFrames = hFrames; mirror = mir;
+        wake(ActivityMonitor::WakeReason::parameter);
         repaint();
     }
 
-    void resetAnimation() { currentFrame = 0; repaint(); }
+    // --- CROWD MODE ---
+    // 1 = just the lead dancer; more puts a stage of dancers behind it
+    void setCrowdSize(int size) {
+        size = juce::jlimit(1, CrowdRenderer::maxDancers + 1, size);
+        if (size == crowdSize) return;
 
+        crowdSize = size;
+        crowdLayoutDirty = true;
+
+        // Big crowds rasterise in tiles across a few workers
+        int cores = juce::SystemStats::getNumCpus();
+        crowd.setNumWorkers(crowdSize >= 32 ? juce::jlimit(0, 4, cores - 1) : 0);
+
+        wake(ActivityMonitor::WakeReason::parameter);
+        repaint();
+    }
+
+    const CrowdRenderer& getCrowd() const { return crowd; }
+
+    void resetAnimation() { currentFrame = 0; wake(ActivityMonitor::WakeReason::interaction); repaint(); }
+
+    bool hasSpriteData() const { return !spriteSheets.empty() && !currentAnims.empty(); }
+
+    // Hz mode: one tick per animation frame
     void timerCallback() override {
-        // --- THE BOUNCE PHYSICS ---
-        if (audioLevel > smoothPump) smoothPump = audioLevel; 
-        else smoothPump *= 0.85f; // Decay speed
+        SQUAB_TRACE_ZONE("spriteTimer");
+        capturePosition(juce::Time::getHighResolutionTicks());
+        if (repaintDeferred) requestAnimationRepaint();
+        stepHzFrame();
+        publishFrame();
+        if (shouldIdle()) goIdle();
+    }
+
+    // One Hz-mode animation frame; whoever calls it publishes once for the whole tick
+    void stepHzFrame() {
+        updatePump(0.85f);
+        advanceFrame();
+    }
+
+    // Runs on every display refresh so beats and MIDI hits land on the frame the user hears
+    void vblankCallback() {
+        SQUAB_TRACE_ZONE("spriteVBlank");
+
+        // Idle: only look for a reason to wake up
+        if (activity.isIdle() && !checkWakeConditions()) return;
+
+        if (repaintDeferred) requestAnimationRepaint();
+
+        auto now = juce::Time::getHighResolutionTicks();
+        double dt = (lastVBlankTicks > 0) ? juce::Time::highResolutionTicksToSeconds(now - lastVBlankTicks) : 1.0 / 60.0;
+        lastVBlankTicks = now;
+        capturePosition(now);
+
+        // Same decay as the old 60 Hz sync timer, independent of the monitor's refresh rate
+        float decay = std::pow(0.85f, (float)(dt * 60.0));
+        midiPump *= decay;
+
+        dispatchMidiEvents(now);
+
+        if (isSyncMode) {
+            updatePump(decay);
+            advanceFrame();
+        } else if (isTweening()) {
+            // Whole frames tick exactly like the Hz timer; the remainder is the in-between phase
+            hzPhase += dt * speedHz;
+            for (int steps = 0; hzPhase >= 1.0 && steps < 4; ++steps) {
+                hzPhase -= 1.0;
+                stepHzFrame();
+            }
+            hzPhase = juce::jmin(hzPhase, 0.999);
+            framePhase = (float)hzPhase;
+            requestAnimationRepaint();
+        }
+
+        publishFrame();
+        if (shouldIdle()) goIdle();
+    }
+
+    // --- IDLE THROTTLING ---
+    // Nothing on screen can change: the Hz timer stops and the vblank only checks for wake-ups.
+    bool shouldIdle() const {
+        if (!isShowing() && framePublisher == nullptr) return true;
+
+        bool settled = !repaintDeferred && smoothPump < settleLevel && midiPump < settleLevel && pendingEvents.empty()
+                    && (!audioReactOn || spectrum.level < settleLevel);
+        if (!settled) return false;
+
+        // Sync mode only moves while the transport runs; Hz mode only if there is more than one frame
+        if (isSyncMode) return beatClock == nullptr || !beatClock->getLatest().isPlaying;
+        return (isMouseOverOrDragging ? heldFrames : totalFrames) <= 1 && crowdSize <= 1;
+    }
+
+    void wake(ActivityMonitor::WakeReason reason) {
+        if (!activity.wake(reason)) return;
+        if (!isSyncMode) startFrameTimer();
+        lastVBlankTicks = 0; // Don't apply the whole idle gap as one decay step
+    }
 
+    ActivityMonitor& getActivity() { return activity; }
+
+    // --- SHARED STAGE ---
+    // On the shared stage this dancer is a child of the one compositor window and is ticked by its
+    // single frame clock, so its own timer and vblank attachment are switched off.
+    void setOnSharedStage(bool shouldBeOnStage) {
+        if (onSharedStage == shouldBeOnStage) return;
+        onSharedStage = shouldBeOnStage;
+
+        if (onSharedStage) {
+            stopTimer();
+            vblank = nullptr;
+        } else {
+            vblank = std::make_unique<juce::VBlankAttachment>(this, [this] { vblankCallback(); });
+            if (!isSyncMode && !activity.isIdle()) startFrameTimer();
+        }
+
+        lastVBlankTicks = 0;
+        lastStageHzTicks = 0;
+        wake(ActivityMonitor::WakeReason::visibility);
+    }
+
+    bool isOnSharedStage() const { return onSharedStage; }
+
+    // Called by the stage at every display refresh
+    void stageTick() {
+        // Hz mode: the stage clock stands in for this dancer's own timer
+        if (!isSyncMode && !isTweening() && !activity.isIdle()) {
+            auto now = juce::Time::getHighResolutionTicks();
+            if (lastStageHzTicks == 0 || juce::Time::highResolutionTicksToSeconds(now - lastStageHzTicks) >= 1.0 / speedHz) {
+                lastStageHzTicks = now;
+                stepHzFrame();   // Published by the vblank pass below
+            }
+        }
+
+        vblankCallback();
+    }
+
+    // --- SHARED-MEMORY FRAME OUTPUT ---
+    // While a publisher is attached every frame clock tick posts the dancer's state to it, and
+    // the dancer keeps animating even with its window hidden (the stream is the output then).
+    void setFramePublisher(SharedFramePublisher* publisher) {
+        framePublisher = publisher;
+        wake(ActivityMonitor::WakeReason::visibility);
+    }
+
+    // What paintSprite() shows right now, in the renderer-independent form
+    SpriteFrameState getFrameState() const {
+        SpriteFrameState state;
+        int activeFrames = juce::jmax(1, isMouseOverOrDragging ? heldFrames : totalFrames);
+        state.row = isMouseOverOrDragging ? heldRow : currentRow;
+        state.frame = currentFrame % activeFrames;
+        state.scale = currentScale * (1.0f + midiScaleBoost);
+        state.pump = midiPump * 0.45f;
+        if (audioReactOn && smoothPump > 0.001f && reactPump > 0.0f) state.pump += smoothPump * (reactPump / 100.0f) * 0.45f;
+        state.mirror = mirror;
+        state.grade = currentGrade();
+        state.style = style;
+        state.glow = SpriteGlow::getStrength(audioReactOn, reactIntensity, smoothPump);
+        return state;
+    }
+
+    void updatePump(float decay) {
+        // --- THE BOUNCE PHYSICS (kicked by the bass) ---
+        if (spectrum.bass > smoothPump) smoothPump = spectrum.bass;
+        else smoothPump *= decay; // Decay speed
+    }
+
+    // --- MIDI EVENTS ---
+    // Pull everything the audio thread queued, then fire only the events that are audible by now.
+    void dispatchMidiEvents(juce::int64 nowTicks) {
+        if (eventQueue != nullptr)
+            eventQueue->drain([this](const AnimationEvent& e) { pendingEvents.push_back(e); });
+
+        if (pendingEvents.empty()) return;
+
+        // Events arrive in time order, so the due ones are always at the front
+        size_t numDue = 0;
+        while (numDue < pendingEvents.size() && pendingEvents[numDue].dueTicks <= nowTicks)
+            applyMidiEvent(pendingEvents[numDue++]);
+
+        if (numDue > 0) pendingEvents.erase(pendingEvents.begin(), pendingEvents.begin() + (std::ptrdiff_t)numDue);
+    }
+
+    void applyMidiEvent(const AnimationEvent& e) {
+        if (e.type == AnimationEvent::Type::noteOn) {
+            // Note -> animation (from C3 up), otherwise retrigger the current move
+            int selected = (int)e.number - MidiAnimationMap::firstSelectNote;
+            if (selected >= 0 && selected < (int)currentAnims.size()) {
+                midiRow = selected;
+                currentRow = selected;
+                totalFrames = currentAnims[(size_t)selected].frameCount;
+            }
+
+            // Velocity -> pump kick
+            midiPump = juce::jmax(midiPump, e.value);
+            currentFrame = 0;
+            repaint();
+        } else if (e.number == MidiAnimationMap::scaleController) {
+            midiScaleBoost = e.value;
+            repaint();
+        } else if (e.number == MidiAnimationMap::hueController) {
+            midiHueShift = e.value;
+            repaint();
+        }
+    }
+
+    void advanceFrame() {
         int activeFrames = isMouseOverOrDragging ? heldFrames : totalFrames;
         if (activeFrames <= 0) return;
 
+        // The pump scales the sprite, so it needs frames even when the animation itself stands still
+        bool pumpMoving = smoothPump >= settleLevel || midiPump >= settleLevel;
+
         if (isSyncMode) {
-            if (isPlaying && currentBeatLength > 0.0) {
-                int newFrame = static_cast<int>(currentPpq / currentBeatLength) % activeFrames;
+            if (beatClock == nullptr || currentBeatLength <= 0.0) return;
+
+            if (framePosition.isPlaying) {
+                double beatPosition = framePosition.ppq / currentBeatLength;
+                crowdClock = (juce::int64)std::floor(beatPosition);
+                int newFrame = static_cast<int>(std::floor(beatPosition)) % activeFrames;
                 if (newFrame < 0) newFrame += activeFrames; 
-                if (currentFrame != newFrame) {
+                float newPhase = isTweening() ? (float)(beatPosition - std::floor(beatPosition)) : 0.0f;
+                if (currentFrame != newFrame || framePhase != newPhase) {
                     currentFrame = newFrame;
-                    repaint();
+                    framePhase = newPhase;
+                    requestAnimationRepaint();
                 }
             }
         } else {
-            currentFrame = (currentFrame + 1) % activeFrames;
-            repaint();
+            ++crowdClock;
+            int newFrame = (currentFrame + 1) % activeFrames;
+            if (newFrame != currentFrame || pumpMoving || crowdSize > 1) {
+                currentFrame = newFrame;
+                requestAnimationRepaint();
+            }
         }
     }
 
+    // Animation repaints go through here so the governor can cap the frame rate under load.
+    // A skipped repaint is remembered and flushed by the next tick that is allowed to paint.
+    void requestAnimationRepaint() {
+        double minInterval = governor.getMinPaintIntervalSeconds();
+        if (minInterval > 0.0 && lastPaintTicks > 0
+            && juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - lastPaintTicks) < minInterval) {
+            repaintDeferred = true;
+            return;
+        }
+        repaintDeferred = false;
+        repaint();
+    }
+
+    // Colour grade for this paint: audio reactivity plus the CC74 hue shift
+    SpriteGrade currentGrade() const {
+        return SpriteGrade::fromReactivity(audioReactOn, spectrum.brightness, spectrum.flux, reactIntensity, reactColor, midiHueShift);
+    }
+
+    void paintCrowd(juce::Graphics& g, float floorY) {
+        if (crowdLayoutDirty || crowdScale != currentScale) {
+            // The stage ends at the lead's floor line and spans the whole canvas width
+            juce::Rectangle<int> stageArea(0, (int)floorY - 600, getWidth(), 600);
+            crowd.layoutStage(crowdSize - 1, stageArea, currentScale, heldRow, 0x5A5AB);
+            crowdScale = currentScale;
+            crowdLayoutDirty = false;
+        }
+
+        float pump = midiPump * 0.45f;
+        if (audioReactOn && reactPump > 0.0f) pump += smoothPump * (reactPump / 100.0f) * 0.45f;
+
+        crowd.render(g, crowdClock, pump, currentGrade(), governor.getResamplingQuality());
+    }
+
     int getGlobalFrameOffset(int targetRow) {
         int offset = 0;
         for (int i = 0; i < targetRow && i < (int)currentAnims.size(); ++i) offset += currentAnims[i].frameCount;
@@ -79,6 +390,21 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
     }
 
  void paint(juce::Graphics& g) override {
+        SQUAB_TRACE_ZONE("paint");
+        auto start = juce::Time::getHighResolutionTicks();
+
+        g.setImageResamplingQuality(governor.getResamplingQuality());
+        paintSprite(g);
+
+        lastPaintTicks = juce::Time::getHighResolutionTicks();
+        governor.addPaintTime(juce::Time::highResolutionTicksToSeconds(lastPaintTicks - start) * 1000.0);
+        ++paintCounter;
+    }
+
+    QualityGovernor& getGovernor() { return governor; }
+    int getQualityLevel() const { return governor.getLevel(); }
+
+    void paintSprite(juce::Graphics& g) {
         g.fillAll(juce::Colours::transparentBlack);
         
         // CRASH FIX 2: Guard every index before touching any image data.
@@ -88,6 +414,9 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
         float winCenterX = getWidth() / 2.0f;   // 480
         float winCenterY = getHeight() / 2.0f;  // 1140 (This acts as the "Floor")
 
+        // Crowd first, so the lead dances in front of it
+        if (crowdSize > 1) paintCrowd(g, winCenterY);
+
         // apply scale
         g.addTransform(juce::AffineTransform::scale(currentScale, currentScale, winCenterX, winCenterY));
 
@@ -102,26 +431,27 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
         int activeFrames = isMouseOverOrDragging ? heldFrames : totalFrames; 
         if (activeFrames <= 0) activeFrames = 1; 
 
-        int sx = 0, sy = 0, sheetIndex = 0;
+        // Where frame frameIndex of the active animation sits in the sheets
+        auto locateFrame = [&](int frameIndex, int& sheet, int& frameX, int& frameY) {
+            if (isGridSprite) {
+                int startOffset = getGlobalFrameOffset(activeRow);
+                int globalFrame = startOffset + (frameIndex % activeFrames);
+                sheet = globalFrame / 72;
+                int localFrameIndex = globalFrame % 72;
+                frameX = (localFrameIndex % 9) * 220;
+                frameY = (localFrameIndex / 9) * 256;
+            } else {
+                frameX = (frameIndex % activeFrames) * 220;
+                frameY = activeRow * 256;
+                sheet = 0;
+            }
+        };
 
-        if (isGridSprite) {
-            int startOffset = getGlobalFrameOffset(activeRow);
-            int globalFrame = startOffset + (currentFrame % activeFrames);
-            sheetIndex = globalFrame / 72;
-            int localFrameIndex = globalFrame % 72;
-            sx = (localFrameIndex % 9) * 220;
-            sy = (localFrameIndex / 9) * 256;
-        } else {
-            sx = (currentFrame % activeFrames) * 220;
-            sy = activeRow * 256;
-            sheetIndex = 0;
-        }
+        int sx = 0, sy = 0, sheetIndex = 0;
+        locateFrame(currentFrame, sheetIndex, sx, sy);
 
         // --- 1. THE PHYSICS PUMP ---
-        float pScale = 1.0f;
-        if (audioReactOn && smoothPump > 0.001f && reactPump > 0.0f) {
-            pScale += (smoothPump * (reactPump / 100.0f) * 0.45f); 
-        }
+        float pScale = getPumpScale();
 
         float destW = 220.0f * pScale;
         float destH = 256.0f * pScale;
@@ -140,141 +470,136 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
             if (sx < 0 || sx + 220 > currentImg.getWidth()) sx = 0;
             if (sy < 0 || sy + 256 > currentImg.getHeight()) sy = 0;
 
-            juce::Image sourceToDraw = currentImg; 
-            int drawSourceX = sx;
-            int drawSourceY = sy;
-
-            // --- 2. FAST PIXEL HUE/SATURATION ENGINE ---
-            if (audioReactOn && audioLevel > 0.001f && (reactColor > 0.0f || reactIntensity > 0.0f)) {
-                frameBuffer.clear(frameBuffer.getBounds(), juce::Colours::transparentBlack);
-                {
-                    juce::Graphics gFrame(frameBuffer);
-                    gFrame.drawImage(currentImg, 0, 0, 220, 256, sx, sy, 220, 256);
+            // --- IN-BETWEEN FRAME: blend towards the next frame by the clock's phase ---
+            const juce::Image* frameSource = &currentImg;
+            int frameX = sx, frameY = sy;
+            bool tweened = false;
+
+            if (isTweening() && framePhase >= 1.0f / 256.0f && activeFrames > 1) {
+                int nextSheet = 0, nextX = 0, nextY = 0;
+                locateFrame(currentFrame + 1, nextSheet, nextX, nextY);
+
+                if (nextSheet >= 0 && nextSheet < (int)spriteSheets.size() && spriteSheets[nextSheet].isValid()
+                    && nextX + 220 <= spriteSheets[nextSheet].getWidth() && nextY + 256 <= spriteSheets[nextSheet].getHeight()) {
+                    SQUAB_TRACE_ZONE("paint.tween");
+                    tweened = tweener.render(tweenMode, { &currentImg, sheetIndex, sx, sy },
+                                             { &spriteSheets[nextSheet], nextSheet, nextX, nextY }, framePhase, tweenBuffer);
+                    if (tweened) { frameSource = &tweenBuffer; frameX = 0; frameY = 0; }
                 }
+            }
 
-                juce::Image::BitmapData data(frameBuffer, juce::Image::BitmapData::readWrite);
-                
-                float hueShift = audioLevel * (reactColor / 100.0f);
-                float intensityFactor = audioLevel * (reactIntensity / 100.0f);
-                float satBoost = intensityFactor * 2.0f; 
-                float brightBoost = intensityFactor * 0.6f; 
-            
-                for (int y = 0; y < 256; ++y) {
-                    for (int x = 0; x < 220; ++x) {
-                        juce::Colour c = data.getPixelColour(x, y);
-                        
-                        if (c.getAlpha() > 10) {
-                            data.setPixelColour(x, y, juce::Colour::fromHSV(
-                                std::fmod(c.getHue() + hueShift, 1.0f),
-                                juce::jmin(1.0f, c.getSaturation() * (1.0f + satBoost)), 
-                                juce::jmin(1.0f, c.getBrightness() + brightBoost),       
-                                c.getFloatAlpha()
-                            ));
-                        }
-                    }
-                }
-                sourceToDraw = frameBuffer; 
-                drawSourceX = 0; drawSourceY = 0;
+            // --- 2. FUSED EFFECT PASS (grade, style, motion scan, reflection) ---
+            // One SpriteEffectPipeline pass per paint: the motion scan always runs; the frame effects
+            // and the reflection only when their cached result is not current.
+            const SpriteGrade grade = currentGrade();
+            const unsigned frameEffects = SpriteEffectPipeline::getFrameEffects(grade, style);
+            const bool styled = frameEffects != 0;
+
+            // Under load a paint keeps last paint's effects of the very same frame, and the
+            // reflection follows frame changes only, not every grade update. In-between frames are
+            // never cached (-1 never matches a sheet).
+            bool frameCurrent = !tweened && gradeCacheValid && gradedSheet == sheetIndex && gradedSx == sx && gradedSy == sy
+                             && gradedEffects == frameEffects && governor.canReuseGrade(paintCounter);
+            bool reflectionCurrent = !tweened && governor.useCachedReflection() && reflectionCacheValid
+                                  && reflectedSheet == sheetIndex && reflectedSx == sx && reflectedSy == sy
+                                  && reflectedEffects == frameEffects;
+
+            unsigned effects = SpriteEffectPipeline::analyse;
+            if (mirror && !reflectionCurrent) effects |= SpriteEffectPipeline::reflect | frameEffects;
+            else if (styled && !frameCurrent) effects |= frameEffects;
+
+            {
+                SQUAB_TRACE_ZONE("paint.effects");
+
+                auto analysis = motionSensor.beginScan(governor.getMotionScanStep());
+                SpriteEffectPipeline::run(effects, *frameSource, frameX, frameY, grade, style, &frameBuffer, &reflectionBuffer, &analysis);
+                motionSensor.finishScan(analysis);
             }
 
-            // --- TRUE PIXEL-DELTA SENSOR ENGINE ---
-            float totalX = 0, totalHue = 0, pixelCount = 0, deltaCount = 0;
-            juce::Image::BitmapData scanData(sourceToDraw, juce::Image::BitmapData::readOnly);
-            juce::Image::BitmapData oldData(lastFrameBuffer, juce::Image::BitmapData::readOnly);
-
-            for (int y = 0; y < 256; y += 4) {
-                for (int x = 0; x < 220; x += 4) {
-                    
-                    int safeX = juce::jlimit(0, sourceToDraw.getWidth() - 1, drawSourceX + x);
-                    int safeY = juce::jlimit(0, sourceToDraw.getHeight() - 1, drawSourceY + y);
-
-                    juce::Colour c = scanData.getPixelColour(safeX, safeY);
-                    juce::Colour oldC = oldData.getPixelColour(x, y);
-
-                    if (c.getAlpha() > 50) {
-                        totalX += x;
-                        totalHue += c.getHue();
-                        pixelCount++;
-                    }
-                    if (std::abs(c.getBrightness() - oldC.getBrightness()) > 0.05f) deltaCount++;
-                }
+            if ((effects & SpriteEffectPipeline::frameEffects) != 0) {
+                gradeCacheValid = true;
+                gradedSheet = tweened ? -1 : sheetIndex; gradedSx = sx; gradedSy = sy; gradedEffects = frameEffects;
+            }
+            if ((effects & SpriteEffectPipeline::reflect) != 0) {
+                reflectionCacheValid = true;
+                reflectedSheet = tweened ? -1 : sheetIndex; reflectedSx = sx; reflectedSy = sy; reflectedEffects = frameEffects;
             }
 
-           if (pixelCount > 0) {
-                currentPan = (totalX / pixelCount) / 220.0f; 
-                currentHue = totalHue / pixelCount;
-                float frameMotion = (deltaCount / pixelCount) * 15.0f;
-                currentMotion = juce::jmax(currentMotion, juce::jmin(1.0f, frameMotion));
+            // --- GLOW / SHADOW (blurred alpha cached per frame, coloured by the brush) ---
+            float glowStrength = SpriteGlow::getStrength(audioReactOn, reactIntensity, smoothPump);
+            if (SpriteGlow::isActive(style, glowStrength)) {
+                SQUAB_TRACE_ZONE("paint.glow");
+                auto key = SpriteGlow::makeKey(sheetIndex, sx, sy, frameEffects, style, tweened);
+                if (styled) glow.update(key, frameBuffer, 0, 0);
+                else glow.update(key, *frameSource, frameX, frameY);
+                glow.draw(g, { destX, destY, destW, destH }, style.glowMode, SpriteGlow::getColour(style.glowMode, grade, glowStrength));
             }
-            
-            currentMotion *= 0.70f; // Fast decay
 
-            // Save the current frame for motion sensing
             {
-                lastFrameBuffer.clear(lastFrameBuffer.getBounds(), juce::Colours::transparentBlack);
-                juce::Graphics gLast(lastFrameBuffer);
-                gLast.drawImage(currentImg, 0, 0, 220, 256, sx, sy, 220, 256);
+                SQUAB_TRACE_ZONE("paint.draw");
+                g.setOpacity(1.0f); 
+                if (styled) g.drawImage(frameBuffer, destX, destY, destW, destH, 0, 0, 220, 256);
+                else g.drawImage(*frameSource, destX, destY, destW, destH, frameX, frameY, 220, 256);
             }
-
-            g.setOpacity(1.0f); 
-            g.drawImage(sourceToDraw, destX, destY, destW, destH, drawSourceX, drawSourceY, 220, 256); 
             
             // --- REFLECTION ---
             if (mirror) {
-                if (sourceToDraw != frameBuffer) {
-                    frameBuffer.clear(frameBuffer.getBounds(), juce::Colours::transparentBlack);
-                    {
-                        juce::Graphics gFrame(frameBuffer);
-                        gFrame.drawImage(sourceToDraw, 0, 0, 220, 256, drawSourceX, drawSourceY, 220, 256);
-                    }
-                }
-
-                reflectionBuffer.clear(reflectionBuffer.getBounds(), juce::Colours::transparentBlack);
-                {
-                    juce::Image::BitmapData srcData(frameBuffer, juce::Image::BitmapData::readOnly);
-                    juce::Image::BitmapData destData(reflectionBuffer, juce::Image::BitmapData::writeOnly);
-
-                    int fadeEnd = 100; 
-                    for (int y = 0; y < 256; ++y) {
-                        if (y >= fadeEnd) break; 
-                        int flippedY = 255 - y; 
-                        float progress = (float)y / (float)fadeEnd;
-                        float curve = (1.0f - progress) * (1.0f - progress); 
-                        float alphaMod = 0.45f * curve; 
-
-                        for (int x = 0; x < 220; ++x) {
-                            juce::Colour c = srcData.getPixelColour(x, flippedY);
-                            if (c.getAlpha() > 0) destData.setPixelColour(x, y, c.withMultipliedAlpha(alphaMod));
-                        }
-                    }
-                }
+                SQUAB_TRACE_ZONE("paint.reflection");
                 g.drawImage(reflectionBuffer, destX, offsetY + 380.0f, destW, destH, 0, 0, 220, 256);
             }
         }
     }
 
+    float getPumpScale() const {
+        float pScale = 1.0f;
+        if (audioReactOn && smoothPump > 0.001f && reactPump > 0.0f) {
+            pScale += (smoothPump * (reactPump / 100.0f) * 0.45f); 
+        }
+
+        // MIDI velocity kick and mod-wheel scale work without audio reactivity
+        pScale += midiPump * 0.45f;
+        pScale *= 1.0f + midiScaleBoost;
+        return pScale;
+    }
+
+    // Only the drawn dancer (and its reflection) takes the mouse. The component is far bigger
+    // than the sprite, and on the shared stage neighbours overlap, so a click on empty canvas
+    // has to reach whichever dancer is actually under it (or the host below).
+    bool hitTest (int x, int y) override {
+        const float winCenterX = getWidth() / 2.0f, winCenterY = getHeight() / 2.0f;
+        const float pScale = getPumpScale();
+        const float destW = 220.0f * pScale, destH = 256.0f * pScale;
+
+        juce::Rectangle<float> area(winCenterX - destW * 0.5f, winCenterY - destH, destW, mirror ? destH * 2.0f : destH);
+        area = area.transformedBy(juce::AffineTransform::scale(currentScale, currentScale, winCenterX, winCenterY));
+        return area.contains((float)x, (float)y);
+    }
+
     void mouseDown (const juce::MouseEvent& e) override {
         isMouseOverOrDragging = true;
-        if (auto* win = findParentComponentOfClass<juce::DocumentWindow>()) dragger.startDraggingComponent (win, e);
+        wake(ActivityMonitor::WakeReason::interaction);
+        if (onSharedStage) dragger.startDraggingComponent (this, e);
+        else if (auto* win = findParentComponentOfClass<juce::DocumentWindow>()) dragger.startDraggingComponent (win, e);
         repaint();
     }
     void mouseDrag (const juce::MouseEvent& e) override {
-        if (auto* win = findParentComponentOfClass<juce::DocumentWindow>()) dragger.dragComponent (win, e, nullptr);
+        if (onSharedStage) dragger.dragComponent (this, e, nullptr);
+        else if (auto* win = findParentComponentOfClass<juce::DocumentWindow>()) dragger.dragComponent (win, e, nullptr);
     }
     void mouseUp (const juce::MouseEvent& e) override {
         isMouseOverOrDragging = false;
+        wake(ActivityMonitor::WakeReason::interaction);
         repaint();
     }
 
-    void updateSync(bool synced, double beatLength, double ppq, bool playing) {
+    void updateSync(bool synced, double beatLength) {
         if (isSyncMode != synced) {
             isSyncMode = synced;
-            if (isSyncMode) startTimerHz(60); 
-            else startTimerHz(currentHz);
+            if (isSyncMode) stopTimer();
+            else if (!activity.isIdle()) startFrameTimer();
+            wake(ActivityMonitor::WakeReason::parameter);
         }
         currentBeatLength = beatLength;
-        currentPpq = ppq;
-        isPlaying = playing;
     }
 
     // 4. PURE MATH SCALING (No OS Calls!)
@@ -282,36 +607,116 @@ void setSpriteData(bool isGrid, const std::vector<AnimationDef>& anims, const st
         newScale = juce::jmax(0.1f, newScale); 
         if (currentScale != newScale) {
             currentScale = newScale;
+            wake(ActivityMonitor::WakeReason::parameter);
             repaint();
         }
     }
 
-    void updateAudioReact(bool on, float intensity, float color, float pump, float floatLevel) {
-        audioReactOn = on; reactIntensity = intensity; reactColor = color; reactPump = pump; audioLevel = floatLevel;
+    // Outline / pixelate / posterize on top of the grade (fx_* parameters)
+    void setStyle(const SpriteStyle& newStyle) {
+        if (!(style == newStyle)) {
+            style = newStyle;
+            wake(ActivityMonitor::WakeReason::parameter);
+            repaint();
+        }
     }
 
-    float getMotion() const { return currentMotion; }
-    float getHue() const { return currentHue; }
-    float getPan() const { return currentPan; }
+    void updateAudioReact(bool on, float intensity, float color, float pump, const SpectralFeatures& features) {
+        audioReactOn = on; reactIntensity = intensity; reactColor = color; reactPump = pump; spectrum = features;
+        if (audioReactOn && spectrum.level >= settleLevel) wake(ActivityMonitor::WakeReason::audio);
+    }
+
+    float getMotion() const { return motionSensor.getMotion(); }
+    float getHue() const { return motionSensor.getHue(); }
+    float getPan() const { return motionSensor.getPan(); }
 
 private:
+    bool checkWakeConditions() {
+        // Hidden: nothing to wake for, and queued MIDI would only replay as a burst later
+        if (!isShowing() && framePublisher == nullptr) {
+            if (eventQueue != nullptr) eventQueue->discardPending();
+            pendingEvents.clear();
+            return false;
+        }
+
+        if (eventQueue != nullptr && eventQueue->getNumReady() > 0) {
+            wake(ActivityMonitor::WakeReason::midi);
+            return true;
+        }
+
+        if (isSyncMode && beatClock != nullptr && beatClock->getLatest().isPlaying) {
+            wake(ActivityMonitor::WakeReason::transport);
+            return true;
+        }
+
+        return false;
+    }
+
+    // The beat clock is read once per tick, so the frame advanceFrame picks and the ppq the
+    // publisher sends come from the same moment (and the clock's monotonic clamp sees one read)
+    void capturePosition(juce::int64 nowTicks) {
+        framePosition = beatClock != nullptr ? beatClock->getPositionAt(nowTicks) : BeatClock::Position();
+    }
+
+    void publishFrame() {
+        if (framePublisher == nullptr || !hasSpriteData()) return;
+        framePublisher->post(getFrameState(), framePosition.ppq);
+    }
+
+    void startFrameTimer() {
+        if (onSharedStage) return;
+        if (isTweening()) stopTimer();   // The vblank runs the frame clock (see vblankCallback)
+        else startTimer(frameIntervalMs);
+    }
+
+    bool isTweening() const { return tweenMode != FrameTweener::off; }
+
+    void goIdle() {
+        if (activity.setIdle(true)) stopTimer();
+    }
+
+    static constexpr float settleLevel = 0.001f; // Below this the pump / level is invisible
+
     std::vector<juce::Image> spriteSheets;
     std::vector<AnimationDef> currentAnims;
     bool isGridSprite = false;
 
     juce::Image frameBuffer;
     juce::Image reflectionBuffer; 
-    juce::Image lastFrameBuffer; 
+    juce::Image tweenBuffer;     // In-between frame, FrameTweener's output
+    FrameTweener tweener;
+    MotionSensor motionSensor;
+    SpriteStyle style;
+    SpriteGlow glow;
+    MemoryAccounting::Allocation scratchBytes, reflectionBytes; // Ledger entries for the buffers above
 
     juce::ComponentDragger dragger;
 
     bool isSyncMode = false;
     double currentBeatLength = 1.0;
-    double currentPpq = 0.0;
-    bool isPlaying = false;
+    BeatClock* beatClock = nullptr;
+    BeatClock::Position framePosition;   // Captured at the start of each tick
+    std::unique_ptr<juce::VBlankAttachment> vblank;
+    bool onSharedStage = false;
+    juce::int64 lastStageHzTicks = 0;
+    SharedFramePublisher* framePublisher = nullptr;
+    juce::int64 lastVBlankTicks = 0;
+
+    // MIDI control
+    AnimationEventQueue* eventQueue = nullptr;
+    std::vector<AnimationEvent> pendingEvents;
+    int midiRow = -1;          // Move picked by a note, -1 = follow the UI
+    int lastEditorRow = -1;
+    float midiPump = 0.0f;
+    float midiScaleBoost = 0.0f;
+    float midiHueShift = 0.0f;
     float currentScale = 1.0f;
     
-    int currentHz = 30; 
+    int frameIntervalMs = 33;   // Hz-mode timer period, from speedHz
+    float speedHz = 30.0f;
+    int tweenMode = FrameTweener::off;
+    float framePhase = 0.0f;   // 0..1 from currentFrame towards the next one (in-betweening only)
+    double hzPhase = 0.0;      // Hz-mode frame clock while in-betweening
     bool isMouseOverOrDragging = false;
     int currentFrame = 0, totalFrames = 8, currentRow = 0, heldRow = 9, heldFrames = 8;
     bool mirror = false;
@@ -319,15 +724,31 @@ private:
     float reactIntensity = 0.0f;
     float reactColor = 0.0f;
     float reactPump = 0.0f;
-    float audioLevel = 0.0f;
+    SpectralFeatures spectrum;   // Bass -> pump, brightness -> hue, flux -> intensity
 
-    float currentMotion = 0.0f;
-    float currentHue = 0.0f;
-    float currentPan = 0.5f;
     int lastAnalyzedFrame = -1;
 
     float smoothPump = 0.0f;
 
+    ActivityMonitor activity;
+
+    // Crowd mode
+    CrowdRenderer crowd;
+    int crowdSize = 1;
+    bool crowdLayoutDirty = true;
+    float crowdScale = 1.0f;
+    juce::int64 crowdClock = 0;
+
+    // Quality governor and the caches its lower levels rely on
+    QualityGovernor governor;
+    juce::uint32 paintCounter = 0;
+    juce::int64 lastPaintTicks = 0;
+    bool repaintDeferred = false;
+    bool gradeCacheValid = false, reflectionCacheValid = false;
+    int gradedSheet = -1, gradedSx = 0, gradedSy = 0;
+    unsigned gradedEffects = 0, reflectedEffects = 0;   // SpriteEffectPipeline masks the caches were built with
+    int reflectedSheet = -1, reflectedSx = 0, reflectedSy = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpriteContent)
 };
 
@@ -355,6 +776,27 @@ public:
     }
 
     void closeButtonPressed() override { setVisible(false); }
+
+    // Hands the dancer over to the shared stage (window hidden), or takes it back
+    void setContentOnSharedStage(bool onStage) {
+        if (onStage) {
+            clearContentComponent();
+            setVisible(false);
+        } else {
+            content->setTopLeftPosition(0, 0);
+            setContentNonOwned(content.get(), true);
+        }
+    }
+
+    // Shown again (Open button) or restored from the dock: pick up where the dancer left off
+    void visibilityChanged() override {
+        DocumentWindow::visibilityChanged();
+        if (isVisible() && content != nullptr) content->wake(ActivityMonitor::WakeReason::visibility);
+    }
+
+    void minimisationStateChanged(bool isNowMinimised) override {
+        if (!isNowMinimised && content != nullptr) content->wake(ActivityMonitor::WakeReason::visibility);
+    }
     SpriteContent* getContent() { return content.get(); }
 
 private:
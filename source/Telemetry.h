@@ -0,0 +1,120 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+// --- PER-BLOCK TELEMETRY RECORD ---
+// The audio thread fills exactly one of these at the end of every processBlock,
+// so every field in a record always describes the same block (no torn reads).
+struct TelemetryFrame
+{
+    static constexpr int maxChannels = 8;
+
+    juce::int64 timestampTicks = 0;   // juce::Time::getHighResolutionTicks() when the block was published
+    juce::int64 samplePosition = 0;   // Timeline position of the first sample in the block
+    int numSamples = 0;
+    double sampleRate = 44100.0;
+
+    // Playhead
+    double ppq = 0.0;
+    double bpm = 120.0;
+    bool isPlaying = false;
+
+    // Output levels per channel (linear gain)
+    int numChannels = 0;
+    std::array<float, maxChannels> rms {};
+    std::array<float, maxChannels> peak {};
+    std::array<float, maxChannels> truePeak {};   // 4x oversampled
+
+    // K-weighted loudness of the output (LUFS)
+    float momentaryLufs = -100.0f;
+    float shortTermLufs = -100.0f;
+
+    // Visual model values the DSP used for this block
+    float visualMotion = 0.0f;
+    float visualHue = 0.0f;
+    float visualPan = 0.5f;
+    int visualQuality = 0;   // QualityGovernor level the dancer is rendering at (0 = full)
+};
+
+// --- WAIT-FREE SPSC RING ---
+// One producer (audio thread) and one consumer (editor timer). Built on juce::AbstractFifo,
+// so push() and drain() never lock or allocate. If nobody drains (editor closed) the ring
+// simply fills up and new records are dropped and counted instead of blocking the audio thread;
+// a consumer that attaches later calls discardPending() first so it starts from live records,
+// not the stale backlog from whenever the ring filled up.
+template <typename RecordType, int Capacity>
+class SpscRing
+{
+public:
+    bool push(const RecordType& record) {
+        bool written = false;
+        fifo.write(1).forEach([&](int index) {
+            records[(size_t)index] = record;
+            written = true;
+        });
+
+        if (!written) dropped.fetch_add(1, std::memory_order_relaxed);
+        return written;
+    }
+
+    // Calls fn(const RecordType&) for every pending record, oldest first. Returns the number drained.
+    template <typename Fn>
+    int drain(Fn&& fn) {
+        int count = 0;
+        fifo.read(fifo.getNumReady()).forEach([&](int index) {
+            fn(records[(size_t)index]);
+            ++count;
+        });
+        return count;
+    }
+
+    // Consumer side: throws away everything pending. Returns the number discarded.
+    int discardPending() {
+        const int count = fifo.getNumReady();
+        fifo.read(count);
+        return count;
+    }
+
+    int getNumReady() const { return fifo.getNumReady(); }
+    int getFreeSpace() const { return fifo.getFreeSpace(); }
+    juce::uint32 getNumDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    juce::AbstractFifo fifo { Capacity };
+    std::array<RecordType, Capacity> records {};
+    std::atomic<juce::uint32> dropped { 0 };
+};
+
+// 1024 records covers ~0.7 s of 32-sample blocks at 48 kHz, far more than one editor timer tick.
+using TelemetryRing = SpscRing<TelemetryFrame, 1024>;
+
+// --- WAIT-FREE LATEST-VALUE CHANNEL ---
+// Classic triple buffer: the writer never waits for the reader and the reader always gets the most
+// recent complete value. Used where only "now" matters (e.g. the playhead), not the full history.
+template <typename ValueType>
+class TripleBuffer
+{
+public:
+    // Writer thread only
+    void write(const ValueType& value) {
+        slots[(size_t)backIndex] = value;
+        backIndex = middle.exchange(backIndex | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader thread only. Returns true if a new value arrived since the last read.
+    bool read(ValueType& out) {
+        bool fresh = (middle.load(std::memory_order_relaxed) & dirtyBit) != 0;
+        if (fresh) frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        out = slots[(size_t)frontIndex];
+        return fresh;
+    }
+
+private:
+    static constexpr int dirtyBit = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<ValueType, 3> slots {};
+    std::atomic<int> middle { 1 };
+    int backIndex = 0;  // Owned by the writer
+    int frontIndex = 2; // Owned by the reader
+};
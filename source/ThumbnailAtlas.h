@@ -0,0 +1,30 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpriteData.h"
+
+// --- THUMBNAIL ATLAS LAYOUT ---
+// Shared by the build-time generator (Tools/ThumbnailAtlas.cpp) and ThumbnailBrowser. One PNG
+// per category, one row per animation, up to 8 evenly spaced frames per row at quarter size, so
+// previewing all 130 animations never decodes a full sheet.
+struct ThumbnailAtlas
+{
+    static constexpr int cellWidth = 55;    // 220 / 4
+    static constexpr int cellHeight = 64;   // 256 / 4
+    static constexpr int maxFrames = 8;
+
+    static int getNumFrames(const AnimationDef& anim) { return juce::jlimit(1, maxFrames, anim.frameCount); }
+
+    // The animation frame thumbnail frame thumbFrame shows
+    static int getSourceFrame(const AnimationDef& anim, int thumbFrame) {
+        return thumbFrame * juce::jmax(1, anim.frameCount) / getNumFrames(anim);
+    }
+
+    static juce::Rectangle<int> getCell(int row, int thumbFrame) {
+        return { thumbFrame * cellWidth, row * cellHeight, cellWidth, cellHeight };
+    }
+
+    static juce::String getFileName(int category) { return "ThumbAtlas" + juce::String(category) + ".png"; }
+
+    // The name juce_add_binary_data gives that file
+    static juce::String getResourceName(int category) { return "ThumbAtlas" + juce::String(category) + "_png"; }
+};
@@ -0,0 +1,220 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ThumbnailData.h"
+#include "ThumbnailAtlas.h"
+#include "MemoryAccounting.h"
+
+// --- ANIMATED THUMBNAIL BROWSER ---
+// Every animation in SpriteDatabase as a live preview, grouped by category. It plays from the
+// build-time ThumbnailAtlas PNGs (quarter-size, at most 8 frames), never from full sheets; the
+// editor loads full-resolution sheets only for the animation that gets picked.
+//
+// Cells are not components: the grid paints only the cells inside the clip region, and one
+// timer advances every preview and repaints just the visible part of the viewport. Atlases are
+// decoded on a background thread the first time one of their cells scrolls into view.
+class ThumbnailBrowser : public juce::Component, private juce::Timer
+{
+public:
+    explicit ThumbnailBrowser(const std::vector<CharacterDef>& database)
+        : grid(*this, database)
+    {
+        atlases.resize(database.size());
+        atlasBytes.resize(database.size());
+        requested.resize(database.size(), false);
+
+        addAndMakeVisible(viewport);
+        viewport.setViewedComponent(&grid, false);
+        viewport.setScrollBarsShown(true, false);
+
+        addAndMakeVisible(closeButton);
+        closeButton.setButtonText("Close");
+        closeButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xFF2A2A2A));
+        closeButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+        closeButton.onClick = [this] { toggle(); };
+
+        setInterceptsMouseClicks(true, true);
+    }
+
+    ~ThumbnailBrowser() override { decodePool.removeAllJobs(true, 2000); }
+
+    // Called with (category, animation) when a preview is clicked
+    std::function<void(int, int)> onSelect;
+
+    void toggle() {
+        setVisible(!isVisible());
+        if (isVisible()) { toFront(false); startTimerHz(previewHz); }
+        else stopTimer();
+    }
+
+    void setSelected(int category, int animation) {
+        if (selectedCategory == category && selectedAnimation == animation) return;
+        selectedCategory = category;
+        selectedAnimation = animation;
+        if (isVisible()) grid.repaint();
+    }
+
+    void paint(juce::Graphics& g) override {
+        g.fillAll(juce::Colours::black.withAlpha(0.92f));
+        g.setColour(juce::Colours::white);
+        g.setFont(16.0f);
+        g.drawText("Dance Browser", getLocalBounds().removeFromTop(headerHeight).reduced(10, 0), juce::Justification::centredLeft);
+    }
+
+    void resized() override {
+        auto area = getLocalBounds();
+        auto header = area.removeFromTop(headerHeight);
+        closeButton.setBounds(header.removeFromRight(80).reduced(6));
+        viewport.setBounds(area.reduced(6, 0));
+        grid.layout(viewport.getMaximumVisibleWidth());
+    }
+
+private:
+    static constexpr int previewHz = 12;
+    static constexpr int headerHeight = 34;
+    static constexpr int cellWidth = 96, cellHeight = 104, sectionHeight = 24;
+    static constexpr float thumbScale = 1.25f;
+
+    // --- THE VIRTUAL GRID ---
+    class Grid : public juce::Component
+    {
+    public:
+        Grid(ThumbnailBrowser& ownerRef, const std::vector<CharacterDef>& databaseRef) : owner(ownerRef), database(databaseRef) {
+            setOpaque(false);
+        }
+
+        // Section offsets for this width; only the height depends on it
+        void layout(int width) {
+            columns = juce::jmax(1, width / cellWidth);
+            sectionTops.clear();
+            int y = 0;
+            for (const auto& charDef : database) {
+                sectionTops.push_back(y);
+                y += sectionHeight + cellHeight * (((int)charDef.anims.size() + columns - 1) / columns);
+            }
+            sectionTops.push_back(y);
+            setSize(width, y);
+        }
+
+        juce::Rectangle<int> getCellBounds(int category, int animation) const {
+            return { (animation % columns) * cellWidth, sectionTops[(size_t)category] + sectionHeight + (animation / columns) * cellHeight,
+                     cellWidth, cellHeight };
+        }
+
+        void paint(juce::Graphics& g) override {
+            const auto clip = g.getClipBounds();
+            g.setImageResamplingQuality(juce::Graphics::mediumResamplingQuality);
+
+            for (int category = 0; category < (int)database.size(); ++category) {
+                const int top = sectionTops[(size_t)category], bottom = sectionTops[(size_t)category + 1];
+                if (bottom <= clip.getY() || top >= clip.getBottom()) continue;
+
+                const auto& charDef = database[(size_t)category];
+                g.setColour(juce::Colour(0xFFAAAAAA));
+                g.setFont(14.0f);
+                g.drawText(charDef.categoryName, 4, top, getWidth() - 8, sectionHeight, juce::Justification::centredLeft);
+
+                // Only the rows of this section that intersect the clip
+                const int firstRow = juce::jmax(0, (clip.getY() - top - sectionHeight) / cellHeight);
+                const int lastRow = (clip.getBottom() - top - sectionHeight) / cellHeight;
+                const int numAnims = (int)charDef.anims.size();
+
+                for (int row = firstRow; row <= lastRow; ++row)
+                    for (int column = 0; column < columns; ++column) {
+                        const int animation = row * columns + column;
+                        if (animation >= numAnims) break;
+                        paintCell(g, category, animation, getCellBounds(category, animation));
+                    }
+            }
+        }
+
+        void mouseUp(const juce::MouseEvent& e) override {
+            for (int category = 0; category < (int)database.size(); ++category) {
+                if (e.y < sectionTops[(size_t)category] || e.y >= sectionTops[(size_t)category + 1]) continue;
+
+                const int y = e.y - sectionTops[(size_t)category] - sectionHeight;
+                const int animation = y < 0 ? -1 : (y / cellHeight) * columns + e.x / cellWidth;
+                if (animation >= 0 && e.x / cellWidth < columns && animation < (int)database[(size_t)category].anims.size()
+                    && owner.onSelect != nullptr)
+                    owner.onSelect(category, animation);
+                return;
+            }
+        }
+
+    private:
+        void paintCell(juce::Graphics& g, int category, int animation, juce::Rectangle<int> cell) {
+            const auto& anim = database[(size_t)category].anims[(size_t)animation];
+            auto area = cell.reduced(3);
+
+            const bool selected = category == owner.selectedCategory && animation == owner.selectedAnimation;
+            g.setColour(selected ? juce::Colour(0xFFE67E22).withAlpha(0.35f) : juce::Colour(0xFF202020));
+            g.fillRoundedRectangle(area.toFloat(), 6.0f);
+
+            auto label = area.removeFromBottom(16);
+            g.setColour(juce::Colours::lightgrey);
+            g.setFont(11.0f);
+            g.drawFittedText(anim.name, label, juce::Justification::centred, 1);
+
+            auto atlas = owner.getAtlas(category);
+            if (!atlas.isValid()) return;   // Still decoding: the next tick paints it
+
+            const int frame = (int)(owner.tick % (juce::uint32)ThumbnailAtlas::getNumFrames(anim));
+            const auto src = ThumbnailAtlas::getCell(animation, frame);
+            const auto dest = juce::Rectangle<float>(ThumbnailAtlas::cellWidth * thumbScale, ThumbnailAtlas::cellHeight * thumbScale)
+                                  .withCentre(area.toFloat().getCentre());
+            g.drawImage(atlas, dest.getX(), dest.getY(), dest.getWidth(), dest.getHeight(),
+                        src.getX(), src.getY(), src.getWidth(), src.getHeight());
+        }
+
+        ThumbnailBrowser& owner;
+        const std::vector<CharacterDef>& database;
+        std::vector<int> sectionTops;   // Section y offsets, plus the total height at the end
+        int columns = 1;
+    };
+
+    void timerCallback() override {
+        ++tick;
+        grid.repaint(viewport.getViewArea());
+    }
+
+    // Decoded atlas for a category, or an invalid image while it is (or starts) decoding
+    juce::Image getAtlas(int category) {
+        {
+            const juce::ScopedLock sl(atlasLock);
+            if (atlases[(size_t)category].isValid()) return atlases[(size_t)category];
+        }
+
+        if (!requested[(size_t)category]) {
+            requested[(size_t)category] = true;
+            decodePool.addJob([this, category] {
+                int size = 0;
+                const char* data = ThumbnailData::getNamedResource(ThumbnailAtlas::getResourceName(category).toRawUTF8(), size);
+                if (data == nullptr) return;
+
+                auto image = juce::ImageFileFormat::loadFrom(data, (size_t)size);
+                if (!image.isValid()) return;
+
+                MemoryAccounting::Allocation bytes(MemoryAccounting::Tag::ui, MemoryAccounting::getImageBytes(image));
+                const juce::ScopedLock sl(atlasLock);
+                atlases[(size_t)category] = image;
+                atlasBytes[(size_t)category] = std::move(bytes);
+            });
+        }
+
+        return {};
+    }
+
+    Grid grid;
+    juce::Viewport viewport;
+    juce::TextButton closeButton;
+
+    int selectedCategory = -1, selectedAnimation = -1;
+    juce::uint32 tick = 0;
+
+    juce::CriticalSection atlasLock;
+    std::vector<juce::Image> atlases;                         // Guarded by atlasLock
+    std::vector<MemoryAccounting::Allocation> atlasBytes;     // Guarded by atlasLock
+    std::vector<bool> requested;                              // Message thread only
+    juce::ThreadPool decodePool { 1 };                        // Last, so it stops before the rest goes
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThumbnailBrowser)
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <map>
+
+// --- REAL-TIME-SAFE TRACING ---
+// SQUAB_TRACE_ZONE("name") times the enclosing scope and appends it to the calling thread's own
+// ring buffer. Buffers are preallocated and claimed with a CAS, so the audio thread never locks or
+// allocates. Compiled out completely unless SQUAB_ENABLE_TRACING=1 (CMake turns it on for Debug
+// builds, or with -DSQUAB_ENABLE_TRACING=ON for profiling release builds).
+//
+// Zone and thread names must be string literals: only the pointer is stored.
+
+#ifndef SQUAB_ENABLE_TRACING
+ #define SQUAB_ENABLE_TRACING 0
+#endif
+
+namespace Tracing
+{
+    struct ZoneEvent
+    {
+        const char* name = nullptr;
+        juce::int64 startTicks = 0;
+        juce::int64 endTicks = 0;
+    };
+
+    struct ZoneStats
+    {
+        int count = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+        double lastMs = 0.0;
+
+        double getAverageMs() const { return count > 0 ? totalMs / count : 0.0; }
+    };
+
+    // One per thread. The owning thread is the only writer; readers copy whatever window is still
+    // intact and throw away events the writer may have lapped while they were copying.
+    class ThreadBuffer
+    {
+    public:
+        static constexpr int capacity = 4096; // Power of two
+
+        void record(const char* zoneName, juce::int64 start, juce::int64 end) {
+            auto index = writeCount.load(std::memory_order_relaxed);
+            events[(size_t)(index & (capacity - 1))] = { zoneName, start, end };
+            writeCount.store(index + 1, std::memory_order_release);
+        }
+
+        template <typename Fn>
+        void forEachRecent(Fn&& fn) const {
+            auto end = writeCount.load(std::memory_order_acquire);
+            auto begin = end > (juce::uint64)capacity ? end - (juce::uint64)capacity : 0;
+
+            for (auto i = begin; i < end; ++i) {
+                ZoneEvent e = events[(size_t)(i & (capacity - 1))];
+
+                // Once the writer has reached event i + capacity it may be halfway through
+                // overwriting this slot, so the copy only counts if it had not got there yet
+                if (writeCount.load(std::memory_order_acquire) - i >= (juce::uint64)capacity) continue;
+                fn(e);
+            }
+        }
+
+        // Called by Registry::reset, so the slot (and thread ID, which the OS may hand to a new
+        // thread) can be claimed again. Readers that were mid-copy see the count go back and
+        // discard what they copied.
+        void release() {
+            threadId.store(nullptr, std::memory_order_release);
+            threadName.store(nullptr, std::memory_order_relaxed);
+            writeCount.store(0, std::memory_order_release);
+            claimed.store(false, std::memory_order_release);
+        }
+
+        std::atomic<bool> claimed { false };
+        std::atomic<juce::Thread::ThreadID> threadId { nullptr };
+        std::atomic<const char*> threadName { nullptr };
+
+    private:
+        std::atomic<juce::uint64> writeCount { 0 };
+        std::array<ZoneEvent, capacity> events {};
+    };
+
+    class Registry
+    {
+    public:
+        static constexpr int maxThreads = 32;
+
+        static Registry& getInstance() {
+            static Registry instance;
+            return instance;
+        }
+
+        // Finds (or claims) the calling thread's buffer. The slot index is cached in a plain
+        // thread_local (trivially destructible, constant-initialised: no allocation, no exit-time
+        // destructor, safe on the audio thread), tagged with the reset generation it was claimed in.
+        ThreadBuffer* getBufferForCurrentThread() {
+            static thread_local SlotCache cache;
+            const auto currentGeneration = generation.load(std::memory_order_acquire);
+            if (cache.index >= 0 && cache.generation == currentGeneration) return &buffers[(size_t)cache.index];
+
+            auto id = juce::Thread::getCurrentThreadId();
+            for (int i = 0; i < maxThreads; ++i) {
+                auto& b = buffers[(size_t)i];
+                bool expected = false;
+                if (b.claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    b.threadId.store(id, std::memory_order_release);
+                    cache = { i, currentGeneration };
+                    return &b;
+                }
+            }
+            return nullptr; // Out of slots until the next reset: this thread just isn't traced
+        }
+
+        // Gives every slot back and makes each thread claim a fresh one on its next zone, so
+        // threads that have exited since (export workers, thread pool jobs) stop holding slots.
+        // Call from the message thread when a capture ends; a zone that closes on another thread
+        // at that very moment may land in the new capture or be lost.
+        void reset() {
+            generation.fetch_add(1, std::memory_order_acq_rel);
+            for (auto& b : buffers) b.release();
+        }
+
+        template <typename Fn>
+        void forEachBuffer(Fn&& fn) const {
+            for (int i = 0; i < maxThreads; ++i)
+                if (buffers[(size_t)i].claimed.load(std::memory_order_acquire)) fn(i, buffers[(size_t)i]);
+        }
+
+    private:
+        Registry() = default;
+
+        struct SlotCache
+        {
+            int index = -1;
+            juce::uint32 generation = 0;
+        };
+
+        std::array<ThreadBuffer, maxThreads> buffers;
+        std::atomic<juce::uint32> generation { 0 };
+    };
+
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const char* zoneName) : name(zoneName), start(juce::Time::getHighResolutionTicks()) {}
+        ~ScopedZone() {
+            if (auto* b = Registry::getInstance().getBufferForCurrentThread())
+                b->record(name, start, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* name;
+        juce::int64 start;
+        JUCE_DECLARE_NON_COPYABLE(ScopedZone)
+    };
+
+    inline void setCurrentThreadName(const char* threadName) {
+        if (auto* b = Registry::getInstance().getBufferForCurrentThread())
+            b->threadName.store(threadName, std::memory_order_relaxed);
+    }
+
+    // --- READERS (message thread) ---
+
+    // Per-zone timings over the last `windowSeconds`, for the debug overlay
+    inline std::map<juce::String, ZoneStats> collectZoneStats(double windowSeconds) {
+        std::map<juce::String, ZoneStats> stats;
+        auto cutoff = juce::Time::getHighResolutionTicks()
+                    - (juce::int64)(windowSeconds * (double)juce::Time::getHighResolutionTicksPerSecond());
+
+        Registry::getInstance().forEachBuffer([&](int, const ThreadBuffer& buffer) {
+            buffer.forEachRecent([&](const ZoneEvent& e) {
+                if (e.name == nullptr || e.endTicks < cutoff) return;
+                double ms = juce::Time::highResolutionTicksToSeconds(e.endTicks - e.startTicks) * 1000.0;
+                auto& s = stats[juce::String(e.name)];
+                s.count++;
+                s.totalMs += ms;
+                s.maxMs = juce::jmax(s.maxMs, ms);
+                s.lastMs = ms;
+            });
+        });
+        return stats;
+    }
+
+    // Chrome trace / Perfetto JSON ("X" complete events, one tid per traced thread)
+    inline bool exportChromeTrace(const juce::File& file) {
+        juce::FileOutputStream out(file);
+        if (!out.openedOk()) return false;
+        out.setPosition(0);
+        out.truncate();
+
+        const double ticksToUs = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+        bool first = true;
+        auto separator = [&] { if (!first) out << ",\n"; first = false; };
+
+        out << "{\"traceEvents\":[\n";
+        Registry::getInstance().forEachBuffer([&](int tid, const ThreadBuffer& buffer) {
+            if (auto* threadName = buffer.threadName.load(std::memory_order_relaxed)) {
+                separator();
+                out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid
+                    << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+            }
+
+            buffer.forEachRecent([&](const ZoneEvent& e) {
+                if (e.name == nullptr) return;
+                separator();
+                out << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                    << ",\"name\":\"" << e.name << "\""
+                    << ",\"ts\":" << juce::String((double)e.startTicks * ticksToUs, 3)
+                    << ",\"dur\":" << juce::String((double)(e.endTicks - e.startTicks) * ticksToUs, 3) << "}";
+            });
+        });
+        out << "\n]}\n";
+        return true;
+    }
+}
+
+#if SQUAB_ENABLE_TRACING
+ #define SQUAB_TRACE_ZONE(zoneName)        const Tracing::ScopedZone JUCE_JOIN_MACRO(squabTraceZone_, __LINE__) (zoneName)
+ #define SQUAB_TRACE_THREAD(threadName)    Tracing::setCurrentThreadName(threadName)
+#else
+ #define SQUAB_TRACE_ZONE(zoneName)
+ #define SQUAB_TRACE_THREAD(threadName)
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpriteData.h"
+#include "MotionSensor.h"
+
+// --- PRECOMPUTED VISUAL TIMELINE ---
+// The motion / hue / pan the live motion sensor would read for every frame of one animation,
+// computed ahead of time with the very same scan. Offline (host bounce or SquabDanceBatch) the
+// processor takes its visual modulation from here at the playhead's frame instead of from the
+// wall-clock driven dancer, so the processed audio depends only on the input, the parameters and
+// the tempo, and every offline render of the same material is identical.
+struct VisualSample
+{
+    float motion = 0.0f;
+    float hue = 0.0f;
+    float pan = 0.5f;
+};
+
+class VisualTimeline
+{
+public:
+    static constexpr int scanStep = 4;   // The live sensor's full-quality step
+
+    // The sensor carries state from frame to frame (last frame, motion decay), so the loop is
+    // scanned twice and the second pass kept: frame 0 then sees the loop's last frame before it.
+    static VisualTimeline build(const SpriteSheetSet& set, int row) {
+        VisualTimeline timeline;
+        if (!set.isValid()) return timeline;
+
+        row = juce::jlimit(0, (int)set.anims.size() - 1, row);
+        const int numFrames = juce::jmax(1, set.anims[(size_t)row].frameCount);
+        timeline.samples.resize((size_t)numFrames);
+
+        MotionSensor sensor;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int frame = 0; frame < numFrames; ++frame) {
+                int sheetIndex = 0, sx = 0, sy = 0;
+                if (SpriteFrameRenderer::locateFrame(set, row, frame, sheetIndex, sx, sy)) {
+                    sensor.scanFrame(set.sheets[(size_t)sheetIndex], sx, sy, scanStep);
+                }
+
+                if (pass == 1) timeline.samples[(size_t)frame] = { sensor.getMotion(), sensor.getHue(), sensor.getPan() };
+            }
+        }
+
+        return timeline;
+    }
+
+    bool isEmpty() const { return samples.empty(); }
+    int getNumFrames() const { return (int)samples.size(); }
+
+    // Any frame number; the animation loops
+    const VisualSample& at(juce::int64 frame) const {
+        static const VisualSample neutral;
+        if (samples.empty()) return neutral;
+        auto n = (juce::int64)samples.size();
+        return samples[(size_t)(((frame % n) + n) % n)];
+    }
+
+private:
+    std::vector<VisualSample> samples;
+};